@@ -0,0 +1,256 @@
+// asset_manager.cpp - Asynchronous asset loading with reference-counted handles
+// File I/O and decoding run on a background pool. SDL objects that must be
+// created on the main thread (textures) are built in update(), which also
+// frees assets nobody references any more. Handles are main-thread objects
+// and must be released before the manager is destroyed.
+#pragma once
+#include <SDL3/SDL.h>
+#include <string>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include "thread_pool.cpp"
+#include "telemetry.cpp"
+
+enum class AssetType {
+    SOUND,   // WAV decoded to PCM (SDL_LoadWAV)
+    TEXTURE, // BMP decoded to a surface, uploaded on the main thread
+    FILE     // Raw bytes (levels, configs)
+};
+
+enum class AssetState {
+    PENDING, // Queued or decoding
+    READY,
+    FAILED
+};
+
+struct AssetEntry {
+    std::string path;
+    AssetType type;
+    AssetState state = AssetState::PENDING;
+    int refs = 0;
+
+    // Written by the loader thread before the entry is queued for finalize
+    bool decoded = false;
+    double decodeMs = 0;
+    SDL_AudioSpec spec{};
+    Uint8* audio = nullptr;
+    Uint32 audioLength = 0;
+    SDL_Surface* surface = nullptr;
+    std::vector<Uint8> bytes;
+
+    // Main thread only
+    SDL_Texture* texture = nullptr;
+
+    AssetEntry(const std::string& p, AssetType t) : path(p), type(t) {}
+
+    ~AssetEntry() {
+        SDL_free(audio);
+        if (surface) SDL_DestroySurface(surface);
+        if (texture) SDL_DestroyTexture(texture);
+    }
+};
+
+class AssetHandle {
+private:
+    AssetEntry* entry;
+
+    void retain() { if (entry) entry->refs++; }
+    void release() { if (entry) entry->refs--; }
+
+public:
+    AssetHandle() : entry(nullptr) {}
+    explicit AssetHandle(AssetEntry* e) : entry(e) { retain(); }
+    AssetHandle(const AssetHandle& other) : entry(other.entry) { retain(); }
+    AssetHandle(AssetHandle&& other) noexcept : entry(other.entry) { other.entry = nullptr; }
+    ~AssetHandle() { release(); }
+
+    AssetHandle& operator=(AssetHandle other) {
+        std::swap(entry, other.entry);
+        return *this;
+    }
+
+    void reset() { AssetHandle().swap(*this); }
+    void swap(AssetHandle& other) { std::swap(entry, other.entry); }
+
+    explicit operator bool() const { return entry != nullptr; }
+    bool isReady() const { return entry && entry->state == AssetState::READY; }
+    bool isFailed() const { return entry && entry->state == AssetState::FAILED; }
+    bool isLoaded() const { return entry && entry->state != AssetState::PENDING; }
+
+    const std::string& getPath() const { return entry->path; }
+
+    // Accessors return empty values until the asset is ready
+    const SDL_AudioSpec* getSpec() const { return isReady() ? &entry->spec : nullptr; }
+    const Uint8* getAudio() const { return isReady() ? entry->audio : nullptr; }
+    Uint32 getAudioLength() const { return isReady() ? entry->audioLength : 0; }
+    SDL_Texture* getTexture() const { return isReady() ? entry->texture : nullptr; }
+    SDL_Surface* getSurface() const { return isReady() ? entry->surface : nullptr; }
+    const std::vector<Uint8>* getBytes() const { return isReady() ? &entry->bytes : nullptr; }
+};
+
+class AssetManager {
+private:
+    SDL_Renderer* renderer;
+    std::unordered_map<std::string, std::unique_ptr<AssetEntry>> entries;
+
+    std::mutex finalizeMutex;
+    std::deque<AssetEntry*> finalizeQueue;
+
+    int pending;
+    int requested;
+    Uint64 firstRequestTicks;
+    Uint64 lastFinalizeTicks;
+
+    // Declared last and reset first so no loader outlives the queue
+    std::unique_ptr<ThreadPool> loaders;
+
+    static void decode(AssetEntry* e) {
+        Uint64 start = SDL_GetPerformanceCounter();
+
+        switch (e->type) {
+        case AssetType::SOUND:
+            e->decoded = SDL_LoadWAV(e->path.c_str(), &e->spec, &e->audio, &e->audioLength);
+            break;
+
+        case AssetType::TEXTURE:
+            e->surface = SDL_LoadBMP(e->path.c_str());
+            e->decoded = e->surface != nullptr;
+            break;
+
+        case AssetType::FILE: {
+            size_t size = 0;
+            void* data = SDL_LoadFile(e->path.c_str(), &size);
+            if (data) {
+                const Uint8* bytes = static_cast<const Uint8*>(data);
+                e->bytes.assign(bytes, bytes + size);
+                SDL_free(data);
+                e->decoded = true;
+            }
+            break;
+        }
+        }
+
+        Uint64 elapsed = SDL_GetPerformanceCounter() - start;
+        e->decodeMs = elapsed * 1000.0 / SDL_GetPerformanceFrequency();
+        Telemetry::record(TelemetryKind::ASSET_DECODE_US, Telemetry::microseconds(elapsed));
+    }
+
+    void finalize(AssetEntry* e) {
+        pending--;
+        lastFinalizeTicks = SDL_GetTicks();
+
+        if (!e->decoded) {
+            e->state = AssetState::FAILED;
+            SDL_Log("Asset failed: %s", e->path.c_str());
+            return;
+        }
+
+        if (e->type == AssetType::TEXTURE && renderer) {
+            e->texture = SDL_CreateTextureFromSurface(renderer, e->surface);
+            SDL_DestroySurface(e->surface);
+            e->surface = nullptr;
+            if (!e->texture) {
+                e->state = AssetState::FAILED;
+                SDL_Log("Texture upload failed: %s (%s)", e->path.c_str(), SDL_GetError());
+                return;
+            }
+        }
+
+        e->state = AssetState::READY;
+    }
+
+    AssetHandle request(const std::string& path, AssetType type) {
+        auto it = entries.find(path);
+        if (it != entries.end()) {
+            return AssetHandle(it->second.get());
+        }
+
+        if (requested == 0 || pending == 0) {
+            firstRequestTicks = SDL_GetTicks();
+        }
+
+        auto entry = std::make_unique<AssetEntry>(path, type);
+        AssetEntry* e = entry.get();
+        entries.emplace(path, std::move(entry));
+        pending++;
+        requested++;
+
+        loaders->submit([this, e]() {
+            decode(e);
+            std::lock_guard<std::mutex> lock(finalizeMutex);
+            finalizeQueue.push_back(e);
+            });
+
+        return AssetHandle(e);
+    }
+
+public:
+    explicit AssetManager(SDL_Renderer* ren = nullptr, int threads = 2)
+        : renderer(ren), pending(0), requested(0), firstRequestTicks(0), lastFinalizeTicks(0),
+        loaders(std::make_unique<ThreadPool>(threads)) {
+    }
+
+    ~AssetManager() {
+        loaders.reset();
+    }
+
+    AssetManager(const AssetManager&) = delete;
+    AssetManager& operator=(const AssetManager&) = delete;
+
+    void setRenderer(SDL_Renderer* ren) { renderer = ren; }
+
+    // Requests for a path already known share one entry
+    AssetHandle loadSound(const std::string& path) { return request(path, AssetType::SOUND); }
+    AssetHandle loadTexture(const std::string& path) { return request(path, AssetType::TEXTURE); }
+    AssetHandle loadFile(const std::string& path) { return request(path, AssetType::FILE); }
+
+    // Main thread, once per frame: finalize up to maxFinalize decoded assets,
+    // then free loaded assets with no remaining handles
+    void update(int maxFinalize = 16) {
+        for (int i = 0; i < maxFinalize; ++i) {
+            AssetEntry* e;
+            {
+                std::lock_guard<std::mutex> lock(finalizeMutex);
+                if (finalizeQueue.empty()) break;
+                e = finalizeQueue.front();
+                finalizeQueue.pop_front();
+            }
+            finalize(e);
+        }
+
+        for (auto it = entries.begin(); it != entries.end();) {
+            const AssetEntry& e = *it->second;
+            if (e.refs <= 0 && e.state != AssetState::PENDING) {
+                it = entries.erase(it);
+            }
+            else {
+                ++it;
+            }
+        }
+    }
+
+    // Block until every request so far is loaded (tools and batch runs)
+    void waitAll() {
+        while (pending > 0) {
+            loaders->waitIdle();
+            update(1 << 30);
+        }
+    }
+
+    bool isIdle() const { return pending == 0; }
+    int getPendingCount() const { return pending; }
+    int getRequestedCount() const { return requested; }
+    size_t getResidentCount() const { return entries.size(); }
+
+    float getProgress() const {
+        return requested > 0 ? 1.0f - static_cast<float>(pending) / requested : 1.0f;
+    }
+
+    // Wall time from the first request of the current batch to its last finalize
+    Uint64 getStreamingMs() const {
+        return lastFinalizeTicks >= firstRequestTicks ? lastFinalizeTicks - firstRequestTicks : 0;
+    }
+};
@@ -0,0 +1,126 @@
+// camera.cpp - 2D camera with follow smoothing, shake, zoom and viewport queries
+#pragma once
+#include <SDL3/SDL.h>
+#include <cmath>
+#include <algorithm>
+#include "renderer2d.cpp"
+#include "utils.cpp"
+
+class Camera2D {
+private:
+    Vec2 center;          // World-space point at the middle of the viewport
+    Vec2 target;
+    Vec2 viewportSize;
+    SDL_FRect bounds;     // World area the view is kept inside (w/h <= 0 = unbounded)
+
+    float zoom;
+    float targetZoom;
+    float followSharpness; // Higher = snappier follow (1/seconds)
+    float zoomSharpness;
+
+    float shakeIntensity;
+    float shakeDecay;
+    Vec2 shakeOffset;
+
+    // Frame-rate independent exponential approach
+    static float approach(float current, float goal, float sharpness, float dt) {
+        return goal + (current - goal) * std::exp(-sharpness * dt);
+    }
+
+    void clampToBounds() {
+        Vec2 half = getHalfExtent();
+        if (bounds.w > 0) {
+            if (bounds.w <= half.x * 2) center.x = bounds.x + bounds.w / 2;
+            else center.x = std::clamp(center.x, bounds.x + half.x, bounds.x + bounds.w - half.x);
+        }
+        if (bounds.h > 0) {
+            if (bounds.h <= half.y * 2) center.y = bounds.y + bounds.h / 2;
+            else center.y = std::clamp(center.y, bounds.y + half.y, bounds.y + bounds.h - half.y);
+        }
+    }
+
+public:
+    Camera2D(float viewportW, float viewportH)
+        : center(viewportW / 2, viewportH / 2), target(center),
+        viewportSize(viewportW, viewportH), bounds{ 0, 0, 0, 0 },
+        zoom(1.0f), targetZoom(1.0f), followSharpness(8.0f), zoomSharpness(4.0f),
+        shakeIntensity(0), shakeDecay(30.0f), shakeOffset(0, 0) {
+    }
+
+    void setBounds(const SDL_FRect& worldBounds) { bounds = worldBounds; }
+    void setViewportSize(float w, float h) { viewportSize = Vec2(w, h); }
+    void setFollowSharpness(float sharpness) { followSharpness = sharpness; }
+    void follow(const Vec2& point) { target = point; }
+    void setZoom(float z) { targetZoom = std::clamp(z, 0.1f, 10.0f); }
+
+    // Jump straight to the target (level start, respawn)
+    void snap() {
+        center = target;
+        zoom = targetZoom;
+        clampToBounds();
+    }
+
+    void addShake(float intensity) {
+        shakeIntensity = std::max(shakeIntensity, intensity);
+    }
+
+    void update(float dt) {
+        center.x = approach(center.x, target.x, followSharpness, dt);
+        center.y = approach(center.y, target.y, followSharpness, dt);
+        zoom = approach(zoom, targetZoom, zoomSharpness, dt);
+        clampToBounds();
+
+        if (shakeIntensity > 0) {
+            shakeOffset.x = Utils::randomFloat(-shakeIntensity, shakeIntensity);
+            shakeOffset.y = Utils::randomFloat(-shakeIntensity, shakeIntensity);
+            shakeIntensity = std::max(0.0f, shakeIntensity - dt * shakeDecay);
+        }
+        else {
+            shakeOffset = Vec2(0, 0);
+        }
+    }
+
+    Vec2 getCenter() const { return center; }
+    float getZoom() const { return zoom; }
+    float getShake() const { return shakeIntensity; }
+    Vec2 getHalfExtent() const { return Vec2(viewportSize.x / (2 * zoom), viewportSize.y / (2 * zoom)); }
+
+    // World-space top-left of the view, including shake
+    Vec2 getOrigin() const {
+        Vec2 half = getHalfExtent();
+        return Vec2(center.x - half.x + shakeOffset.x / zoom, center.y - half.y + shakeOffset.y / zoom);
+    }
+
+    Vec2 worldToScreen(const Vec2& p) const {
+        Vec2 origin = getOrigin();
+        return Vec2((p.x - origin.x) * zoom, (p.y - origin.y) * zoom);
+    }
+
+    Vec2 screenToWorld(const Vec2& p) const {
+        Vec2 origin = getOrigin();
+        return Vec2(p.x / zoom + origin.x, p.y / zoom + origin.y);
+    }
+
+    // World-space rect covered by the viewport, grown by margin on every side
+    SDL_FRect getVisibleRect(float margin = 0) const {
+        Vec2 origin = getOrigin();
+        Vec2 half = getHalfExtent();
+        return { origin.x - margin, origin.y - margin, half.x * 2 + margin * 2, half.y * 2 + margin * 2 };
+    }
+
+    bool isVisible(const SDL_FRect& r, float margin = 0) const {
+        SDL_FRect v = getVisibleRect(margin);
+        return r.x <= v.x + v.w && v.x <= r.x + r.w && r.y <= v.y + v.h && v.y <= r.y + r.h;
+    }
+
+    bool isVisible(const Vec2& p, float radius = 0) const {
+        SDL_FRect v = getVisibleRect(radius);
+        return p.x >= v.x && p.x <= v.x + v.w && p.y >= v.y && p.y <= v.y + v.h;
+    }
+
+    // Route all subsequent Draw calls through this camera
+    void apply(Draw& draw) const {
+        Vec2 origin = getOrigin();
+        draw.set_view(origin.x, origin.y, zoom);
+    }
+};
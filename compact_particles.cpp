@@ -0,0 +1,305 @@
+// compact_particles.cpp - Quantised structure-of-arrays particles for huge ambient emitters
+// A full Particle is a few hundred bytes (ramp, trail and behaviour vectors,
+// custom data) behind its own allocation, so an emitter with 100k of them
+// spends its update streaming cache misses. CompactParticles keeps what an
+// ambient particle (snow, stars, dust) needs in 28 bytes, in parallel arrays:
+//   position, velocity  float          errors here would accumulate
+//   age / lifetime      UNORM16        advanced with dithered rounding, so
+//                                      lifetimes are unbiased
+//   1 / lifetime        1/4096 per s   lifetimes from 1/16 s; error under
+//                                      0.1% up to 8 s, L/8192 above that
+//   start size          1/256 px       up to 256 px
+//   rotation            UNORM16 turns  wraps for free
+//   angular velocity    1/128 rad/s    signed, up to 256 rad/s
+//   1 / mass            1/16384        masses from 0.25
+// Colour is not stored: the emitter's ramp is sampled into a 256-entry table
+// indexed by the top byte of the age fraction, and size follows the same
+// eased curve as Particle::getCurrentSize.
+// update() unpacks four particles per SSE2 register, integrates and packs
+// them back (scalar fallback), then compacts out the dead ones keeping
+// order. microbench's particles/ benchmarks compare its speed with
+// Particle, and `microbench --compact-error N` its error through both kernels.
+#pragma once
+#include <SDL3/SDL.h>
+#include <vector>
+#include <cmath>
+#include <cstdint>
+#include <algorithm>
+#include "utils.cpp"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define PARTICLE_SSE2 1
+#endif
+
+// Everything the compact kernel applies, gathered from the emitter once per
+// update
+struct CompactForces {
+    Vec2 gravity;            // Acceleration, independent of mass
+    Vec2 wind;               // Force, divided by mass
+    float windJitter = 0;    // WIND behaviour: random x force in [-j, j]
+    float wander = 0;        // WANDER behaviour: force in a random direction
+    float turbulence = 0;    // Emitter turbulence (noise follows age)
+    float flowNoise = 0;     // TURBULENCE behaviour (noise by position only)
+    float drag = 0.98f;      // Per step velocity factor
+};
+
+class CompactParticles {
+public:
+    static constexpr float AGE_ONE = 65535.0f;
+    static constexpr float RATE_SCALE = 4096.0f;
+    static constexpr float SIZE_SCALE = 256.0f;
+    static constexpr float SPIN_SCALE = 128.0f;
+    static constexpr float INV_MASS_SCALE = 16384.0f;
+    static constexpr int COLOR_STEPS = 256;
+
+    std::vector<float> x, y, vx, vy;
+    std::vector<Uint16> age;      // age / lifetime
+    std::vector<Uint16> rate;     // 1 / lifetime
+    std::vector<Uint16> size;     // Start size
+    std::vector<Uint16> rotation; // Turns
+    std::vector<Sint16> spin;     // Angular velocity
+    std::vector<Uint16> invMass;
+
+private:
+    Uint32 rng[4] = { 0x9E3779B9u, 0x7F4A7C15u, 0x85EBCA6Bu, 0xC2B2AE35u }; // One xorshift per lane
+    bool anyDead = false;
+
+    static Uint16 quantise(float v, float scale, float max = 65535.0f) {
+        return static_cast<Uint16>(std::clamp(v * scale + 0.5f, 0.0f, max));
+    }
+
+    Uint32 nextRandom(int lane) {
+        Uint32 s = rng[lane];
+        s ^= s << 13;
+        s ^= s >> 17;
+        s ^= s << 5;
+        rng[lane] = s;
+        return s;
+    }
+
+    // Parabolic sine, |error| < 0.001 on [-pi, pi]; shared by both kernels
+    static float fastSin(float a) {
+        float s = 1.2732395f * a - 0.4052847f * a * std::abs(a);
+        return 0.225f * (s * std::abs(s) - s) + s;
+    }
+
+    // Scalar step for particles [begin, end), also the non-SSE2 kernel
+    void updateScalar(size_t begin, size_t end, float dt, const CompactForces& f) {
+        float ageStep = dt * (AGE_ONE / RATE_SCALE);
+        float spinStep = dt * (65536.0f / TWO_PI) / SPIN_SCALE;
+        for (size_t i = begin; i < end; ++i) {
+            int lane = static_cast<int>(i & 3);
+            float im = invMass[i] * (1.0f / INV_MASS_SCALE);
+            float fx = f.wind.x, fy = f.wind.y;
+            if (f.wander > 0) {
+                float a = (nextRandom(lane) >> 8) * (TWO_PI / 16777216.0f) - PI;
+                float c = a + HALF_PI;
+                if (c > PI) c -= TWO_PI;
+                fx += f.wander * fastSin(c);
+                fy += f.wander * fastSin(a);
+            }
+            if (f.windJitter > 0) {
+                fx += f.windJitter * ((nextRandom(lane) >> 8) * (2.0f / 16777216.0f) - 1.0f);
+            }
+            vx[i] = (vx[i] + (f.gravity.x + fx * im) * dt) * f.drag;
+            vy[i] = (vy[i] + (f.gravity.y + fy * im) * dt) * f.drag;
+            x[i] += vx[i] * dt;
+            y[i] += vy[i] * dt;
+
+            int turned = rotation[i] + static_cast<int>(std::lround(spin[i] * spinStep));
+            rotation[i] = static_cast<Uint16>(turned & 0xFFFF);
+
+            float dither = (nextRandom(lane) >> 8) * (1.0f / 16777216.0f);
+            float next = std::floor(age[i] + rate[i] * ageStep + dither);
+            if (next >= AGE_ONE) anyDead = true;
+            age[i] = static_cast<Uint16>(std::min(next, AGE_ONE));
+        }
+    }
+
+#ifdef PARTICLE_SSE2
+    static __m128 unpackU16(const Uint16* p) {
+        __m128i v = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(p));
+        return _mm_cvtepi32_ps(_mm_unpacklo_epi16(v, _mm_setzero_si128()));
+    }
+
+    static __m128i unpackS16(const Sint16* p) {
+        __m128i v = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(p));
+        return _mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16);
+    }
+
+    // v in [0, 65535]; SSE2 only packs signed, so bias through the sign bit
+    static void packU16(Uint16* p, __m128i v) {
+        __m128i biased = _mm_sub_epi32(v, _mm_set1_epi32(32768));
+        __m128i packed = _mm_xor_si128(_mm_packs_epi32(biased, biased), _mm_set1_epi16(static_cast<short>(0x8000)));
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(p), packed);
+    }
+
+    static __m128i nextRandom4(__m128i& s) {
+        s = _mm_xor_si128(s, _mm_slli_epi32(s, 13));
+        s = _mm_xor_si128(s, _mm_srli_epi32(s, 17));
+        s = _mm_xor_si128(s, _mm_slli_epi32(s, 5));
+        return s;
+    }
+
+    // 24 random bits as a float in [0, 1)
+    static __m128 random01(__m128i& s) {
+        return _mm_mul_ps(_mm_cvtepi32_ps(_mm_srli_epi32(nextRandom4(s), 8)), _mm_set1_ps(1.0f / 16777216.0f));
+    }
+
+    static __m128 fastSin4(__m128 a) {
+        const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+        __m128 s = _mm_sub_ps(_mm_mul_ps(_mm_set1_ps(1.2732395f), a),
+            _mm_mul_ps(_mm_mul_ps(_mm_set1_ps(0.4052847f), a), _mm_and_ps(a, absMask)));
+        __m128 t = _mm_sub_ps(_mm_mul_ps(s, _mm_and_ps(s, absMask)), s);
+        return _mm_add_ps(_mm_mul_ps(_mm_set1_ps(0.225f), t), s);
+    }
+
+    void updateSSE2(size_t end, float dt, const CompactForces& f) {
+        const __m128 vdt = _mm_set1_ps(dt);
+        const __m128 drag = _mm_set1_ps(f.drag);
+        const __m128 gx = _mm_set1_ps(f.gravity.x), gy = _mm_set1_ps(f.gravity.y);
+        const __m128 wx = _mm_set1_ps(f.wind.x), wy = _mm_set1_ps(f.wind.y);
+        const __m128 wander = _mm_set1_ps(f.wander), jitter = _mm_set1_ps(f.windJitter);
+        const __m128 invMassScale = _mm_set1_ps(1.0f / INV_MASS_SCALE);
+        const __m128 spinStep = _mm_set1_ps(dt * (65536.0f / TWO_PI) / SPIN_SCALE);
+        const __m128 ageStep = _mm_set1_ps(dt * (AGE_ONE / RATE_SCALE));
+        const __m128 ageOne = _mm_set1_ps(AGE_ONE);
+        const __m128 pi = _mm_set1_ps(PI), twoPi = _mm_set1_ps(TWO_PI), halfPi = _mm_set1_ps(HALF_PI);
+        __m128i state = _mm_loadu_si128(reinterpret_cast<const __m128i*>(rng));
+        int dead = 0;
+
+        for (size_t i = 0; i + 4 <= end; i += 4) {
+            __m128 im = _mm_mul_ps(unpackU16(&invMass[i]), invMassScale);
+            __m128 fx = wx, fy = wy;
+            if (f.wander > 0) {
+                __m128 a = _mm_sub_ps(_mm_mul_ps(random01(state), twoPi), pi);
+                __m128 c = _mm_add_ps(a, halfPi);
+                c = _mm_sub_ps(c, _mm_and_ps(_mm_cmpgt_ps(c, pi), twoPi));
+                fx = _mm_add_ps(fx, _mm_mul_ps(wander, fastSin4(c)));
+                fy = _mm_add_ps(fy, _mm_mul_ps(wander, fastSin4(a)));
+            }
+            if (f.windJitter > 0) {
+                __m128 r = _mm_sub_ps(_mm_mul_ps(random01(state), _mm_set1_ps(2.0f)), _mm_set1_ps(1.0f));
+                fx = _mm_add_ps(fx, _mm_mul_ps(jitter, r));
+            }
+
+            __m128 ax = _mm_add_ps(gx, _mm_mul_ps(fx, im));
+            __m128 ay = _mm_add_ps(gy, _mm_mul_ps(fy, im));
+            __m128 velX = _mm_mul_ps(_mm_add_ps(_mm_loadu_ps(&vx[i]), _mm_mul_ps(ax, vdt)), drag);
+            __m128 velY = _mm_mul_ps(_mm_add_ps(_mm_loadu_ps(&vy[i]), _mm_mul_ps(ay, vdt)), drag);
+            _mm_storeu_ps(&vx[i], velX);
+            _mm_storeu_ps(&vy[i], velY);
+            _mm_storeu_ps(&x[i], _mm_add_ps(_mm_loadu_ps(&x[i]), _mm_mul_ps(velX, vdt)));
+            _mm_storeu_ps(&y[i], _mm_add_ps(_mm_loadu_ps(&y[i]), _mm_mul_ps(velY, vdt)));
+
+            __m128i rot = _mm_unpacklo_epi16(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(&rotation[i])),
+                _mm_setzero_si128());
+            __m128i turn = _mm_cvtps_epi32(_mm_mul_ps(_mm_cvtepi32_ps(unpackS16(&spin[i])), spinStep));
+            packU16(&rotation[i], _mm_and_si128(_mm_add_epi32(rot, turn), _mm_set1_epi32(0xFFFF)));
+
+            // floor(age + step + dither) via truncation, everything is positive
+            __m128 next = _mm_add_ps(_mm_add_ps(unpackU16(&age[i]), _mm_mul_ps(unpackU16(&rate[i]), ageStep)),
+                random01(state));
+            dead |= _mm_movemask_ps(_mm_cmpge_ps(next, ageOne));
+            packU16(&age[i], _mm_cvttps_epi32(_mm_min_ps(next, ageOne)));
+        }
+
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(rng), state);
+        if (dead) anyDead = true;
+    }
+#endif
+
+    // Scalar noise forces; folded into velocity before the kernel, which is
+    // the same as adding them to the acceleration
+    void applyNoise(float dt, const CompactForces& f) {
+        for (size_t i = 0; i < count(); ++i) {
+            float im = invMass[i] * (1.0f / INV_MASS_SCALE) * dt;
+            if (f.turbulence > 0) {
+                float seconds = ageFraction(i) * lifetime(i);
+                float n = Utils::perlinNoise(x[i] * 0.01f + seconds, y[i] * 0.01f + seconds);
+                vx[i] += n * f.turbulence * im;
+                vy[i] += n * f.turbulence * im;
+            }
+            if (f.flowNoise > 0) {
+                float n = Utils::perlinNoise(x[i] * 0.01f, y[i] * 0.01f);
+                vx[i] += n * f.flowNoise * im;
+                vy[i] += n * f.flowNoise * im;
+            }
+        }
+    }
+
+    // Drops particles whose age reached one, keeping the rest in order
+    void removeDead() {
+        size_t n = count(), w = 0;
+        for (size_t i = 0; i < n; ++i) {
+            if (age[i] >= 65535) continue;
+            if (w != i) {
+                x[w] = x[i]; y[w] = y[i]; vx[w] = vx[i]; vy[w] = vy[i];
+                age[w] = age[i]; rate[w] = rate[i]; size[w] = size[i];
+                rotation[w] = rotation[i]; spin[w] = spin[i]; invMass[w] = invMass[i];
+            }
+            ++w;
+        }
+        resize(w);
+    }
+
+    void resize(size_t n) {
+        x.resize(n); y.resize(n); vx.resize(n); vy.resize(n);
+        age.resize(n); rate.resize(n); size.resize(n);
+        rotation.resize(n); spin.resize(n); invMass.resize(n);
+    }
+
+public:
+    size_t count() const { return x.size(); }
+
+    void reserve(size_t n) {
+        x.reserve(n); y.reserve(n); vx.reserve(n); vy.reserve(n);
+        age.reserve(n); rate.reserve(n); size.reserve(n);
+        rotation.reserve(n); spin.reserve(n); invMass.reserve(n);
+    }
+
+    void clear() { resize(0); }
+
+    void spawn(const Vec2& position, const Vec2& velocity, float lifetime, float startSize,
+        float radians, float angularVelocity, float mass) {
+        x.push_back(position.x);
+        y.push_back(position.y);
+        vx.push_back(velocity.x);
+        vy.push_back(velocity.y);
+        age.push_back(0);
+        rate.push_back(std::max<Uint16>(1, quantise(1.0f / std::max(lifetime, 1e-3f), RATE_SCALE)));
+        size.push_back(quantise(startSize, SIZE_SCALE));
+        float turns = radians / TWO_PI;
+        rotation.push_back(static_cast<Uint16>(static_cast<int>((turns - std::floor(turns)) * 65536.0f) & 0xFFFF));
+        spin.push_back(static_cast<Sint16>(std::clamp(angularVelocity * SPIN_SCALE, -32768.0f, 32767.0f)));
+        invMass.push_back(quantise(1.0f / std::max(mass, 0.25f), INV_MASS_SCALE));
+    }
+
+    void update(float dt, const CompactForces& forces) {
+        if (count() == 0) return;
+        if (forces.turbulence > 0 || forces.flowNoise > 0) applyNoise(dt, forces);
+
+        size_t vectorEnd = 0;
+#ifdef PARTICLE_SSE2
+        vectorEnd = count() & ~static_cast<size_t>(3);
+        updateSSE2(vectorEnd, dt, forces);
+#endif
+        updateScalar(vectorEnd, count(), dt, forces);
+
+        if (anyDead) {
+            removeDead();
+            anyDead = false;
+        }
+    }
+
+    // ===== DECODE (drawing) =====
+    float ageFraction(size_t i) const { return age[i] * (1.0f / AGE_ONE); }
+    float lifetime(size_t i) const { return RATE_SCALE / rate[i]; }
+    float startSize(size_t i) const { return size[i] * (1.0f / SIZE_SCALE); }
+    float rotationRadians(size_t i) const { return rotation[i] * (TWO_PI / 65536.0f); }
+    int colorIndex(size_t i) const { return age[i] >> 8; }
+    size_t byteSize() const {
+        return count() * (4 * sizeof(float) + 6 * sizeof(Uint16));
+    }
+};
@@ -0,0 +1,202 @@
+// decal_layer.cpp - Persistent decals (blood, scorch marks) baked into render-target tiles
+// Particles that come to rest are stamped once and freed. Stamps are queued
+// by the simulation (no renderer needed) and baked into the tile textures
+// they touch on the next draw; after that a decal costs nothing per frame
+// beyond blitting the visible tiles. An optional fade pass periodically
+// subtracts a fixed alpha from every tile so old marks wash out completely.
+#pragma once
+#include <SDL3/SDL.h>
+#include <vector>
+#include <cmath>
+#include <algorithm>
+#include "utils.cpp"
+#include "renderer2d.cpp"
+
+struct Decal {
+    float x, y;
+    float radius;
+    SDL_Color color;
+};
+
+class DecalLayer {
+private:
+    // Stamps waiting for a renderer; headless runs stop queueing at the cap
+    static constexpr size_t MAX_PENDING = 4096;
+    // Fade is applied in steps of at least this alpha, so a pass over every
+    // tile runs every few frames rather than each frame
+    static constexpr float FADE_STEP = 4.0f / 255.0f;
+
+    SDL_FRect bounds;
+    int tileSize;
+    int cols, rows;
+    std::vector<SDL_Texture*> tiles; // Null until the first stamp lands there
+    SDL_Renderer* owner;             // Renderer the tiles were created on
+
+    std::vector<Decal> pending;
+    float fadeRate;    // Alpha removed per second, 0 = marks stay forever
+    float fadeAmount;  // Accumulated, applied at the next draw
+    bool fadeSupported;
+    SDL_BlendMode fadeMode;
+
+    void destroyTiles() {
+        for (SDL_Texture*& tile : tiles) {
+            if (tile) SDL_DestroyTexture(tile);
+            tile = nullptr;
+        }
+    }
+
+    int tileIndex(int tx, int ty) const { return ty * cols + tx; }
+
+    SDL_Texture* getTile(Draw& draw, int tx, int ty) {
+        SDL_Texture*& tile = tiles[tileIndex(tx, ty)];
+        if (tile) return tile;
+
+        tile = SDL_CreateTexture(draw.renderer, SDL_PIXELFORMAT_ARGB8888,
+            SDL_TEXTUREACCESS_TARGET, tileSize, tileSize);
+        if (!tile) return nullptr;
+
+        // Targets hold premultiplied colour after BLEND stamps
+        SDL_SetTextureBlendMode(tile, SDL_BLENDMODE_BLEND_PREMULTIPLIED);
+        SDL_SetRenderTarget(draw.renderer, tile);
+        draw.color(0, 0, 0, 0);
+        draw.clear();
+        return tile;
+    }
+
+    void bakePending(Draw& draw) {
+        for (const Decal& d : pending) {
+            int r = static_cast<int>(std::ceil(d.radius));
+            int tx0 = tileX(d.x - r), tx1 = tileX(d.x + r);
+            int ty0 = tileY(d.y - r), ty1 = tileY(d.y + r);
+
+            // A stamp across a tile seam is drawn into every tile it touches
+            for (int ty = ty0; ty <= ty1; ++ty) {
+                for (int tx = tx0; tx <= tx1; ++tx) {
+                    SDL_Texture* tile = getTile(draw, tx, ty);
+                    if (!tile) continue;
+                    SDL_SetRenderTarget(draw.renderer, tile);
+                    draw.set_view(bounds.x + tx * tileSize, bounds.y + ty * tileSize);
+                    draw.color(d.color.r, d.color.g, d.color.b, d.color.a);
+                    draw.fill_circle(static_cast<int>(d.x), static_cast<int>(d.y), r);
+                }
+            }
+        }
+        pending.clear();
+    }
+
+    // Subtracts the same amount from premultiplied colour and alpha, so
+    // colour never exceeds alpha and faint texels still reach zero (scaling
+    // by 1 - step would stall once alpha * step rounds to nothing)
+    void applyFade(Draw& draw) {
+        Uint8 amount = static_cast<Uint8>(std::min(1.0f, fadeAmount) * 255.0f);
+        // Keep the rounding remainder so the rate holds over time
+        fadeAmount = fadeAmount >= 1.0f ? 0.0f : fadeAmount - amount / 255.0f;
+
+        SDL_BlendMode previous = draw.current_blend;
+        draw.reset_view();
+        draw.blend(fadeMode);
+        draw.color(amount, amount, amount, amount);
+        for (SDL_Texture* tile : tiles) {
+            if (!tile) continue;
+            SDL_SetRenderTarget(draw.renderer, tile);
+            draw.fill_rect(0, 0, static_cast<float>(tileSize), static_cast<float>(tileSize));
+        }
+        draw.blend(previous);
+    }
+
+public:
+    DecalLayer() : bounds{ 0, 0, 0, 0 }, tileSize(512), cols(0), rows(0), owner(nullptr),
+        fadeRate(0), fadeAmount(0), fadeSupported(false), fadeMode(SDL_BLENDMODE_INVALID) {
+    }
+
+    ~DecalLayer() { destroyTiles(); }
+
+    DecalLayer(const DecalLayer&) = delete;
+    DecalLayer& operator=(const DecalLayer&) = delete;
+
+    // Area that can receive decals; stamps outside it are clamped to edge tiles
+    void setBounds(const SDL_FRect& area, int tile = 512) {
+        destroyTiles();
+        bounds = area;
+        tileSize = std::max(16, tile);
+        cols = std::max(1, static_cast<int>(std::ceil(area.w / tileSize)));
+        rows = std::max(1, static_cast<int>(std::ceil(area.h / tileSize)));
+        tiles.assign(static_cast<size_t>(cols) * rows, nullptr);
+    }
+
+    void setFadeRate(float alphaPerSecond) { fadeRate = std::max(0.0f, alphaPerSecond); }
+
+    void stamp(Vec2 position, float radius, const Color& color) {
+        if (pending.size() >= MAX_PENDING) return;
+        pending.push_back({ position.x, position.y, radius, color.toSDL() });
+    }
+
+    void update(float dt) {
+        if (fadeRate > 0) fadeAmount += fadeRate * dt;
+    }
+
+    void clear() {
+        destroyTiles();
+        pending.clear();
+        fadeAmount = 0;
+    }
+
+    int tileX(float x) const {
+        return std::clamp(static_cast<int>(std::floor((x - bounds.x) / tileSize)), 0, cols - 1);
+    }
+
+    int tileY(float y) const {
+        return std::clamp(static_cast<int>(std::floor((y - bounds.y) / tileSize)), 0, rows - 1);
+    }
+
+    // Bakes queued stamps (and any due fade) into the tiles, then blits the
+    // tiles under `visible` through draw's current view. Draw stats count the
+    // blits; traces contain no decal work.
+    void draw(Draw& draw, const SDL_FRect& visible) {
+        if (!draw.renderer || tiles.empty()) return;
+
+        if (owner != draw.renderer) {
+            destroyTiles();
+            owner = draw.renderer;
+            // dst - src on every channel
+            fadeMode = SDL_ComposeCustomBlendMode(
+                SDL_BLENDFACTOR_ONE, SDL_BLENDFACTOR_ONE, SDL_BLENDOPERATION_REV_SUBTRACT,
+                SDL_BLENDFACTOR_ONE, SDL_BLENDFACTOR_ONE, SDL_BLENDOPERATION_REV_SUBTRACT);
+            fadeSupported = SDL_SetRenderDrawBlendMode(draw.renderer, fadeMode);
+            SDL_SetRenderDrawBlendMode(draw.renderer, draw.current_blend);
+        }
+
+        bool fade = fadeSupported && fadeAmount >= FADE_STEP;
+        if (!pending.empty() || fade) {
+            SDL_Texture* target = SDL_GetRenderTarget(draw.renderer);
+            RenderTrace* trace = draw.trace;
+            draw.push_transform();
+            draw.trace = nullptr;
+
+            bakePending(draw);
+            if (fade) applyFade(draw);
+
+            SDL_SetRenderTarget(draw.renderer, target);
+            draw.pop_transform();
+            draw.trace = trace;
+        }
+
+        int tx0 = tileX(visible.x), tx1 = tileX(visible.x + visible.w);
+        int ty0 = tileY(visible.y), ty1 = tileY(visible.y + visible.h);
+        float size = static_cast<float>(tileSize);
+        for (int ty = ty0; ty <= ty1; ++ty) {
+            for (int tx = tx0; tx <= tx1; ++tx) {
+                SDL_Texture* tile = tiles[tileIndex(tx, ty)];
+                if (!tile) continue;
+                draw.texture(tile, nullptr, { bounds.x + tx * tileSize, bounds.y + ty * tileSize, size, size });
+            }
+        }
+    }
+
+    size_t getPendingCount() const { return pending.size(); }
+
+    size_t getTileCount() const {
+        return static_cast<size_t>(std::count_if(tiles.begin(), tiles.end(),
+            [](SDL_Texture* t) { return t != nullptr; }));
+    }
+};
@@ -0,0 +1,85 @@
+// draw_arena.cpp - Parallel draw recording: workers build triangles, the main thread submits
+// Each job gets its own recording Draw (see Draw::record_into) bound to a
+// chunk of the frame arena. Jobs start from the submitting Draw's transform,
+// colour, blend and tint, run the ordinary draw code (emitters, entities)
+// on the worker pool and only produce screen-space vertices. submit() then
+// walks the chunks in job order and issues one SDL_RenderGeometry per blend
+// run, so the result is what the same draw code would have produced
+// serially, in a handful of calls instead of one per scanline or line.
+// Chunks keep their capacity between frames, so a steady scene stops
+// allocating.
+#pragma once
+#include <SDL3/SDL.h>
+#include <vector>
+#include <memory>
+#include "renderer2d.cpp"
+#include "thread_pool.cpp"
+
+class DrawArena {
+private:
+    struct Slot {
+        DrawChunk chunk;
+        Draw recorder;
+    };
+
+    std::vector<std::unique_ptr<Slot>> slots;
+    size_t used = 0;
+
+public:
+    // Prepares `count` chunks whose recorders start from `from`'s state
+    void begin(const Draw& from, size_t count) {
+        while (slots.size() < count) slots.push_back(std::make_unique<Slot>());
+        used = count;
+        for (size_t i = 0; i < count; ++i) {
+            Slot& slot = *slots[i];
+            slot.chunk.clear();
+            Draw& d = slot.recorder;
+            d.renderer = from.renderer;
+            d.xform = from.xform;
+            d.xform_stack.clear();
+            d.current_color = from.current_color;
+            d.current_blend = from.current_blend;
+            d.tint_color = from.tint_color;
+            d.stats = DrawStats();
+            d.record_into(&slot.chunk);
+        }
+    }
+
+    Draw& recorder(size_t i) { return slots[i]->recorder; }
+    size_t size() const { return used; }
+
+    // Runs job(i, recorder) for i in [0, count) on the pool (inline without
+    // one) and waits for all of them. Jobs may only read shared state.
+    template <typename Job>
+    void record(ThreadPool* pool, const Draw& from, size_t count, Job job) {
+        begin(from, count);
+        if (!pool || count < 2) {
+            for (size_t i = 0; i < count; ++i) job(i, recorder(i));
+            return;
+        }
+        for (size_t i = 0; i < count; ++i) {
+            pool->submit([this, &job, i]() { job(i, recorder(i)); });
+        }
+        pool->waitIdle();
+    }
+
+    // Main thread: submits every chunk in job order, one geometry call per
+    // run straight from the chunk, and folds the recorders' counters into
+    // draw's. The blend mode is only set when it changes.
+    void submit(Draw& draw) {
+        SDL_BlendMode restore = draw.current_blend;
+        for (size_t i = 0; i < used; ++i) {
+            Slot& slot = *slots[i];
+            draw.stats += slot.recorder.stats;
+            const DrawChunk& chunk = slot.chunk;
+
+            for (const DrawChunk::Run& run : chunk.runs) {
+                if (run.index_count == 0) continue;
+                if (run.blend != draw.current_blend) draw.blend(run.blend);
+                draw.submit_geometry(chunk.vertices.data(), static_cast<int>(chunk.vertices.size()),
+                    chunk.indices.data() + run.first_index, run.index_count);
+            }
+        }
+        if (draw.current_blend != restore) draw.blend(restore);
+    }
+};
@@ -0,0 +1,277 @@
+// frame_recorder.cpp - Gameplay recording without stalling the game loop
+// While recording, each frame is drawn into one of SLOTS render targets and
+// then blitted to the screen. A slot is read back LAG frames after it was
+// drawn, so the readback never waits on the frame just submitted, and the
+// surface is handed to a writer thread that converts and writes it:
+//   Y4M          - one uncompressed 4:2:0 stream (plays in ffplay/mpv)
+//   PPM_SEQUENCE - <prefix>_00000.ppm, <prefix>_00001.ppm, ...
+// If the writer falls MAX_QUEUED frames behind, frames are dropped (and
+// counted) rather than blocking the frame. Works on any renderer with
+// target support, including the software renderer in headless runs.
+#pragma once
+#include <SDL3/SDL.h>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <vector>
+#include <string>
+#include <cstdio>
+#include <algorithm>
+#include "renderer2d.cpp"
+
+enum class RecordFormat { Y4M, PPM_SEQUENCE };
+
+class FrameRecorder {
+public:
+    static constexpr int SLOTS = 3;
+    static constexpr int LAG = 2;           // Frames between drawing a slot and reading it
+    static constexpr size_t MAX_QUEUED = 8; // Frames waiting for the writer
+
+private:
+    struct Slot {
+        SDL_Texture* texture = nullptr;
+        bool pending = false; // Drawn, not yet read back
+    };
+
+    Slot slots[SLOTS];
+    int current;
+    SDL_Renderer* renderer;
+    SDL_Texture* screenTarget; // Target to restore in endFrame
+    bool inFrame;
+    int width, height;
+
+    // Writer thread
+    std::thread writer;
+    std::mutex queueMutex;
+    std::condition_variable queueReady;
+    std::deque<SDL_Surface*> queue;
+    bool stopping;
+
+    RecordFormat format;
+    std::string path;
+    int fps;
+    FILE* stream; // Y4M output
+    std::vector<Uint8> plane; // Writer scratch: YUV planes or RGB rows
+    int written;  // Writer thread only until stop() joins
+    int dropped;
+
+    void writeY4M(const SDL_Surface* s) {
+        int cw = (width + 1) / 2, ch = (height + 1) / 2;
+        plane.resize(static_cast<size_t>(width) * height + 2 * static_cast<size_t>(cw) * ch);
+        Uint8* Y = plane.data();
+        Uint8* U = Y + static_cast<size_t>(width) * height;
+        Uint8* V = U + static_cast<size_t>(cw) * ch;
+
+        // Full-range BT.601 (C420jpeg), chroma averaged over each 2x2 block
+        for (int y = 0; y < height; ++y) {
+            const Uint32* row = reinterpret_cast<const Uint32*>(static_cast<const Uint8*>(s->pixels) + y * s->pitch);
+            for (int x = 0; x < width; ++x) {
+                Uint32 p = row[x];
+                int r = (p >> 16) & 0xFF, g = (p >> 8) & 0xFF, b = p & 0xFF;
+                Y[y * width + x] = static_cast<Uint8>((77 * r + 150 * g + 29 * b + 128) >> 8);
+            }
+        }
+        for (int cy = 0; cy < ch; ++cy) {
+            for (int cx = 0; cx < cw; ++cx) {
+                int r = 0, g = 0, b = 0, n = 0;
+                for (int dy = 0; dy < 2; ++dy) {
+                    int y = std::min(cy * 2 + dy, height - 1);
+                    const Uint32* row = reinterpret_cast<const Uint32*>(static_cast<const Uint8*>(s->pixels) + y * s->pitch);
+                    for (int dx = 0; dx < 2; ++dx) {
+                        Uint32 p = row[std::min(cx * 2 + dx, width - 1)];
+                        r += (p >> 16) & 0xFF; g += (p >> 8) & 0xFF; b += p & 0xFF; n++;
+                    }
+                }
+                r /= n; g /= n; b /= n;
+                U[cy * cw + cx] = static_cast<Uint8>(std::clamp((-43 * r - 85 * g + 128 * b + 32768) >> 8, 0, 255));
+                V[cy * cw + cx] = static_cast<Uint8>(std::clamp((128 * r - 107 * g - 21 * b + 32768) >> 8, 0, 255));
+            }
+        }
+
+        std::fputs("FRAME\n", stream);
+        std::fwrite(plane.data(), 1, plane.size(), stream);
+    }
+
+    void writePPM(const SDL_Surface* s) {
+        char name[32];
+        std::snprintf(name, sizeof(name), "_%05d.ppm", written);
+        FILE* f = std::fopen((path + name).c_str(), "wb");
+        if (!f) return;
+
+        std::fprintf(f, "P6\n%d %d\n255\n", width, height);
+        plane.resize(static_cast<size_t>(width) * 3);
+        for (int y = 0; y < height; ++y) {
+            const Uint32* row = reinterpret_cast<const Uint32*>(static_cast<const Uint8*>(s->pixels) + y * s->pitch);
+            for (int x = 0; x < width; ++x) {
+                plane[x * 3 + 0] = static_cast<Uint8>(row[x] >> 16);
+                plane[x * 3 + 1] = static_cast<Uint8>(row[x] >> 8);
+                plane[x * 3 + 2] = static_cast<Uint8>(row[x]);
+            }
+            std::fwrite(plane.data(), 1, plane.size(), f);
+        }
+        std::fclose(f);
+    }
+
+    void writeFrame(SDL_Surface* surface) {
+        // Readbacks come in the target's format; normalise off the game thread
+        SDL_Surface* argb = surface;
+        if (surface->format != SDL_PIXELFORMAT_ARGB8888) {
+            argb = SDL_ConvertSurface(surface, SDL_PIXELFORMAT_ARGB8888);
+        }
+        if (argb && argb->w >= width && argb->h >= height) {
+            if (format == RecordFormat::Y4M) writeY4M(argb);
+            else writePPM(argb);
+            written++;
+        }
+        if (argb && argb != surface) SDL_DestroySurface(argb);
+        SDL_DestroySurface(surface);
+    }
+
+    void writeLoop() {
+        std::unique_lock<std::mutex> lock(queueMutex);
+        while (true) {
+            queueReady.wait(lock, [this]() { return stopping || !queue.empty(); });
+            if (queue.empty()) return; // Stopping and drained
+            SDL_Surface* surface = queue.front();
+            queue.pop_front();
+            lock.unlock();
+            writeFrame(surface);
+            lock.lock();
+        }
+    }
+
+    void readBack(Slot& slot) {
+        slot.pending = false;
+        SDL_Texture* previous = SDL_GetRenderTarget(renderer);
+        SDL_SetRenderTarget(renderer, slot.texture);
+        SDL_Surface* surface = SDL_RenderReadPixels(renderer, nullptr);
+        SDL_SetRenderTarget(renderer, previous);
+        if (!surface) return;
+
+        {
+            std::lock_guard<std::mutex> lock(queueMutex);
+            if (queue.size() < MAX_QUEUED) {
+                queue.push_back(surface);
+                surface = nullptr;
+            }
+        }
+        if (surface) {
+            SDL_DestroySurface(surface);
+            dropped++;
+        }
+        else {
+            queueReady.notify_one();
+        }
+    }
+
+    void destroySlots() {
+        for (Slot& slot : slots) {
+            if (slot.texture) SDL_DestroyTexture(slot.texture);
+            slot = Slot();
+        }
+    }
+
+public:
+    FrameRecorder() : current(0), renderer(nullptr), screenTarget(nullptr), inFrame(false),
+        width(0), height(0), stopping(false), format(RecordFormat::Y4M), fps(60),
+        stream(nullptr), written(0), dropped(0) {
+    }
+
+    ~FrameRecorder() { stop(); }
+
+    FrameRecorder(const FrameRecorder&) = delete;
+    FrameRecorder& operator=(const FrameRecorder&) = delete;
+
+    // Records w x h frames drawn on `target`. For PPM_SEQUENCE `output` is
+    // the file prefix; for Y4M it is the stream path.
+    bool start(SDL_Renderer* target, const std::string& output, RecordFormat fmt,
+        int w, int h, int framesPerSecond = 60) {
+        if (isRecording() || !target) return false;
+        renderer = target;
+        path = output;
+        format = fmt;
+        width = w;
+        height = h;
+        fps = framesPerSecond;
+        written = 0;
+        dropped = 0;
+        current = 0;
+
+        for (Slot& slot : slots) {
+            slot.texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888,
+                SDL_TEXTUREACCESS_TARGET, width, height);
+            if (!slot.texture) {
+                destroySlots();
+                return false;
+            }
+            SDL_SetTextureBlendMode(slot.texture, SDL_BLENDMODE_NONE);
+        }
+
+        if (format == RecordFormat::Y4M) {
+            stream = std::fopen(path.c_str(), "wb");
+            if (!stream) {
+                destroySlots();
+                return false;
+            }
+            std::fprintf(stream, "YUV4MPEG2 W%d H%d F%d:1 Ip A1:1 C420jpeg\n", width, height, fps);
+        }
+
+        stopping = false;
+        writer = std::thread([this]() { writeLoop(); });
+        return true;
+    }
+
+    // Reads back the frames still in flight, waits for the writer and closes
+    // the output. Returns the number of frames written.
+    int stop() {
+        if (!isRecording()) return written;
+        if (inFrame) SDL_SetRenderTarget(renderer, screenTarget);
+        inFrame = false;
+
+        // Oldest first so the stream stays in order
+        for (int i = 1; i <= SLOTS; ++i) {
+            Slot& slot = slots[(current + i) % SLOTS];
+            if (slot.pending) readBack(slot);
+        }
+        {
+            std::lock_guard<std::mutex> lock(queueMutex);
+            stopping = true;
+        }
+        queueReady.notify_one();
+        writer.join();
+
+        if (stream) std::fclose(stream);
+        stream = nullptr;
+        destroySlots();
+        return written;
+    }
+
+    bool isRecording() const { return writer.joinable(); }
+    int getDropped() const { return dropped; }
+    const std::string& getPath() const { return path; }
+
+    // Call before drawing the frame: redirects Draw into the current slot
+    void beginFrame(Draw& draw) {
+        if (!isRecording() || inFrame || draw.renderer != renderer) return;
+        inFrame = true;
+        screenTarget = SDL_GetRenderTarget(renderer);
+        SDL_SetRenderTarget(renderer, slots[current].texture);
+    }
+
+    // Call before present: shows the slot on screen and reads back the one
+    // drawn LAG frames ago
+    void endFrame(Draw& draw) {
+        if (!inFrame) return;
+        inFrame = false;
+        SDL_SetRenderTarget(renderer, screenTarget);
+        SDL_RenderTexture(renderer, slots[current].texture, nullptr, nullptr);
+        draw.stats.sdl_calls++;
+        draw.stats.pixels += static_cast<double>(width) * height;
+        slots[current].pending = true;
+
+        Slot& old = slots[(current + SLOTS - LAG) % SLOTS];
+        if (old.pending) readBack(old);
+        current = (current + 1) % SLOTS;
+    }
+};
@@ -0,0 +1,130 @@
+// game_clock.cpp - Central clock and fixed-step scheduler with named time domains
+#pragma once
+#include <vector>
+#include <array>
+#include <string>
+#include <functional>
+#include <algorithm>
+
+// Each domain runs on its own clock. Slow motion lowers a domain's scale,
+// which lowers how many fixed steps it gets per real second - every step
+// still advances exactly one fixed dt of that domain's time.
+enum class TimeDomain {
+    WORLD,   // Enemies, combat, wave logic
+    PLAYER,  // Player movement and attacks
+    EFFECTS, // Particles and slash trails
+    UI,      // Cooldowns, camera shake, overlays - always real time
+    COUNT
+};
+
+class GameClock {
+private:
+    struct DomainState {
+        double scale = 1.0;
+        double accumulator = 0.0;
+        double time = 0.0;
+    };
+
+    std::array<DomainState, static_cast<size_t>(TimeDomain::COUNT)> domains;
+    double fixedStep;
+    int maxStepsPerFrame;
+
+    DomainState& state(TimeDomain d) { return domains[static_cast<size_t>(d)]; }
+    const DomainState& state(TimeDomain d) const { return domains[static_cast<size_t>(d)]; }
+
+public:
+    explicit GameClock(double step = 1.0 / 60.0, int maxSteps = 8)
+        : fixedStep(step), maxStepsPerFrame(maxSteps) {
+    }
+
+    void setScale(TimeDomain d, float scale) { state(d).scale = std::max(0.0f, scale); }
+    float getScale(TimeDomain d) const { return static_cast<float>(state(d).scale); }
+    float getTime(TimeDomain d) const { return static_cast<float>(state(d).time); }
+    float getFixedStep() const { return static_cast<float>(fixedStep); }
+
+    // Accumulate real time and return how many fixed steps the domain owes.
+    // Backlog beyond maxStepsPerFrame is dropped rather than spiralling.
+    int consume(TimeDomain d, double realDt) {
+        DomainState& s = state(d);
+        s.accumulator += realDt * s.scale;
+
+        // Small epsilon so a frame of exactly one step is never lost to rounding
+        int steps = static_cast<int>((s.accumulator + 1e-9) / fixedStep);
+        if (steps > maxStepsPerFrame) {
+            steps = maxStepsPerFrame;
+            s.accumulator = 0;
+        }
+        else {
+            s.accumulator = std::max(0.0, s.accumulator - steps * fixedStep);
+        }
+        return steps;
+    }
+
+    void advanceTime(TimeDomain d) { state(d).time += fixedStep; }
+
+    void reset() {
+        for (auto& s : domains) {
+            s.accumulator = 0;
+            s.time = 0;
+        }
+    }
+};
+
+class Scheduler {
+public:
+    using TickFn = std::function<void(float)>;
+
+private:
+    struct System {
+        std::string name;
+        TimeDomain domain;
+        TickFn tick;
+    };
+
+    std::vector<System> systems;
+    GameClock clock;
+    bool stopRequested = false;
+
+public:
+    explicit Scheduler(double step = 1.0 / 60.0) : clock(step) {}
+
+    // Systems tick in registration order within each step round
+    void add(const std::string& name, TimeDomain domain, TickFn tick) {
+        systems.push_back({ name, domain, std::move(tick) });
+    }
+
+    void clear() { systems.clear(); }
+
+    // Skip the rest of this frame's step rounds (e.g. after game over)
+    void stopFrame() { stopRequested = true; }
+
+    // Advance every domain by realDt. Round r ticks every system whose domain
+    // still owes more than r steps, so a system never sees a partial or
+    // rescaled dt. Returns the number of rounds run.
+    int advance(float realDt) {
+        std::array<int, static_cast<size_t>(TimeDomain::COUNT)> owed{};
+        int rounds = 0;
+        for (size_t d = 0; d < owed.size(); ++d) {
+            owed[d] = clock.consume(static_cast<TimeDomain>(d), realDt);
+            rounds = std::max(rounds, owed[d]);
+        }
+
+        float step = clock.getFixedStep();
+        stopRequested = false;
+        int round = 0;
+        for (; round < rounds && !stopRequested; ++round) {
+            for (auto& system : systems) {
+                if (round < owed[static_cast<size_t>(system.domain)]) {
+                    system.tick(step);
+                }
+            }
+            for (size_t d = 0; d < owed.size(); ++d) {
+                if (round < owed[d]) clock.advanceTime(static_cast<TimeDomain>(d));
+            }
+        }
+        return round;
+    }
+
+    GameClock& getClock() { return clock; }
+    const GameClock& getClock() const { return clock; }
+};
@@ -0,0 +1,229 @@
+// hud_layer.cpp - Retained HUD: widgets cached in one screen-sized render target
+// Each widget owns a screen rect and a key built from the values it shows.
+// A widget is repainted into the cached texture only when its key or rect
+// changes; otherwise its last pixels are reused. After all widgets are
+// submitted, end() composites the texture as a single quad, so a static HUD
+// costs one blit per frame however many rects and text lines it contains.
+// Widgets not submitted in a frame are erased from the cache. Without render
+// target support every widget simply paints straight to the screen.
+#pragma once
+#include <SDL3/SDL.h>
+#include <vector>
+#include <string>
+#include <cstring>
+#include <cmath>
+#include <type_traits>
+#include <algorithm>
+#include "renderer2d.cpp"
+
+// FNV-1a over the values a widget displays; an unchanged key skips the repaint
+class HudKey {
+private:
+    Uint64 hash = 14695981039346656037ull;
+
+    void bytes(const void* data, size_t size) {
+        const Uint8* p = static_cast<const Uint8*>(data);
+        for (size_t i = 0; i < size; ++i) {
+            hash = (hash ^ p[i]) * 1099511628211ull;
+        }
+    }
+
+public:
+    template <typename T>
+    HudKey& add(T value) {
+        static_assert(std::is_arithmetic_v<T> || std::is_enum_v<T>,
+            "HudKey hashes scalars; add struct fields one by one");
+        bytes(&value, sizeof(T));
+        return *this;
+    }
+
+    HudKey& add(const std::string& text) {
+        bytes(text.data(), text.size());
+        return add(text.size());
+    }
+
+    HudKey& add(const char* text) {
+        size_t length = std::strlen(text);
+        bytes(text, length);
+        return add(length);
+    }
+
+    Uint64 value() const { return hash; }
+};
+
+class HudLayer {
+private:
+    struct Widget {
+        SDL_FRect area{ 0, 0, 0, 0 };
+        Uint64 key = 0;
+        bool painted = false; // Cache holds this widget's pixels
+        bool shown = false;   // Submitted this frame
+    };
+
+    std::vector<Widget> widgets;
+    SDL_Texture* target;
+    SDL_Renderer* owner; // Renderer the target was created on
+    int width, height;
+    bool retained;       // False: no target support, paint immediately
+
+    // Screen state saved while the target is bound
+    bool painting;
+    SDL_Texture* screenTarget;
+    RenderTrace* screenTrace;
+
+    int repaints;     // Widgets repainted in the frame in progress
+    int lastRepaints; // ... and in the previous frame
+
+    void destroyTarget() {
+        if (target) SDL_DestroyTexture(target);
+        target = nullptr;
+        for (Widget& w : widgets) w.painted = false;
+    }
+
+    void createTarget(Draw& draw) {
+        target = SDL_CreateTexture(draw.renderer, SDL_PIXELFORMAT_ARGB8888,
+            SDL_TEXTUREACCESS_TARGET, width, height);
+        retained = target != nullptr;
+        if (!retained) return;
+
+        // BLEND strokes onto a transparent target leave premultiplied colour
+        SDL_SetTextureBlendMode(target, SDL_BLENDMODE_BLEND_PREMULTIPLIED);
+        beginPaint(draw);
+        draw.color(0, 0, 0, 0);
+        draw.clear();
+    }
+
+    // Repaints stay out of an active Draw capture, like decal baking
+    void beginPaint(Draw& draw) {
+        if (painting) return;
+        painting = true;
+        screenTarget = SDL_GetRenderTarget(draw.renderer);
+        screenTrace = draw.trace;
+        draw.push_transform();
+
+        draw.trace = nullptr;
+        draw.reset_view();
+        SDL_SetRenderTarget(draw.renderer, target);
+    }
+
+    void endPaint(Draw& draw) {
+        if (!painting) return;
+        painting = false;
+        SDL_SetRenderTarget(draw.renderer, screenTarget);
+        draw.pop_transform();
+        draw.trace = screenTrace;
+    }
+
+    void erase(Draw& draw, const SDL_FRect& area) {
+        SDL_BlendMode previous = draw.current_blend;
+        draw.blend(SDL_BLENDMODE_NONE);
+        draw.color(0, 0, 0, 0);
+        draw.fill_rect(area.x, area.y, area.w, area.h);
+        draw.blend(previous);
+    }
+
+    static bool sameArea(const SDL_FRect& a, const SDL_FRect& b) {
+        return a.x == b.x && a.y == b.y && a.w == b.w && a.h == b.h;
+    }
+
+public:
+    HudLayer() : target(nullptr), owner(nullptr), width(0), height(0), retained(false),
+        painting(false), screenTarget(nullptr), screenTrace(nullptr),
+        repaints(0), lastRepaints(0) {
+    }
+
+    ~HudLayer() { destroyTarget(); }
+
+    HudLayer(const HudLayer&) = delete;
+    HudLayer& operator=(const HudLayer&) = delete;
+
+    // Starts a HUD frame covering a screen of w x h (screen space, no view)
+    void begin(Draw& draw, int w, int h) {
+        for (Widget& widget : widgets) widget.shown = false;
+        if (!draw.renderer) {
+            retained = false;
+            return;
+        }
+
+        if (owner != draw.renderer || width != w || height != h) {
+            destroyTarget();
+            owner = draw.renderer;
+            width = w;
+            height = h;
+            createTarget(draw);
+            endPaint(draw);
+        }
+    }
+
+    // Submits widget `id` for this frame. paint(draw) runs only when the key
+    // or area changed since the cached copy, clipped to `area`, with Draw
+    // bound to the HUD texture in screen coordinates.
+    template <typename Fn>
+    void widget(Draw& draw, int id, const SDL_FRect& area, const HudKey& key, Fn&& paint) {
+        if (id >= static_cast<int>(widgets.size())) widgets.resize(id + 1);
+        Widget& w = widgets[id];
+        w.shown = true;
+
+        if (!retained) {
+            paint(draw);
+            return;
+        }
+        if (w.painted && w.key == key.value() && sameArea(w.area, area)) return;
+
+        beginPaint(draw);
+        if (w.painted && !sameArea(w.area, area)) erase(draw, w.area);
+        erase(draw, area);
+
+        SDL_Rect clip = { static_cast<int>(area.x), static_cast<int>(area.y),
+                          static_cast<int>(std::ceil(area.w)), static_cast<int>(std::ceil(area.h)) };
+        SDL_SetRenderClipRect(draw.renderer, &clip);
+        paint(draw);
+        SDL_SetRenderClipRect(draw.renderer, nullptr);
+
+        w.area = area;
+        w.key = key.value();
+        w.painted = true;
+        repaints++;
+    }
+
+    // Erases widgets that were not submitted and composites the cache
+    void end(Draw& draw) {
+        if (!retained) {
+            lastRepaints = repaints;
+            repaints = 0;
+            return;
+        }
+
+        float x0 = static_cast<float>(width), y0 = static_cast<float>(height), x1 = 0, y1 = 0;
+        for (Widget& w : widgets) {
+            if (w.painted && !w.shown) {
+                beginPaint(draw);
+                erase(draw, w.area);
+                w.painted = false;
+            }
+            if (!w.painted) continue;
+            x0 = std::min(x0, w.area.x);
+            y0 = std::min(y0, w.area.y);
+            x1 = std::max(x1, w.area.x + w.area.w);
+            y1 = std::max(y1, w.area.y + w.area.h);
+        }
+        endPaint(draw);
+
+        lastRepaints = repaints;
+        repaints = 0;
+        x0 = std::max(x0, 0.0f);
+        y0 = std::max(y0, 0.0f);
+        x1 = std::min(x1, static_cast<float>(width));
+        y1 = std::min(y1, static_cast<float>(height));
+        if (x1 <= x0 || y1 <= y0) return;
+
+        // One quad over the union of the cached widgets
+        SDL_FRect rect = { x0, y0, x1 - x0, y1 - y0 };
+        SDL_RenderTexture(draw.renderer, target, &rect, &rect);
+        draw.stats.sdl_calls++;
+        draw.stats.pixels += rect.w * rect.h;
+    }
+
+    bool isRetained() const { return retained; }
+    int getLastRepaints() const { return lastRepaints; }
+};
@@ -0,0 +1,237 @@
+// katana_sim.cpp - Headless batch runner for Stickman Fighter wave simulations
+// Runs many independent GameWorlds in parallel with a scripted bot at a fixed
+// timestep (no window, no renderer) and reports win rates and throughput.
+// The checksum covers every world's final state; it must not change with
+// --enemy-threads, which only parallelises the enemy step inside each world.
+//
+// Usage: katana_sim [--worlds N] [--threads N] [--enemy-threads N] [--waves N] [--max-steps N] [--seed N]
+#include <SDL3/SDL.h>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include "katana_world.cpp"
+
+// ===== BOT =====
+// Minimal AI player: closes in on the nearest enemy, slashes in range, blocks
+// when an enemy is winding up, and uses abilities off cooldown.
+class KatanaBot {
+private:
+    const GameWorld* world;
+    int step;
+
+public:
+    explicit KatanaBot(const GameWorld* w = nullptr) : world(w), step(0) {}
+
+    void setWorld(const GameWorld* w) { world = w; }
+
+    void think(InputSnapshot& in) {
+        step++;
+        if (!world) return;
+
+        const Player& player = world->getPlayer();
+        const Enemy* nearest = nullptr;
+        float nearestDist = 1e9f;
+        for (const Enemy& enemy : world->getEnemies()) {
+            float dist = (enemy.position - player.position).length();
+            if (dist < nearestDist) {
+                nearestDist = dist;
+                nearest = &enemy;
+            }
+        }
+        if (!nearest) return;
+
+        // Aim the "mouse" at the target so dash and teleport head there.
+        // The mouse is in screen space, so go through the camera.
+        Vec2 aim = world->getCamera().worldToScreen(nearest->position);
+        in.mouseX = aim.x;
+        in.mouseY = aim.y;
+
+        bool targetRight = nearest->position.x > player.position.x;
+        if (nearestDist > 60) {
+            in.keys[targetRight ? SDL_SCANCODE_D : SDL_SCANCODE_A] = true;
+        }
+
+        // Click on alternate steps so every press registers as a new attack
+        if (nearestDist < SWORD_REACH * 1.5f) {
+            in.mouseLeft = (step % 2) == 0;
+        }
+
+        if (nearest->attackHitbox.active && nearestDist < 120) {
+            in.mouseRight = true;
+        }
+
+        if (nearestDist > 250) in.keys[SDL_SCANCODE_LSHIFT] = true;
+        if (world->getEnemies().size() >= 3) in.keys[SDL_SCANCODE_E] = true;
+        if (player.stats.getHealthPercent() < 0.5f) in.keys[SDL_SCANCODE_Q] = true;
+    }
+};
+
+// ===== BATCH RUNNER =====
+struct SimConfig {
+    int worlds = 64;
+    int threads = 0;          // 0 = one per hardware thread
+    int enemyThreads = 1;     // GameWorld::setUpdateThreads for every world
+    int targetWave = 5;       // clearing this wave counts as a win
+    long long maxSteps = 60LL * 60 * 10; // 10 simulated minutes at 60 Hz
+    uint32_t seed = 1;
+    float dt = 1.0f / 60.0f;
+};
+
+struct SimResult {
+    enum Outcome { WIN, LOSS, TIMEOUT } outcome = TIMEOUT;
+    int wave = 0;
+    int kills = 0;
+    long long steps = 0;
+    uint64_t checksum = 0;
+};
+
+// FNV-1a over the bits of the final positions, health and counters
+static uint64_t hashWorld(const GameWorld& world, long long steps) {
+    uint64_t h = 1469598103934665603ull;
+    auto mix = [&h](const void* data, size_t size) {
+        const unsigned char* bytes = static_cast<const unsigned char*>(data);
+        for (size_t i = 0; i < size; ++i) {
+            h = (h ^ bytes[i]) * 1099511628211ull;
+        }
+    };
+    auto mixEntity = [&mix](const Entity& e) {
+        mix(&e.position, sizeof(e.position));
+        mix(&e.velocity, sizeof(e.velocity));
+        mix(&e.stats.health, sizeof(e.stats.health));
+    };
+
+    mixEntity(world.getPlayer());
+    for (const Enemy& enemy : world.getEnemies()) {
+        mixEntity(enemy);
+    }
+    int counters[] = { world.getWave(), world.getEnemiesKilled(),
+                       static_cast<int>(world.getProjectiles().size()) };
+    mix(counters, sizeof(counters));
+    mix(&steps, sizeof(steps));
+    return h;
+}
+
+static SimResult runWorld(const SimConfig& config, int index) {
+    // Each world owns the calling thread's RNG for its whole run
+    Utils::seedRandom(config.seed + static_cast<uint32_t>(index) * 7919u);
+
+    ScriptedInputSource source;
+    GameWorld world(&source);
+    world.setUpdateThreads(config.enemyThreads);
+    KatanaBot bot(&world);
+    source.setScript([&bot](InputSnapshot& in) { bot.think(in); });
+
+    SimResult result;
+    while (result.steps < config.maxSteps) {
+        world.update(config.dt);
+        result.steps++;
+
+        if (world.isGameOver()) {
+            result.outcome = SimResult::LOSS;
+            break;
+        }
+        if (world.getWave() > config.targetWave) {
+            result.outcome = SimResult::WIN;
+            break;
+        }
+    }
+
+    result.wave = world.getWave();
+    result.kills = world.getEnemiesKilled();
+    result.checksum = hashWorld(world, result.steps);
+    return result;
+}
+
+static bool parseArgs(int argc, char* argv[], SimConfig& config) {
+    for (int i = 1; i < argc; ++i) {
+        const char* arg = argv[i];
+        const char* value = (i + 1 < argc) ? argv[i + 1] : nullptr;
+        if (!value) {
+            std::fprintf(stderr, "Missing value for %s\n", arg);
+            return false;
+        }
+
+        if (std::strcmp(arg, "--worlds") == 0) config.worlds = std::atoi(value);
+        else if (std::strcmp(arg, "--threads") == 0) config.threads = std::atoi(value);
+        else if (std::strcmp(arg, "--enemy-threads") == 0) config.enemyThreads = std::atoi(value);
+        else if (std::strcmp(arg, "--waves") == 0) config.targetWave = std::atoi(value);
+        else if (std::strcmp(arg, "--max-steps") == 0) config.maxSteps = std::atoll(value);
+        else if (std::strcmp(arg, "--seed") == 0) config.seed = static_cast<uint32_t>(std::strtoul(value, nullptr, 10));
+        else {
+            std::fprintf(stderr, "Unknown option %s\n", arg);
+            return false;
+        }
+        ++i;
+    }
+
+    if (config.threads <= 0) {
+        config.threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    config.worlds = std::max(1, config.worlds);
+    config.threads = std::min(config.threads, config.worlds);
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    SimConfig config;
+    if (!parseArgs(argc, argv, config)) {
+        std::fprintf(stderr,
+            "Usage: katana_sim [--worlds N] [--threads N] [--enemy-threads N] [--waves N] [--max-steps N] [--seed N]\n");
+        return 1;
+    }
+
+    std::vector<SimResult> results(config.worlds);
+    std::atomic<int> nextWorld{ 0 };
+
+    auto start = std::chrono::steady_clock::now();
+
+    // Workers pull world indices; results land by index so output is
+    // independent of scheduling
+    std::vector<std::thread> workers;
+    for (int t = 0; t < config.threads; ++t) {
+        workers.emplace_back([&]() {
+            int index;
+            while ((index = nextWorld.fetch_add(1)) < config.worlds) {
+                results[index] = runWorld(config, index);
+            }
+            });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+
+    double seconds = std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - start).count();
+
+    int wins = 0, losses = 0, timeouts = 0;
+    long long totalSteps = 0;
+    double waveSum = 0, killSum = 0;
+    uint64_t checksum = 0;
+    for (const auto& r : results) {
+        checksum = checksum * 31 + r.checksum;
+        if (r.outcome == SimResult::WIN) wins++;
+        else if (r.outcome == SimResult::LOSS) losses++;
+        else timeouts++;
+        totalSteps += r.steps;
+        waveSum += r.wave;
+        killSum += r.kills;
+    }
+
+    double simSeconds = totalSteps * config.dt;
+    std::printf("worlds:          %d (threads: %d, enemy threads: %d, seed: %u)\n",
+        config.worlds, config.threads, config.enemyThreads, config.seed);
+    std::printf("win rate:        %.1f%% (%d won, %d lost, %d timed out; win = clear wave %d)\n",
+        100.0 * wins / config.worlds, wins, losses, timeouts, config.targetWave);
+    std::printf("avg wave:        %.2f\n", waveSum / config.worlds);
+    std::printf("avg kills:       %.2f\n", killSum / config.worlds);
+    std::printf("steps:           %lld in %.3f s\n", totalSteps, seconds);
+    std::printf("steps/sec:       %.0f\n", seconds > 0 ? totalSteps / seconds : 0.0);
+    std::printf("speed vs 60 Hz:  %.0fx real time\n", seconds > 0 ? simSeconds / seconds : 0.0);
+    std::printf("checksum:        %016llx\n", static_cast<unsigned long long>(checksum));
+    return 0;
+}
@@ -0,0 +1,3182 @@
+// katana_world.cpp - Simulation core for Stickman Fighter (entities, combat, GameWorld)
+// Everything here runs without a window: rendering goes through Draw only when a
+// frontend asks for it, and input comes from a pluggable InputSource.
+#pragma once
+#include <SDL3/SDL.h>
+#include <vector>
+#include <memory>
+#include <cmath>
+#include <algorithm>
+#include <string>
+#include <deque>
+#include <unordered_map>
+#include <random>
+#include <array>
+#include <functional>
+#include "renderer2d.cpp"  // Your Draw struct
+#include "utils.cpp"       // Your Utils struct
+#include "game_clock.cpp"  // Time domains and fixed-step scheduler
+#include "camera.cpp"      // World-space camera and viewport queries
+#include "spatial_grid.cpp" // Platform index for culling and collision
+#include "slot_map.cpp"    // Generational handles for entities and effects
+#include "projectile_system.cpp" // Pooled arrows, swept hits and deflect
+#include "sword_sweep.cpp"  // Swept blade volume for frame-rate independent hits
+#include "thread_pool.cpp"  // Workers for the parallel enemy step
+#include "draw_arena.cpp"   // Enemy vertices recorded on the same workers
+#include "navigation.cpp"   // Platform nav graph and the shared flow field
+#include "decal_layer.cpp"  // Blood marks baked into persistent tiles
+#include "hud_layer.cpp"    // Screen HUD cached in a render target
+#include "quality_settings.cpp" // Calibrated quality tier knobs
+
+// Constants
+constexpr int SCREEN_WIDTH = 1280;
+constexpr int SCREEN_HEIGHT = 720;
+constexpr float GRAVITY = 0.5f;
+constexpr float GROUND_Y = 600.0f;
+constexpr float WORLD_WIDTH = SCREEN_WIDTH * 8.0f;
+constexpr float ACTIVE_MARGIN = SCREEN_WIDTH * 0.5f; // Enemies beyond view + this go dormant
+constexpr float TIME_SCALE_SLOW = 0.2f;
+constexpr float PLAYER_TIME_SCALE_SLOW = 0.4f; // Player outpaces the world in time slow
+constexpr float DASH_SPEED = 25.0f;
+constexpr float SWORD_REACH = 80.0f;
+constexpr float ARROW_SPEED = 14.0f;          // Pixels per 60 Hz frame
+constexpr float ARROW_GRAVITY = GRAVITY * 0.25f;
+constexpr float DEFLECT_REACH = SWORD_REACH + 30.0f;
+constexpr float DEFLECT_HALF_ARC = 75.0f * DEG_TO_RAD;
+
+// Forward declarations
+class Entity;
+class Player;
+class Enemy;
+class SlashEffect;
+class BloodParticle;
+class SparkParticle;
+class GameWorld;
+
+// ===== ENUMS =====
+enum class AttackType {
+    HORIZONTAL_SLASH,
+    VERTICAL_SLASH,
+    DIAGONAL_SLASH,
+    THRUST,
+    SPIN_ATTACK,
+    UPPERCUT,
+    DOWNWARD_STRIKE,
+    DASH_ATTACK
+};
+
+enum class AbilityType {
+    TIME_SLOW,
+    TELEPORT,
+    DEFLECT,
+    SHOCKWAVE,
+    LIGHTNING_STRIKE,
+    SHADOW_CLONE,
+    BERSERK_MODE,
+    HEAL
+};
+
+enum class EnemyType {
+    BASIC_GRUNT,
+    HEAVY_BRUTE,
+    NINJA_ASSASSIN,
+    RANGED_ARCHER,
+    SHIELD_KNIGHT,
+    DUAL_WIELDER,
+    BOSS_SAMURAI
+};
+
+enum class GameState {
+    MENU,
+    PLAYING,
+    PAUSED,
+    GAME_OVER,
+    VICTORY
+};
+
+// ===== INPUT SOURCES =====
+// Raw device state sampled once per simulation step
+struct InputSnapshot {
+    std::array<bool, SDL_SCANCODE_COUNT> keys{};
+    float mouseX = 0, mouseY = 0;
+    bool mouseLeft = false, mouseRight = false;
+};
+
+class InputSource {
+public:
+    virtual ~InputSource() = default;
+    virtual void poll(InputSnapshot& state) = 0;
+};
+
+// Live keyboard and mouse (requires the SDL video subsystem)
+class SDLInputSource : public InputSource {
+public:
+    void poll(InputSnapshot& state) override {
+        int numKeys = 0;
+        const bool* keys = SDL_GetKeyboardState(&numKeys);
+        int count = std::min(numKeys, static_cast<int>(state.keys.size()));
+        std::copy(keys, keys + count, state.keys.begin());
+
+        Uint32 mouseState = SDL_GetMouseState(&state.mouseX, &state.mouseY);
+        state.mouseLeft = (mouseState & SDL_BUTTON_LMASK) != 0;
+        state.mouseRight = (mouseState & SDL_BUTTON_RMASK) != 0;
+    }
+};
+
+// Input produced by a script or AI each step - never touches SDL
+class ScriptedInputSource : public InputSource {
+public:
+    using Script = std::function<void(InputSnapshot&)>;
+
+private:
+    Script script;
+
+public:
+    explicit ScriptedInputSource(Script s = nullptr) : script(std::move(s)) {}
+
+    void setScript(Script s) { script = std::move(s); }
+
+    void poll(InputSnapshot& state) override {
+        // Buttons are released unless the script holds them; mouse position persists
+        state.keys.fill(false);
+        state.mouseLeft = false;
+        state.mouseRight = false;
+        if (script) script(state);
+    }
+};
+
+// ===== INPUT MANAGER =====
+class InputManager {
+public:
+    struct MouseGesture {
+        std::vector<Vec2> points;
+        float totalDistance;
+        float startTime;
+        Vec2 direction;
+        float speed;
+    };
+
+private:
+    InputSource* source;
+    SDLInputSource sdlSource;
+    InputSnapshot state;
+    bool prevMouseLeft, prevMouseRight;
+    float prevMouseX, prevMouseY;
+    float currentTime;
+    MouseGesture currentGesture;
+    bool recordingGesture;
+    std::deque<Vec2> recentMousePositions;
+    static constexpr size_t MOUSE_HISTORY_SIZE = 10;
+    Vec2 viewOrigin;
+    float viewZoom;
+
+public:
+    // A null source reads the real keyboard and mouse through SDL
+    explicit InputManager(InputSource* inputSource = nullptr)
+        : source(inputSource), prevMouseLeft(false), prevMouseRight(false),
+        prevMouseX(0), prevMouseY(0), currentTime(0), recordingGesture(false),
+        viewOrigin(0, 0), viewZoom(1.0f) {
+    }
+
+    void setSource(InputSource* inputSource) { source = inputSource; }
+
+    // Camera transform used to map the mouse into world space
+    void setView(const Vec2& origin, float zoom) {
+        viewOrigin = origin;
+        viewZoom = zoom;
+    }
+
+    // time: simulation clock in seconds, used for gesture speed
+    void update(float time) {
+        prevMouseLeft = state.mouseLeft;
+        prevMouseRight = state.mouseRight;
+        prevMouseX = state.mouseX;
+        prevMouseY = state.mouseY;
+        currentTime = time;
+
+        if (source) {
+            source->poll(state);
+        }
+        else {
+            sdlSource.poll(state);
+        }
+
+        // Update mouse history
+        recentMousePositions.push_back({ state.mouseX, state.mouseY });
+        if (recentMousePositions.size() > MOUSE_HISTORY_SIZE) {
+            recentMousePositions.pop_front();
+        }
+
+        // Handle gesture recording
+        if (state.mouseLeft && !prevMouseLeft) {
+            startGesture();
+        }
+        else if (recordingGesture && state.mouseLeft) {
+            updateGesture();
+        }
+        else if (recordingGesture && !state.mouseLeft) {
+            endGesture();
+        }
+    }
+
+    void startGesture() {
+        currentGesture.points.clear();
+        currentGesture.points.push_back({ state.mouseX, state.mouseY });
+        currentGesture.totalDistance = 0;
+        currentGesture.startTime = currentTime;
+        recordingGesture = true;
+    }
+
+    void updateGesture() {
+        Vec2 currentPos(state.mouseX, state.mouseY);
+        if (!currentGesture.points.empty()) {
+            Vec2 lastPos = currentGesture.points.back();
+            float dist = (currentPos - lastPos).length();
+            if (dist > 2.0f) { // Minimum distance threshold
+                currentGesture.points.push_back(currentPos);
+                currentGesture.totalDistance += dist;
+            }
+        }
+    }
+
+    void endGesture() {
+        if (currentGesture.points.size() >= 2) {
+            Vec2 start = currentGesture.points.front();
+            Vec2 end = currentGesture.points.back();
+            currentGesture.direction = (end - start).normalized();
+
+            float duration = currentTime - currentGesture.startTime;
+            currentGesture.speed = duration > 0 ? currentGesture.totalDistance / duration : 0;
+        }
+        recordingGesture = false;
+    }
+
+    AttackType getAttackFromGesture() {
+        if (currentGesture.points.size() < 2) return AttackType::HORIZONTAL_SLASH;
+
+        Vec2 start = currentGesture.points.front();
+        Vec2 end = currentGesture.points.back();
+        Vec2 delta = end - start;
+
+        float angle = std::atan2(delta.y, delta.x);
+        float speed = currentGesture.speed;
+
+        // Fast circular motion = Spin attack
+        if (currentGesture.totalDistance > 200 && speed > 1000) {
+            return AttackType::SPIN_ATTACK;
+        }
+
+        // Categorize by angle
+        if (std::abs(angle) < PI / 6) {
+            return AttackType::HORIZONTAL_SLASH;
+        }
+        else if (std::abs(angle - PI) < PI / 6) {
+            return AttackType::HORIZONTAL_SLASH;
+        }
+        else if (std::abs(angle - PI / 2) < PI / 6) {
+            return AttackType::DOWNWARD_STRIKE;
+        }
+        else if (std::abs(angle + PI / 2) < PI / 6) {
+            return AttackType::UPPERCUT;
+        }
+        else if (currentGesture.totalDistance < 50) {
+            return AttackType::THRUST;
+        }
+        else {
+            return AttackType::DIAGONAL_SLASH;
+        }
+    }
+
+    Vec2 getMouseVelocity() const {
+        return Vec2(state.mouseX - prevMouseX, state.mouseY - prevMouseY);
+    }
+
+    Vec2 getAverageMouseDirection() const {
+        if (recentMousePositions.size() < 2) return Vec2(0, 0);
+
+        Vec2 avgDir(0, 0);
+        for (size_t i = 1; i < recentMousePositions.size(); ++i) {
+            avgDir += recentMousePositions[i] - recentMousePositions[i - 1];
+        }
+        return avgDir.normalized();
+    }
+
+    // Getters
+    bool isKeyPressed(SDL_Scancode key) const { return state.keys[key]; }
+    bool isMouseLeftPressed() const { return state.mouseLeft; }
+    bool isMouseRightPressed() const { return state.mouseRight; }
+    bool isMouseLeftJustPressed() const { return state.mouseLeft && !prevMouseLeft; }
+    bool isMouseRightJustPressed() const { return state.mouseRight && !prevMouseRight; }
+    float getMouseX() const { return state.mouseX; }
+    float getMouseY() const { return state.mouseY; }
+    Vec2 getMousePos() const { return Vec2(state.mouseX, state.mouseY); }
+    Vec2 getMouseWorldPos() const {
+        return Vec2(state.mouseX / viewZoom + viewOrigin.x, state.mouseY / viewZoom + viewOrigin.y);
+    }
+    const MouseGesture& getGesture() const { return currentGesture; }
+};
+
+// ===== PARTICLE EFFECTS =====
+enum class ParticleKind : uint8_t { PLAIN, BLOOD, SPARK, COUNT };
+
+class Particle {
+public:
+    Vec2 position;
+    Vec2 velocity;
+    Color color;
+    float life;
+    float maxLife;
+    float size;
+    float rotation;
+    float rotationSpeed;
+    bool gravity;
+
+    Particle(Vec2 pos, Vec2 vel, Color col, float lifeTime, float particleSize = 2.0f) {
+        init(pos, vel, col, lifeTime, particleSize);
+    }
+    virtual ~Particle() = default;
+
+    // Also re-initialises a recycled particle (see ParticlePool)
+    void init(Vec2 pos, Vec2 vel, Color col, float lifeTime, float particleSize = 2.0f) {
+        position = pos;
+        velocity = vel;
+        color = col;
+        life = lifeTime;
+        maxLife = lifeTime;
+        size = particleSize;
+        rotation = 0;
+        rotationSpeed = Utils::randomFloat(-10, 10);
+        gravity = true;
+    }
+
+    static constexpr ParticleKind KIND = ParticleKind::PLAIN;
+    virtual ParticleKind kind() const { return KIND; }
+
+    // dt is already in the owning time domain (see GameClock)
+    virtual void update(float dt) {
+        position += velocity * dt;
+        if (gravity) {
+            velocity.y += GRAVITY * dt;
+        }
+        velocity *= std::pow(0.98f, dt * 60); // Drag
+        life -= dt;
+        rotation += rotationSpeed * dt;
+    }
+
+    virtual void draw(Draw& draw) {
+        if (life <= 0) return;
+
+        float alpha = life / maxLife;
+        Color drawColor = color;
+        drawColor.a *= alpha;
+
+        SDL_Color c = drawColor.toSDL();
+        draw.color(c.r, c.g, c.b, c.a);
+        draw.fill_circle(position.x, position.y, size * alpha);
+    }
+
+    bool isAlive() const { return life > 0; }
+
+    // Resting particles are handed to the decal layer and recycled
+    virtual bool isResting() const { return false; }
+    virtual void stampDecal(DecalLayer&) const {}
+
+protected:
+    Particle() = default;
+};
+
+class BloodParticle : public Particle {
+public:
+    std::deque<Vec2> trail;
+    static constexpr size_t MAX_TRAIL_LENGTH = 10;
+    bool resting;
+
+    BloodParticle(Vec2 pos, Vec2 vel) {
+        init(pos, vel);
+    }
+
+    // The trail keeps its storage when recycled
+    void init(Vec2 pos, Vec2 vel) {
+        Particle::init(pos, vel, Color(200, 0, 0), Utils::randomFloat(0.5f, 1.5f),
+            Utils::randomFloat(2, 5));
+        trail.clear();
+        resting = false;
+    }
+
+    static constexpr ParticleKind KIND = ParticleKind::BLOOD;
+    ParticleKind kind() const override { return KIND; }
+
+    // Drops fall in the same per-60 Hz-frame units as entities so they
+    // reach the floor within their lifetime
+    void update(float dt) override {
+        float step = dt * 60;
+        position += velocity * step;
+        if (gravity) {
+            velocity.y += GRAVITY * step;
+        }
+        velocity *= std::pow(0.98f, step);
+        life -= dt;
+        rotation += rotationSpeed * dt;
+
+        trail.push_back(position);
+        if (trail.size() > MAX_TRAIL_LENGTH) {
+            trail.pop_front();
+        }
+
+        // Blood splatter on ground
+        if (position.y >= GROUND_Y && velocity.y > 0) {
+            position.y = GROUND_Y;
+            velocity.y *= -0.3f;
+            velocity.x *= 0.7f;
+            if (std::abs(velocity.y) < 1.0f) {
+                velocity.y = 0;
+                gravity = false;
+                resting = true;
+            }
+        }
+    }
+
+    bool isResting() const override { return resting; }
+
+    void stampDecal(DecalLayer& decals) const override {
+        decals.stamp(position, size, Color(140, 10, 10, 200));
+    }
+
+    void draw(Draw& draw) override {
+        if (life <= 0) return;
+
+        // Draw trail
+        for (size_t i = 1; i < trail.size(); ++i) {
+            float alpha = (life / maxLife) * (i / (float)trail.size());
+            Color trailColor = color;
+            trailColor.a *= alpha;
+
+            SDL_Color c = trailColor.toSDL();
+            draw.color(c.r, c.g, c.b, c.a);
+            draw.line(trail[i - 1].x, trail[i - 1].y, trail[i].x, trail[i].y);
+        }
+
+        // Draw main particle
+        Particle::draw(draw);
+    }
+};
+
+class SparkParticle : public Particle {
+public:
+    SparkParticle(Vec2 pos, Vec2 vel) {
+        init(pos, vel);
+    }
+
+    void init(Vec2 pos, Vec2 vel) {
+        Particle::init(pos, vel, Color(255, 255, 200), Utils::randomFloat(0.2f, 0.5f),
+            Utils::randomFloat(1, 3));
+        gravity = false;
+    }
+
+    static constexpr ParticleKind KIND = ParticleKind::SPARK;
+    ParticleKind kind() const override { return KIND; }
+
+    void draw(Draw& draw) override {
+        if (life <= 0) return;
+
+        float alpha = life / maxLife;
+
+        // Glowing effect
+        int layers = Quality::get().sparkGlowLayers;
+        for (int i = layers; i > 0; i--) {
+            Color glowColor = color;
+            glowColor.a *= alpha * (i / static_cast<float>(layers)) * 0.3f;
+
+            SDL_Color c = glowColor.toSDL();
+            draw.color(c.r, c.g, c.b, c.a);
+            draw.fill_circle(position.x, position.y, size * i);
+        }
+
+        // Core
+        Color coreColor(255, 255, 255);
+        coreColor.a = alpha;
+        SDL_Color c = coreColor.toSDL();
+        draw.color(c.r, c.g, c.b, c.a);
+        draw.fill_circle(position.x, position.y, size);
+    }
+};
+
+// Live effect particles of one owner (an entity or the world). Dead ones are
+// kept per kind and re-initialised by the next spawn of that kind, so hits
+// and waves reuse the same objects. Spawning only happens in serial code;
+// removal may run on a worker, as it only touches this pool.
+class ParticlePool {
+private:
+    static constexpr size_t KINDS = static_cast<size_t>(ParticleKind::COUNT);
+
+    std::vector<std::unique_ptr<Particle>> items;
+    std::vector<std::unique_ptr<Particle>> spares[KINDS];
+
+    void retire(std::unique_ptr<Particle> p) {
+        spares[static_cast<size_t>(p->kind())].push_back(std::move(p));
+    }
+
+public:
+    template <typename T, typename... Args>
+    T* spawn(Args&&... args) {
+        auto& spare = spares[static_cast<size_t>(T::KIND)];
+        if (spare.empty()) {
+            items.push_back(std::make_unique<T>(std::forward<Args>(args)...));
+        }
+        else {
+            items.push_back(std::move(spare.back()));
+            spare.pop_back();
+            static_cast<T*>(items.back().get())->init(std::forward<Args>(args)...);
+        }
+        return static_cast<T*>(items.back().get());
+    }
+
+    // Order-preserving; removed particles become spares
+    template <typename Pred>
+    size_t removeIf(Pred pred) {
+        size_t kept = 0;
+        for (size_t i = 0; i < items.size(); ++i) {
+            if (pred(*items[i])) retire(std::move(items[i]));
+            else items[kept++] = std::move(items[i]);
+        }
+        size_t removed = items.size() - kept;
+        items.resize(kept);
+        return removed;
+    }
+
+    void clear() {
+        for (auto& p : items) retire(std::move(p));
+        items.clear();
+    }
+
+    // Moves every particle of `other`, live or spare, into this pool's
+    // spares (the owner is going away)
+    void reclaim(ParticlePool& other) {
+        other.clear();
+        for (size_t k = 0; k < KINDS; ++k) {
+            for (auto& p : other.spares[k]) spares[k].push_back(std::move(p));
+            other.spares[k].clear();
+        }
+    }
+
+    // Hands up to `count` spares of each kind to `other` (a new owner)
+    void lend(ParticlePool& other, size_t count) {
+        for (size_t k = 0; k < KINDS; ++k) {
+            for (size_t i = 0; i < count && !spares[k].empty(); ++i) {
+                other.spares[k].push_back(std::move(spares[k].back()));
+                spares[k].pop_back();
+            }
+        }
+    }
+
+    size_t size() const { return items.size(); }
+    bool empty() const { return items.empty(); }
+
+    auto begin() { return items.begin(); }
+    auto end() { return items.end(); }
+    auto begin() const { return items.begin(); }
+    auto end() const { return items.end(); }
+};
+
+// ===== SLASH EFFECT =====
+class SlashEffect {
+public:
+    struct SlashPoint {
+        Vec2 position;
+        float width;
+        float alpha;
+    };
+
+    std::vector<SlashPoint> points;
+    Color color;
+    float lifetime;
+    float maxLifetime;
+    bool active;
+
+    SlashEffect() : color(255, 255, 255), lifetime(0), maxLifetime(0.3f), active(false) {}
+
+    void start(Vec2 startPos, Color slashColor = Color(255, 255, 255)) {
+        points.clear();
+        points.push_back({ startPos, 15.0f, 1.0f });
+        color = slashColor;
+        lifetime = maxLifetime;
+        active = true;
+    }
+
+    void addPoint(Vec2 pos) {
+        if (!active) return;
+
+        if (!points.empty()) {
+            Vec2 lastPos = points.back().position;
+            if ((pos - lastPos).length() > 5.0f) {
+                float width = 15.0f * (lifetime / maxLifetime);
+                points.push_back({ pos, width, lifetime / maxLifetime });
+            }
+        }
+    }
+
+    void update(float dt) {
+        if (!active) return;
+
+        lifetime -= dt;
+        if (lifetime <= 0) {
+            active = false;
+            points.clear();
+        }
+
+        // Fade out points
+        for (auto& point : points) {
+            point.alpha *= 0.95f;
+        }
+    }
+
+    void draw(Draw& draw) {
+        if (!active || points.size() < 2) return;
+
+        // Draw slash trail
+        for (size_t i = 1; i < points.size(); ++i) {
+            SlashPoint& p1 = points[i - 1];
+            SlashPoint& p2 = points[i];
+
+            float alpha = (p1.alpha + p2.alpha) / 2.0f * (lifetime / maxLifetime);
+
+            // Glow effect
+            for (int g = 3; g > 0; g--) {
+                Color glowColor = color;
+                glowColor.a *= alpha * (g / 3.0f) * 0.3f;
+
+                SDL_Color c = glowColor.toSDL();
+                draw.color(c.r, c.g, c.b, c.a);
+
+                float width = (p1.width + p2.width) / 2.0f * g;
+                // Draw thick line between points
+                for (float t = 0; t <= 1.0f; t += 0.1f) {
+                    Vec2 pos = Vec2::lerp(p1.position, p2.position, t);
+                    draw.fill_circle(pos.x, pos.y, width / 2);
+                }
+            }
+
+            // Core line
+            Color coreColor(255, 255, 255);
+            coreColor.a = alpha;
+            SDL_Color c = coreColor.toSDL();
+            draw.color(c.r, c.g, c.b, c.a);
+            draw.line(p1.position.x, p1.position.y, p2.position.x, p2.position.y);
+        }
+    }
+};
+
+// ===== HITBOX SYSTEM =====
+class Hitbox {
+public:
+    Vec2 position;
+    Vec2 size;
+    Vec2 offset;
+    bool active;
+    float damage;
+    float knockback;
+    int hitStun;
+
+    Hitbox() : position(0, 0), size(0, 0), offset(0, 0),
+        active(false), damage(0), knockback(0), hitStun(0) {
+    }
+
+    Hitbox(Vec2 pos, Vec2 sz, float dmg = 10.0f, float kb = 5.0f, int stun = 10)
+        : position(pos), size(sz), offset(0, 0), active(true),
+        damage(dmg), knockback(kb), hitStun(stun) {
+    }
+
+    SDL_FRect getRect() const {
+        return { position.x + offset.x - size.x / 2,
+                position.y + offset.y - size.y / 2,
+                size.x, size.y };
+    }
+
+    bool intersects(const Hitbox& other) const {
+        if (!active || !other.active) return false;
+        SDL_FRect r1 = getRect();
+        SDL_FRect r2 = other.getRect();
+        return SDL_HasRectIntersectionFloat(&r1, &r2);
+    }
+
+    void draw(Draw& draw, Color color = Color(255, 0, 0, 100)) {
+        if (!active) return;
+        SDL_FRect rect = getRect();
+        SDL_Color c = color.toSDL();
+        draw.color(c.r, c.g, c.b, c.a);
+        draw.rect(rect.x, rect.y, rect.w, rect.h);
+    }
+};
+
+// ===== COMBAT SYSTEM =====
+class CombatStats {
+public:
+    float maxHealth;
+    float health;
+    float attack;
+    float defense;
+    float speed;
+    float critChance;
+    float critDamage;
+
+    CombatStats(float hp = 100, float atk = 10, float def = 5, float spd = 5)
+        : maxHealth(hp), health(hp), attack(atk), defense(def), speed(spd),
+        critChance(0.1f), critDamage(2.0f) {
+    }
+
+    float calculateDamage(float baseDamage) {
+        float damage = baseDamage * (attack / 10.0f);
+        if (Utils::randomFloat(0, 1) < critChance) {
+            damage *= critDamage;
+        }
+        return damage;
+    }
+
+    void takeDamage(float damage) {
+        float reducedDamage = damage * (1.0f - (defense / (defense + 50.0f)));
+        health -= reducedDamage;
+        health = std::max(0.0f, health);
+    }
+
+    bool isAlive() const { return health > 0; }
+    float getHealthPercent() const { return health / maxHealth; }
+};
+
+// ===== ANIMATION SYSTEM =====
+class AnimationFrame {
+public:
+    std::string name;
+    int duration;
+    std::function<void(Entity*)> onEnter;
+    std::function<void(Entity*)> onUpdate;
+    std::function<void(Entity*)> onExit;
+
+    AnimationFrame(const std::string& n, int d)
+        : name(n), duration(d), onEnter(nullptr), onUpdate(nullptr), onExit(nullptr) {
+    }
+};
+
+// Owned by value by its entity; the owner is passed per call rather than
+// stored, so the controller stays valid when the entity is relocated.
+class AnimationController {
+private:
+    std::unordered_map<std::string, std::vector<AnimationFrame>> animations;
+    std::string currentAnimation;
+    size_t currentFrame;
+    float frameTimer; // In 60 Hz frames, matching AnimationFrame::duration
+    bool looping;
+
+public:
+    AnimationController()
+        : currentAnimation("idle"), currentFrame(0), frameTimer(0),
+        looping(true) {
+    }
+
+    void addAnimation(const std::string& name, const std::vector<AnimationFrame>& frames) {
+        animations[name] = frames;
+    }
+
+    // restart replays name from its first frame even if it is current
+    void play(Entity* owner, const std::string& name, bool loop = true, bool restart = false) {
+        if (currentAnimation != name || restart) {
+            if (hasAnimation(currentAnimation) && currentFrame < animations[currentAnimation].size()) {
+                auto& frame = animations[currentAnimation][currentFrame];
+                if (frame.onExit) frame.onExit(owner);
+            }
+
+            currentAnimation = name;
+            currentFrame = 0;
+            frameTimer = 0;
+            looping = loop;
+
+            if (hasAnimation(name) && !animations[name].empty()) {
+                auto& frame = animations[name][0];
+                if (frame.onEnter) frame.onEnter(owner);
+            }
+        }
+    }
+
+    void update(Entity* owner, float dt) {
+        if (!hasAnimation(currentAnimation)) return;
+
+        auto& anim = animations[currentAnimation];
+        if (anim.empty()) return;
+
+        frameTimer += dt * 60.0f;
+
+        auto& frame = anim[currentFrame];
+        if (frame.onUpdate) frame.onUpdate(owner);
+
+        if (frameTimer >= frame.duration) {
+            if (frame.onExit) frame.onExit(owner);
+
+            frameTimer -= frame.duration;
+            currentFrame++;
+
+            if (currentFrame >= anim.size()) {
+                if (looping) {
+                    currentFrame = 0;
+                }
+                else {
+                    currentFrame = anim.size() - 1;
+                    return;
+                }
+            }
+
+            auto& nextFrame = anim[currentFrame];
+            if (nextFrame.onEnter) nextFrame.onEnter(owner);
+        }
+    }
+
+    bool hasAnimation(const std::string& name) const {
+        return animations.find(name) != animations.end();
+    }
+
+    bool isPlaying(const std::string& name) const {
+        return currentAnimation == name;
+    }
+
+    bool isFinished() const {
+        if (!hasAnimation(currentAnimation) || looping) return false;
+        auto& anim = animations.at(currentAnimation);
+        return currentFrame >= anim.size() - 1;
+    }
+
+    std::string getCurrentAnimation() const { return currentAnimation; }
+    size_t getCurrentFrame() const { return currentFrame; }
+};
+
+// ===== ENTITY BASE CLASS =====
+class Entity {
+public:
+    Vec2 position;
+    Vec2 prevPosition; // Position before the last update (platform sweeps)
+    Vec2 velocity;
+    Vec2 size;
+    bool facingRight;
+    bool onGround;
+
+    CombatStats stats;
+    Hitbox hurtbox;
+    Hitbox attackHitbox;
+    AnimationController animator;
+
+    int hitStun;
+    int invulnerableFrames;
+    bool blocking;
+    float blockMeter;
+    float aliveTime; // Simulation seconds since spawn (drives idle animation)
+
+    ParticlePool particles;
+
+    Entity(Vec2 pos, Vec2 sz = Vec2(30, 60))
+        : position(pos), prevPosition(pos), velocity(0, 0), size(sz), facingRight(true),
+        onGround(false), hitStun(0), invulnerableFrames(0),
+        blocking(false), blockMeter(100.0f), aliveTime(0) {
+
+        hurtbox = Hitbox(position, size);
+        attackHitbox = Hitbox(position, Vec2(0, 0));
+        setupAnimations();
+    }
+
+    // Movable so entities can live packed in a SlotMap
+    Entity(Entity&&) = default;
+    Entity& operator=(Entity&&) = default;
+    virtual ~Entity() = default;
+
+    virtual void setupAnimations() {
+        // Override in derived classes
+    }
+
+    // dt is already scaled by the entity's time domain
+    virtual void update(float dt) {
+        aliveTime += dt;
+        prevPosition = position;
+
+        // Update physics
+        if (!onGround) {
+            velocity.y += GRAVITY * dt * 60;
+        }
+
+        // Apply friction
+        if (onGround) {
+            velocity.x *= std::pow(0.85f, dt * 60);
+        }
+        else {
+            velocity.x *= std::pow(0.98f, dt * 60);
+        }
+
+        // Update position
+        position += velocity * dt * 60;
+
+        // Ground collision
+        if (position.y + size.y / 2 > GROUND_Y) {
+            position.y = GROUND_Y - size.y / 2;
+            velocity.y = 0;
+            onGround = true;
+        }
+        else {
+            onGround = false;
+        }
+
+        // World boundaries
+        position.x = std::max(size.x / 2, std::min(position.x, WORLD_WIDTH - size.x / 2));
+
+        // Update hitboxes
+        hurtbox.position = position;
+        attackHitbox.position = position;
+        if (!facingRight) {
+            attackHitbox.offset.x = -std::abs(attackHitbox.offset.x);
+        }
+        else {
+            attackHitbox.offset.x = std::abs(attackHitbox.offset.x);
+        }
+
+        // Update timers
+        if (hitStun > 0) hitStun--;
+        if (invulnerableFrames > 0) invulnerableFrames--;
+
+        // Update block meter
+        if (!blocking && blockMeter < 100.0f) {
+            blockMeter += dt * 20;
+            blockMeter = std::min(100.0f, blockMeter);
+        }
+
+        // Update animation
+        animator.update(this, dt);
+
+        // Update particles
+        updateParticles(dt);
+    }
+
+    // Serial: moves rested particles into the shared decal layer
+    void settleParticles(DecalLayer& decals) {
+        particles.removeIf([&decals](const Particle& p) {
+            if (!p.isResting()) return false;
+            p.stampDecal(decals);
+            return true;
+            });
+    }
+
+    void updateParticles(float dt) {
+        particles.removeIf([](const Particle& p) { return !p.isAlive(); });
+
+        for (auto& particle : particles) {
+            particle->update(dt);
+        }
+    }
+
+    virtual void takeDamage(float damage, Vec2 knockbackDir, int stun) {
+        if (invulnerableFrames > 0) return;
+
+        if (blocking && blockMeter > 0) {
+            // Reduced damage and knockback when blocking
+            damage *= 0.3f;
+            knockbackDir *= 0.3f;
+            blockMeter -= damage * 2;
+
+            // Spark particles on block
+            for (int i = 0; i < 5; ++i) {
+                float angle = Utils::randomFloat(-PI / 4, PI / 4);
+                Vec2 vel = Vec2::fromAngle(angle, Utils::randomFloat(2, 5));
+                particles.spawn<SparkParticle>(position, vel);
+            }
+
+            if (blockMeter <= 0) {
+                blocking = false;
+                blockMeter = 0;
+                hitStun = stun * 2; // Guard break stun
+            }
+        }
+        else {
+            stats.takeDamage(damage);
+            velocity += knockbackDir;
+            hitStun = stun;
+            invulnerableFrames = 30;
+
+            // Blood particles
+            for (int i = 0; i < 10; ++i) {
+                float angle = Utils::randomFloat(0, TWO_PI);
+                Vec2 vel = Vec2::fromAngle(angle, Utils::randomFloat(2, 8));
+                particles.spawn<BloodParticle>(position, vel);
+            }
+        }
+    }
+
+    virtual void draw(Draw& draw) = 0;
+
+    // World-space area this entity may draw into (body, sword, health bar)
+    SDL_FRect getDrawBounds() const {
+        float pad = SWORD_REACH + 40;
+        return { position.x - size.x / 2 - pad, position.y - size.y / 2 - pad,
+                 size.x + pad * 2, size.y + pad * 2 };
+    }
+
+    void drawParticles(Draw& draw) {
+        for (auto& particle : particles) {
+            particle->draw(draw);
+        }
+    }
+
+    void drawHealthBar(Draw& draw) {
+        float barWidth = 50;
+        float barHeight = 6;
+        Vec2 barPos = position + Vec2(0, -size.y / 2 - 20);
+
+        // Background
+        draw.color(50, 50, 50);
+        draw.fill_rect(barPos.x - barWidth / 2, barPos.y - barHeight / 2, barWidth, barHeight);
+
+        // Health
+        float healthPercent = stats.getHealthPercent();
+        Color healthColor = Color::lerp(Color(255, 0, 0), Color(0, 255, 0), healthPercent);
+        SDL_Color c = healthColor.toSDL();
+        draw.color(c.r, c.g, c.b);
+        draw.fill_rect(barPos.x - barWidth / 2, barPos.y - barHeight / 2,
+            barWidth * healthPercent, barHeight);
+
+        // Border
+        draw.color(0, 0, 0);
+        draw.rect(barPos.x - barWidth / 2, barPos.y - barHeight / 2, barWidth, barHeight);
+
+        // Block meter (if blocking)
+        if (blocking && blockMeter > 0) {
+            float blockBarY = barPos.y + barHeight;
+            draw.color(100, 100, 255, 180);
+            draw.fill_rect(barPos.x - barWidth / 2, blockBarY,
+                barWidth * (blockMeter / 100.0f), 3);
+        }
+    }
+};
+
+// ===== PLAYER CLASS =====
+class Player : public Entity {
+private:
+    InputManager* input;
+    SlashEffect slashEffect;
+    SlotMap<SlashEffect> activeSlashes;
+
+    // Abilities
+    std::unordered_map<AbilityType, float> abilityCooldowns;
+    bool timeSlowActive;
+    float timeSlowDuration;
+    float deflectTimer; // Deflect window left (player time)
+    float dashCooldown;
+    bool isDashing;
+    Vec2 dashDirection;
+    float dashTime;
+
+    // Combat
+    int comboCount;
+    float comboTimer;
+    AttackType lastAttack;
+    bool canCancelAttack;
+    int attackCount; // Slashes started, polled by GameWorld for sound cues
+
+    // Animation state (angles in degrees for a right-facing pose)
+    float armAngle;
+    float legAngle;
+    float bodyLean;
+    float swordAngle;
+    bool showAfterImage;
+    std::deque<std::pair<Vec2, float>> afterImages;
+
+    // Scripted swing for attacks without an animation
+    float swingFrom, swingTo;
+    float swingTime, swingDuration;
+
+    // Blade collision: the volume swept since combat last tested it. Player
+    // steps can run more often than combat (time slow), so steps accumulate.
+    SwordSweep sweep;
+    bool areaAttack;  // attackHitbox is an area burst (shockwave), not the blade
+    bool sweepReset;  // Pose jumped (teleport); don't sweep across the gap
+    Vec2 sweepHand;   // Blade pose the next sweep motion starts from
+    float sweepBlade;
+    bool sweepFacingRight;
+
+public:
+    Player(Vec2 pos, InputManager* inputMgr)
+        : Entity(pos, Vec2(30, 60)), input(inputMgr), timeSlowActive(false),
+        timeSlowDuration(0), deflectTimer(0), dashCooldown(0), isDashing(false),
+        dashTime(0), comboCount(0), comboTimer(0),
+        lastAttack(AttackType::HORIZONTAL_SLASH), canCancelAttack(false), attackCount(0),
+        armAngle(0), legAngle(0), bodyLean(0), swordAngle(0),
+        showAfterImage(false), swingFrom(0), swingTo(0), swingTime(0), swingDuration(0),
+        areaAttack(false), sweepReset(false), sweepBlade(0), sweepFacingRight(true) {
+
+        stats = CombatStats(150, 15, 8, 7);
+        stats.critChance = 0.25f;
+
+        // Initialize ability cooldowns
+        for (int i = 0; i < 8; ++i) {
+            abilityCooldowns[static_cast<AbilityType>(i)] = 0;
+        }
+
+        // Entity's constructor only reaches the base version
+        setupAnimations();
+    }
+
+    void setupAnimations() override {
+        // Idle animation
+        std::vector<AnimationFrame> idle = {
+            AnimationFrame("idle", 60)
+        };
+        idle[0].onEnter = [](Entity* e) {
+            static_cast<Player*>(e)->armAngle = 0;
+            };
+        idle[0].onUpdate = [](Entity* e) {
+            Player* p = static_cast<Player*>(e);
+            p->swordAngle = std::sin(p->aliveTime * 2.0f) * 5;
+            p->bodyLean = std::sin(p->aliveTime) * 2;
+            };
+        animator.addAnimation("idle", idle);
+
+        // Attack animations
+        std::vector<AnimationFrame> hSlash = {
+            AnimationFrame("windup", 5),
+            AnimationFrame("slash", 8),
+            AnimationFrame("recovery", 10)
+        };
+        hSlash[0].onEnter = [](Entity* e) {
+            Player* p = static_cast<Player*>(e);
+            p->swordAngle = -45;
+            p->armAngle = -30;
+            };
+        hSlash[1].onEnter = [](Entity* e) {
+            Player* p = static_cast<Player*>(e);
+            p->swordAngle = 15;
+            p->armAngle = 45;
+            p->attackHitbox.active = true;
+            p->attackHitbox.size = Vec2(SWORD_REACH, 30);
+            p->attackHitbox.offset = Vec2(SWORD_REACH / 2, 0);
+            p->canCancelAttack = true;
+            };
+        hSlash[2].onExit = [](Entity* e) {
+            Player* p = static_cast<Player*>(e);
+            p->attackHitbox.active = false;
+            p->canCancelAttack = false;
+            };
+        animator.addAnimation("horizontal_slash", hSlash);
+    }
+
+    // PLAYER domain. Cooldowns tick separately in real time (updateAbilities)
+    // and slash trails in the EFFECTS domain (updateEffects).
+    void update(float dt) override {
+        bool bladeWasLive = isBladeLive();
+
+        Entity::update(dt);
+
+        // Handle input
+        if (hitStun <= 0) {
+            handleMovement(dt);
+            handleCombat(dt);
+            handleAbilities(dt);
+        }
+
+        // Sweep the step's motion before the swing can end, so the last
+        // piece of every swing is tested too
+        bool bladeLive = bladeWasLive || isBladeLive();
+        updateSwing(dt);
+        updateSweep(bladeLive);
+
+        // Back to idle once the slash has recovered
+        if (animator.isPlaying("horizontal_slash") && animator.isFinished() && !attackHitbox.active) {
+            animator.play(this, "idle");
+        }
+
+        // Update combo
+        if (comboTimer > 0) {
+            comboTimer -= dt;
+            if (comboTimer <= 0) {
+                comboCount = 0;
+            }
+        }
+
+        // Update dash
+        if (isDashing) {
+            updateDash(dt);
+        }
+
+        if (deflectTimer > 0) deflectTimer -= dt;
+
+        // Update after images
+        if (showAfterImage || isDashing || timeSlowActive) {
+            afterImages.push_back({ position, 0.5f });
+            if (afterImages.size() > 10) {
+                afterImages.pop_front();
+            }
+        }
+
+        // Fade after images
+        for (auto& [pos, alpha] : afterImages) {
+            alpha -= dt * 2;
+        }
+        afterImages.erase(
+            std::remove_if(afterImages.begin(), afterImages.end(),
+                [](const std::pair<Vec2, float>& img) { return img.second <= 0; }),
+            afterImages.end()
+        );
+    }
+
+    void updateSwing(float dt) {
+        if (swingDuration <= 0) return;
+
+        swingTime += dt;
+        float t = std::min(1.0f, swingTime / swingDuration);
+        swordAngle = swingFrom + (swingTo - swingFrom) * Utils::easeOutQuad(t);
+        if (t >= 1.0f) {
+            swingDuration = 0;
+            attackHitbox.active = false;
+            showAfterImage = false;
+        }
+    }
+
+    bool isAttacking() const {
+        return swingDuration > 0 ||
+            (animator.isPlaying("horizontal_slash") && !animator.isFinished());
+    }
+
+    void startSwing(float from, float to, float duration, float arm) {
+        swingFrom = from;
+        swingTo = to;
+        swingTime = 0;
+        swingDuration = duration;
+        swordAngle = from;
+        armAngle = arm;
+
+        // The snap to the windup pose was never swung; sweep from here
+        sweepHand = getHandPosition();
+        sweepBlade = getBladeAngle();
+        sweepFacingRight = facingRight;
+    }
+
+    bool isBladeLive() const { return attackHitbox.active && !areaAttack; }
+
+    // Extends the sweep by this step's motion while the blade is live. The
+    // motion starts from the pose the previous step ended in, unless the pose
+    // jumped (teleport) or the player turned, which would sweep the mirrored
+    // arc behind them.
+    void updateSweep(bool live) {
+        Vec2 hand = getHandPosition();
+        float blade = getBladeAngle();
+        if (facingRight != sweepFacingRight) sweepReset = true;
+
+        if (live) {
+            if (sweepReset) sweep.extend(hand, blade, hand, blade, 6.0f, SWORD_REACH);
+            else sweep.extend(sweepHand, sweepBlade, hand, blade, 6.0f, SWORD_REACH);
+        }
+        sweepHand = hand;
+        sweepBlade = blade;
+        sweepFacingRight = facingRight;
+        sweepReset = false;
+    }
+
+    // Combat has tested everything swept so far
+    void consumeSweep() { sweep.clear(); }
+
+    bool hasPendingAttack() const {
+        return (attackHitbox.active && areaAttack) || !sweep.empty();
+    }
+
+    void updateEffects(float dt) {
+        activeSlashes.removeIf([](const SlashEffect& s) { return !s.active; });
+
+        for (auto& slash : activeSlashes) {
+            slash.update(dt);
+        }
+    }
+
+    void handleMovement(float dt) {
+        // Horizontal movement (time slow favours the player via its domain scale)
+        float moveSpeed = stats.speed;
+
+        if (input->isKeyPressed(SDL_SCANCODE_A)) {
+            velocity.x = -moveSpeed;
+            facingRight = false;
+        }
+        else if (input->isKeyPressed(SDL_SCANCODE_D)) {
+            velocity.x = moveSpeed;
+            facingRight = true;
+        }
+
+        // Jumping
+        if (input->isKeyPressed(SDL_SCANCODE_SPACE) && onGround) {
+            velocity.y = -12;
+            onGround = false;
+
+            // Jump particles
+            for (int i = 0; i < 5; ++i) {
+                Vec2 vel(Utils::randomFloat(-2, 2), Utils::randomFloat(-1, 0));
+                particles.spawn<Particle>(
+                    position + Vec2(0, size.y / 2), vel, Color(200, 200, 200), 0.5f);
+            }
+        }
+
+        // Dash
+        if (input->isKeyPressed(SDL_SCANCODE_LSHIFT) && dashCooldown <= 0) {
+            startDash();
+        }
+
+        // Block
+        blocking = input->isMouseRightPressed() && blockMeter > 0;
+    }
+
+    void handleCombat(float dt) {
+        if (input->isMouseLeftJustPressed()) {
+            AttackType attack = input->getAttackFromGesture();
+            performAttack(attack);
+        }
+
+        // Update slash effect with mouse position
+        if (attackHitbox.active && input->isMouseLeftPressed()) {
+            slashEffect.addPoint(input->getMouseWorldPos());
+        }
+    }
+
+    void handleAbilities(float dt) {
+        // Time slow (Q)
+        if (input->isKeyPressed(SDL_SCANCODE_Q) &&
+            abilityCooldowns[AbilityType::TIME_SLOW] <= 0) {
+            activateTimeSlow();
+        }
+
+        // Shockwave (E)
+        if (input->isKeyPressed(SDL_SCANCODE_E) &&
+            abilityCooldowns[AbilityType::SHOCKWAVE] <= 0) {
+            performShockwave();
+        }
+
+        // Teleport to mouse (R)
+        if (input->isKeyPressed(SDL_SCANCODE_R) &&
+            abilityCooldowns[AbilityType::TELEPORT] <= 0) {
+            teleportToMouse();
+        }
+
+        // Deflect (F)
+        if (input->isKeyPressed(SDL_SCANCODE_F) &&
+            abilityCooldowns[AbilityType::DEFLECT] <= 0) {
+            activateDeflect();
+        }
+    }
+
+    void performAttack(AttackType type) {
+        if (isAttacking() && !canCancelAttack) return;
+        canCancelAttack = false;
+        attackCount++;
+
+        // Create slash effect
+        Handle<SlashEffect> slash = activeSlashes.emplace();
+        activeSlashes.get(slash)->start(position + Vec2(facingRight ? 30 : -30, 0));
+
+        // Combo system
+        if (comboTimer > 0 && type != lastAttack) {
+            comboCount++;
+            comboCount = std::min(comboCount, 10);
+        }
+        else {
+            comboCount = 1;
+        }
+        comboTimer = 1.0f;
+        lastAttack = type;
+
+        // Apply combo multiplier to damage
+        float comboMultiplier = 1.0f + (comboCount - 1) * 0.2f;
+
+        switch (type) {
+        case AttackType::HORIZONTAL_SLASH:
+            animator.play(this, "horizontal_slash", false, true);
+            attackHitbox.damage = stats.attack * comboMultiplier;
+            attackHitbox.knockback = 5 + comboCount;
+            attackHitbox.hitStun = 10 + comboCount * 2;
+            break;
+
+        case AttackType::UPPERCUT:
+            startSwing(60, -110, 0.15f, -20);
+            attackHitbox.damage = stats.attack * 1.5f * comboMultiplier;
+            attackHitbox.knockback = 8;
+            attackHitbox.hitStun = 15;
+            attackHitbox.size = Vec2(60, 80);
+            attackHitbox.offset = Vec2(30, -40);
+            velocity.y = -8; // Jump with uppercut
+            break;
+
+        case AttackType::SPIN_ATTACK:
+            startSwing(0, 360, 0.3f, 0);
+            attackHitbox.damage = stats.attack * 2 * comboMultiplier;
+            attackHitbox.knockback = 10;
+            attackHitbox.hitStun = 20;
+            attackHitbox.size = Vec2(120, 60);
+            attackHitbox.offset = Vec2(0, 0);
+            showAfterImage = true;
+            break;
+
+        default:
+            startSwing(-60, 70, 0.12f, 0);
+            attackHitbox.damage = stats.attack * comboMultiplier;
+            attackHitbox.knockback = 5;
+            attackHitbox.hitStun = 10;
+            break;
+        }
+
+        // The slash animation activates its own hitbox on the slash frame
+        attackHitbox.active = type != AttackType::HORIZONTAL_SLASH;
+        areaAttack = false;
+    }
+
+    void startDash() {
+        isDashing = true;
+        dashTime = 0.2f;
+        dashCooldown = 0.5f;
+
+        // Dash towards mouse or movement direction
+        Vec2 mousePos = input->getMouseWorldPos();
+        dashDirection = (mousePos - position).normalized();
+
+        if (dashDirection.length() < 0.1f) {
+            dashDirection = Vec2(facingRight ? 1 : -1, 0);
+        }
+
+        invulnerableFrames = 12; // Brief invulnerability during dash
+    }
+
+    void updateDash(float dt) {
+        if (dashTime > 0) {
+            velocity = dashDirection * DASH_SPEED;
+            dashTime -= dt;
+
+            // Dash particles
+            for (int i = 0; i < 2; ++i) {
+                Vec2 vel = -dashDirection * Utils::randomFloat(2, 5);
+                particles.spawn<Particle>(
+                    position, vel, Color(100, 100, 255), 0.3f);
+            }
+        }
+        else {
+            isDashing = false;
+            velocity *= 0.5f; // Slow down after dash
+        }
+    }
+
+    void activateTimeSlow() {
+        timeSlowActive = true;
+        timeSlowDuration = 3.0f;
+        abilityCooldowns[AbilityType::TIME_SLOW] = 10.0f;
+
+        // Visual effect
+        for (int i = 0; i < 20; ++i) {
+            float angle = (i / 20.0f) * TWO_PI;
+            Vec2 vel = Vec2::fromAngle(angle, 5);
+            particles.spawn<Particle>(
+                position, vel, Color(100, 100, 255), 1.0f);
+        }
+    }
+
+    void performShockwave() {
+        abilityCooldowns[AbilityType::SHOCKWAVE] = 5.0f;
+
+        // Create shockwave hitbox
+        attackHitbox.active = true;
+        areaAttack = true;
+        attackHitbox.size = Vec2(300, 100);
+        attackHitbox.offset = Vec2(0, 0);
+        attackHitbox.damage = stats.attack * 3;
+        attackHitbox.knockback = 15;
+        attackHitbox.hitStun = 30;
+
+        // Visual effect
+        for (int i = 0; i < 30; ++i) {
+            float angle = Utils::randomFloat(0, TWO_PI);
+            Vec2 vel = Vec2::fromAngle(angle, Utils::randomFloat(5, 15));
+            particles.spawn<SparkParticle>(position, vel);
+        }
+    }
+
+    // Opens a short window in which GameWorld reflects incoming projectiles
+    // inside the sword arc (see ProjectileSystem::deflect)
+    void activateDeflect() {
+        abilityCooldowns[AbilityType::DEFLECT] = 4.0f;
+        deflectTimer = 0.25f;
+        swordAngle = -60;
+        armAngle = -20;
+
+        for (int i = 0; i < 8; ++i) {
+            float angle = getFacingAngle() + Utils::randomFloat(-DEFLECT_HALF_ARC, DEFLECT_HALF_ARC);
+            Vec2 vel = Vec2::fromAngle(angle, Utils::randomFloat(3, 6));
+            particles.spawn<SparkParticle>(position, vel);
+        }
+    }
+
+    void teleportToMouse() {
+        Vec2 mousePos = input->getMouseWorldPos();
+        Vec2 oldPos = position;
+        position = mousePos;
+        position.y = std::min(position.y, GROUND_Y - size.y / 2);
+        sweepReset = true;
+
+        abilityCooldowns[AbilityType::TELEPORT] = 3.0f;
+
+        // Teleport particles at both locations
+        for (int i = 0; i < 10; ++i) {
+            float angle = Utils::randomFloat(0, TWO_PI);
+            Vec2 vel = Vec2::fromAngle(angle, Utils::randomFloat(2, 5));
+
+            particles.spawn<Particle>(
+                oldPos, vel, Color(150, 0, 255), 0.5f);
+            particles.spawn<Particle>(
+                position, -vel, Color(150, 0, 255), 0.5f);
+        }
+    }
+
+    void updateAbilities(float dt) {
+        // Update cooldowns
+        for (auto& [ability, cooldown] : abilityCooldowns) {
+            if (cooldown > 0) cooldown -= dt;
+        }
+
+        if (dashCooldown > 0) dashCooldown -= dt;
+
+        // Update time slow
+        if (timeSlowActive) {
+            timeSlowDuration -= dt;
+            if (timeSlowDuration <= 0) {
+                timeSlowActive = false;
+            }
+        }
+    }
+
+    void draw(Draw& draw) override {
+        // Draw after images
+        for (const auto& [imgPos, alpha] : afterImages) {
+            drawStickman(draw, imgPos, Color(100, 100, 255, int(alpha * 255)));
+        }
+
+        // Draw main character
+        Color mainColor = invulnerableFrames > 0 && (invulnerableFrames % 4 < 2) ?
+            Color(255, 100, 100) : Color(0, 0, 0);
+        drawStickman(draw, position, mainColor);
+
+        // Draw sword
+        drawSword(draw);
+
+        // Draw slashes
+        for (auto& slash : activeSlashes) {
+            slash.draw(draw);
+        }
+
+        // Draw particles
+        drawParticles(draw);
+
+        // Draw UI elements
+        drawHealthBar(draw);
+        drawComboCounter(draw);
+
+        // Debug hitboxes
+#ifdef DEBUG
+        hurtbox.draw(draw, Color(0, 255, 0, 100));
+        if (attackHitbox.active && areaAttack) {
+            attackHitbox.draw(draw, Color(255, 0, 0, 100));
+        }
+        draw.color(255, 0, 0, 100);
+        sweep.draw(draw);
+#endif
+    }
+
+    void drawStickman(Draw& draw, Vec2 pos, Color color) {
+        SDL_Color c = color.toSDL();
+        draw.color(c.r, c.g, c.b, c.a);
+
+        float headY = pos.y - size.y / 2 + 10;
+
+        // Head
+        draw.circle(pos.x, headY, 8);
+        draw.fill_circle(pos.x, headY, 7);
+
+        // Body
+        float bodyTop = headY + 8;
+        float bodyBottom = pos.y + size.y / 2 - 15;
+        draw.line(pos.x, bodyTop, pos.x + bodyLean, bodyBottom);
+
+        // Arms
+        float shoulderY = bodyTop + 5;
+        float armLength = 20;
+
+        // Sword arm
+        float arm = Utils::degToRad(armAngle);
+        float swordArmAngle = facingRight ? arm : PI - arm;
+        Vec2 swordElbow = Vec2(pos.x, shoulderY) +
+            Vec2::fromAngle(swordArmAngle + PI / 4, armLength / 2);
+        Vec2 swordHand = swordElbow +
+            Vec2::fromAngle(swordArmAngle, armLength / 2);
+        draw.line(pos.x, shoulderY, swordElbow.x, swordElbow.y);
+        draw.line(swordElbow.x, swordElbow.y, swordHand.x, swordHand.y);
+
+        // Other arm
+        float otherArmAngle = -arm * 0.5f;
+        Vec2 otherElbow = Vec2(pos.x, shoulderY) +
+            Vec2::fromAngle(otherArmAngle + PI * 0.75f, armLength / 2);
+        Vec2 otherHand = otherElbow +
+            Vec2::fromAngle(otherArmAngle + PI, armLength / 2);
+        draw.line(pos.x, shoulderY, otherElbow.x, otherElbow.y);
+        draw.line(otherElbow.x, otherElbow.y, otherHand.x, otherHand.y);
+
+        // Legs
+        float hipY = bodyBottom;
+        float legLength = 25;
+
+        if (isDashing || std::abs(velocity.x) > 3) {
+            // Running animation
+            float runCycle = SDL_GetTicks() * 0.01f;
+            float leg1Angle = std::sin(runCycle) * 0.5f;
+            float leg2Angle = std::sin(runCycle + PI) * 0.5f;
+
+            Vec2 knee1 = Vec2(pos.x, hipY) +
+                Vec2::fromAngle(PI / 2 + leg1Angle, legLength / 2);
+            Vec2 foot1 = knee1 +
+                Vec2::fromAngle(PI / 2 + leg1Angle * 0.5f, legLength / 2);
+
+            Vec2 knee2 = Vec2(pos.x, hipY) +
+                Vec2::fromAngle(PI / 2 + leg2Angle, legLength / 2);
+            Vec2 foot2 = knee2 +
+                Vec2::fromAngle(PI / 2 + leg2Angle * 0.5f, legLength / 2);
+
+            draw.line(pos.x, hipY, knee1.x, knee1.y);
+            draw.line(knee1.x, knee1.y, foot1.x, foot1.y);
+            draw.line(pos.x, hipY, knee2.x, knee2.y);
+            draw.line(knee2.x, knee2.y, foot2.x, foot2.y);
+        }
+        else {
+            // Standing
+            draw.line(pos.x, hipY, pos.x - 5, pos.y + size.y / 2);
+            draw.line(pos.x, hipY, pos.x + 5, pos.y + size.y / 2);
+        }
+    }
+
+    // Sword hand and blade direction in world space; shared by drawing and
+    // the hit sweep so hits follow the blade the player sees
+    Vec2 getHandPosition() const {
+        float arm = Utils::degToRad(armAngle);
+        float swordArmAngle = facingRight ? arm : PI - arm;
+        Vec2 shoulderPos = position + Vec2(0, -size.y / 2 + 15);
+        Vec2 elbowPos = shoulderPos + Vec2::fromAngle(swordArmAngle + PI / 4, 10);
+        return elbowPos + Vec2::fromAngle(swordArmAngle, 10);
+    }
+
+    float getBladeAngle() const {
+        float angle = Utils::degToRad(armAngle + swordAngle);
+        return facingRight ? angle : PI - angle;
+    }
+
+    // Earliest point of the pending sweep at which the attack touches box,
+    // or -1. The sweep can outlive the hitbox by the step that ended it.
+    float testAttack(const Hitbox& box) const {
+        if (!box.active) return -1.0f;
+        if (areaAttack) return attackHitbox.active && attackHitbox.intersects(box) ? 0.0f : -1.0f;
+        return sweep.test(box.getRect());
+    }
+
+    void drawSword(Draw& draw) {
+        // Sword extends from hand
+        Vec2 handPos = getHandPosition();
+        float swordLength = SWORD_REACH;
+        float currentSwordAngle = getBladeAngle();
+        Vec2 swordTip = handPos + Vec2::fromAngle(currentSwordAngle, swordLength);
+
+        // Draw sword with glow effect
+        if (comboCount > 3) {
+            // Combo glow
+            for (int i = 3; i > 0; i--) {
+                int alpha = 50 * (comboCount - 3) * i / 3;
+                draw.color(255, 100, 100, alpha);
+                float width = 3 + i;
+
+                // Draw thick glowing line
+                Vec2 perpendicular = (swordTip - handPos).perpendicular().normalized();
+                std::vector<SDL_FPoint> quad = {
+                    {handPos.x - perpendicular.x * width / 2,
+                     handPos.y - perpendicular.y * width / 2},
+                    {handPos.x + perpendicular.x * width / 2,
+                     handPos.y + perpendicular.y * width / 2},
+                    {swordTip.x + perpendicular.x * width / 2,
+                     swordTip.y + perpendicular.y * width / 2},
+                    {swordTip.x - perpendicular.x * width / 2,
+                     swordTip.y - perpendicular.y * width / 2},
+                    {handPos.x - perpendicular.x * width / 2,
+                     handPos.y - perpendicular.y * width / 2}
+                };
+                draw.polygon(quad);
+            }
+        }
+
+        // Main sword
+        draw.color(200, 200, 200);
+        for (int i = -1; i <= 1; i++) {
+            Vec2 offset = Vec2(i, 0);
+            draw.line(handPos.x + offset.x, handPos.y + offset.y,
+                swordTip.x + offset.x, swordTip.y + offset.y);
+        }
+
+        // Hilt
+        Vec2 hiltPerpendicular = (swordTip - handPos).perpendicular().normalized();
+        draw.color(100, 50, 0);
+        draw.line(handPos.x - hiltPerpendicular.x * 8,
+            handPos.y - hiltPerpendicular.y * 8,
+            handPos.x + hiltPerpendicular.x * 8,
+            handPos.y + hiltPerpendicular.y * 8);
+
+        // Hand guard
+        draw.color(150, 150, 150);
+        Vec2 guardPos = handPos + Vec2::fromAngle(currentSwordAngle, 10);
+        draw.line(guardPos.x - hiltPerpendicular.x * 10,
+            guardPos.y - hiltPerpendicular.y * 10,
+            guardPos.x + hiltPerpendicular.x * 10,
+            guardPos.y + hiltPerpendicular.y * 10);
+    }
+
+    void drawComboCounter(Draw& draw) {
+        if (comboCount <= 1) return;
+
+        Vec2 comboPos = position + Vec2(0, -size.y / 2 - 40);
+
+        // Combo text with scaling effect
+        float scale = 1.0f + (comboTimer > 0.8f ? (comboTimer - 0.8f) * 2 : 0);
+        int fontSize = 12 * scale;
+
+        // Shadow
+        draw.color(0, 0, 0, 200);
+        draw.fill_rect(comboPos.x - 20, comboPos.y - 10, 40, 20);
+
+        // Text (would need proper text rendering in real implementation)
+        Color comboColor = Utils::rainbow(comboCount / 10.0f);
+        SDL_Color c = comboColor.toSDL();
+        draw.color(c.r, c.g, c.b);
+
+        // Draw combo count
+        std::string comboText = std::to_string(comboCount) + "x";
+        draw.fill_circle(comboPos.x, comboPos.y, fontSize / 2);
+    }
+
+    // Ability icons are cached by the HUD; they repaint when an overlay
+    // moves by a whole pixel rather than on every cooldown tick
+    static constexpr float ABILITY_ICON_SIZE = 40;
+    static constexpr int ABILITY_ICONS = 3;
+
+    static int cooldownOverlay(float cooldown) {
+        if (cooldown <= 0) return 0;
+        float cooldownPercent = cooldown / 10.0f; // Max 10 second cooldown
+        return static_cast<int>(std::ceil(ABILITY_ICON_SIZE * cooldownPercent));
+    }
+
+    void addCooldownKey(HudKey& key) const {
+        int abilityIndex = 0;
+        for (const auto& [ability, cooldown] : abilityCooldowns) {
+            key.add(ability).add(cooldownOverlay(cooldown));
+            if (++abilityIndex >= ABILITY_ICONS) break;
+        }
+    }
+
+    void drawAbilityCooldowns(Draw& draw) {
+        float startX = 20;
+        float startY = SCREEN_HEIGHT - 100;
+        float iconSize = ABILITY_ICON_SIZE;
+        float spacing = 50;
+
+        int abilityIndex = 0;
+        for (const auto& [ability, cooldown] : abilityCooldowns) {
+            Vec2 iconPos(startX + abilityIndex * spacing, startY);
+
+            // Background
+            draw.color(50, 50, 50);
+            draw.fill_rect(iconPos.x, iconPos.y, iconSize, iconSize);
+
+            // Cooldown overlay
+            int overlay = cooldownOverlay(cooldown);
+            if (overlay > 0) {
+                draw.color(0, 0, 0, 180);
+                draw.fill_rect(iconPos.x, iconPos.y, iconSize, static_cast<float>(overlay));
+            }
+
+            // Border
+            draw.color(100, 100, 100);
+            draw.rect(iconPos.x, iconPos.y, iconSize, iconSize);
+
+            // Ability icon (simplified)
+            draw.color(255, 255, 255);
+            switch (ability) {
+            case AbilityType::TIME_SLOW:
+                draw.circle(iconPos.x + iconSize / 2, iconPos.y + iconSize / 2, 15);
+                break;
+            case AbilityType::SHOCKWAVE:
+                for (int i = 0; i < 3; i++) {
+                    draw.circle(iconPos.x + iconSize / 2, iconPos.y + iconSize / 2, 5 + i * 5);
+                }
+                break;
+            case AbilityType::TELEPORT:
+                draw.line(iconPos.x + 10, iconPos.y + 10,
+                    iconPos.x + iconSize - 10, iconPos.y + iconSize - 10);
+                draw.line(iconPos.x + iconSize - 10, iconPos.y + 10,
+                    iconPos.x + 10, iconPos.y + iconSize - 10);
+                break;
+            case AbilityType::DEFLECT:
+                draw.line(iconPos.x + 10, iconPos.y + iconSize - 10,
+                    iconPos.x + iconSize - 10, iconPos.y + 10);
+                draw.circle(iconPos.x + iconSize - 12, iconPos.y + 12, 5);
+                break;
+            }
+
+            abilityIndex++;
+            if (abilityIndex >= ABILITY_ICONS) break; // Only show first 3 abilities
+        }
+    }
+
+    // Getters
+    bool isTimeSlowActive() const { return timeSlowActive; }
+    bool isDeflecting() const { return deflectTimer > 0; }
+    float getFacingAngle() const { return facingRight ? 0.0f : PI; }
+    float getTimeScale() const { return timeSlowActive ? TIME_SCALE_SLOW : 1.0f; }
+    float getPlayerTimeScale() const { return timeSlowActive ? PLAYER_TIME_SCALE_SLOW : 1.0f; }
+    int getCombo() const { return comboCount; }
+    int getAttackCount() const { return attackCount; }
+};
+
+// ===== ENEMY CLASS =====
+// Read-only view of the world taken before the enemy step. Enemies update in
+// parallel against it and only write their own state; anything that touches
+// shared state (projectiles, platform collision, effect particles) is left as
+// an intent for GameWorld to commit in a fixed order afterwards.
+struct EnemySnapshot {
+    Handle<Player> player; // Live player at snapshot time
+    Vec2 playerPosition;
+    const NavGraph* nav;   // Null: chase in a straight line
+    const FlowField* flow; // Toward the player's surface
+};
+
+// Visual effect requested during the enemy step, spawned at commit
+struct EffectIntent {
+    enum Kind { PARTICLE, SPARK };
+    Kind kind;
+    Vec2 position;
+    Vec2 velocity;
+    Color color;
+    float life;
+};
+
+class Enemy : public Entity {
+private:
+    EnemyType type;
+    Handle<Player> target;
+    std::minstd_rand rng; // Private stream so the step is thread-count independent
+    int navNode;          // Surface stood on at the start of the step, -1 airborne
+    int navLink;          // Flow field link being followed
+    std::vector<EffectIntent> pendingEffects;
+    float attackCooldown;
+    float detectionRange;
+    float attackRange;
+
+    // AI state
+    enum AIState { IDLE, PATROL, CHASE, ATTACK, RETREAT, STUNNED };
+    AIState aiState;
+    float stateTimer;
+    Vec2 patrolTarget;
+
+    // Combat patterns
+    int attackPattern;
+    int attackStep;
+
+    // Arrow fired this step, collected by GameWorld (takeShot)
+    bool shotPending;
+    Vec2 shotOrigin;
+    Vec2 shotVelocity;
+
+public:
+    Enemy(Vec2 pos, EnemyType enemyType, Handle<Player> player, uint32_t seed = 1)
+        : Entity(pos), type(enemyType), target(player), rng(seed), navNode(-1), navLink(-1),
+        attackCooldown(0),
+        detectionRange(300), attackRange(100), aiState(IDLE),
+        stateTimer(0), attackPattern(0), attackStep(0), shotPending(false) {
+
+        setupByType();
+    }
+
+    void setupByType() {
+        switch (type) {
+        case EnemyType::BASIC_GRUNT:
+            stats = CombatStats(50, 8, 3, 4);
+            size = Vec2(25, 50);
+            detectionRange = 200;
+            attackRange = 60;
+            break;
+
+        case EnemyType::HEAVY_BRUTE:
+            stats = CombatStats(120, 15, 8, 2);
+            size = Vec2(40, 70);
+            detectionRange = 150;
+            attackRange = 80;
+            break;
+
+        case EnemyType::NINJA_ASSASSIN:
+            stats = CombatStats(40, 12, 2, 10);
+            size = Vec2(20, 45);
+            detectionRange = 400;
+            attackRange = 50;
+            stats.critChance = 0.4f;
+            break;
+
+        case EnemyType::RANGED_ARCHER:
+            stats = CombatStats(35, 10, 2, 3);
+            size = Vec2(22, 48);
+            detectionRange = 650;
+            attackRange = 500;
+            break;
+
+        case EnemyType::BOSS_SAMURAI:
+            stats = CombatStats(300, 20, 10, 6);
+            size = Vec2(35, 65);
+            detectionRange = 500;
+            attackRange = 100;
+            break;
+        }
+    }
+
+    float randomFloat(float min, float max) {
+        std::uniform_real_distribution<float> dis(min, max);
+        return dis(rng);
+    }
+
+    // Safe to run concurrently for different enemies: reads only the
+    // snapshot and writes only this enemy. Once the target handle no longer
+    // matches the snapshot's player (player replaced) the enemy idles.
+    void update(float dt, const EnemySnapshot& world) {
+        // onGround here is from last step's platform resolve; Entity::update
+        // only knows about the ground plane
+        navNode = onGround && world.nav ? world.nav->locate(position + Vec2(0, size.y / 2)) : -1;
+        Entity::update(dt);
+
+        if (hitStun > 0) {
+            aiState = STUNNED;
+            return;
+        }
+
+        if (world.player != target) {
+            aiState = IDLE;
+            return;
+        }
+
+        updateAI(dt, world);
+
+        if (attackCooldown > 0) {
+            attackCooldown -= dt;
+        }
+    }
+
+    void updateAI(float dt, const EnemySnapshot& world) {
+        const Vec2& targetPos = world.playerPosition;
+        float distanceToTarget = (targetPos - position).length();
+        Vec2 dirToTarget = (targetPos - position).normalized();
+
+        // Face target
+        facingRight = targetPos.x > position.x;
+
+        switch (aiState) {
+        case IDLE:
+            if (distanceToTarget < detectionRange) {
+                aiState = CHASE;
+            }
+            else {
+                // Start patrolling
+                aiState = PATROL;
+                patrolTarget = position + Vec2(randomFloat(-100, 100), 0);
+            }
+            break;
+
+        case PATROL:
+        {
+            Vec2 toPatrolTarget = patrolTarget - position;
+            if (toPatrolTarget.length() > 10) {
+                velocity.x = toPatrolTarget.normalized().x * stats.speed * 0.5f;
+            }
+            else {
+                // Reached patrol point, pick new one
+                patrolTarget = position + Vec2(randomFloat(-150, 150), 0);
+            }
+
+            if (distanceToTarget < detectionRange) {
+                aiState = CHASE;
+            }
+        }
+        break;
+
+        case CHASE:
+            if (distanceToTarget > detectionRange * 1.5f) {
+                aiState = IDLE;
+            }
+            else if (type == EnemyType::RANGED_ARCHER && distanceToTarget < 150) {
+                // Archers back off rather than trade blows
+                aiState = RETREAT;
+                stateTimer = 0.6f;
+            }
+            else if (distanceToTarget < attackRange) {
+                aiState = ATTACK;
+                velocity.x = 0;
+            }
+            else {
+                followFlow(dirToTarget, world);
+            }
+            break;
+
+        case ATTACK:
+            if (distanceToTarget > attackRange * 1.2f) {
+                aiState = CHASE;
+            }
+            else if (attackCooldown <= 0) {
+                if (type == EnemyType::RANGED_ARCHER) {
+                    fireArrow(targetPos);
+                    attackCooldown = 1.6f;
+                }
+                else {
+                    performAttackPattern();
+                    attackCooldown = 1.0f / (stats.speed / 5.0f);
+                }
+            }
+            else if (type == EnemyType::RANGED_ARCHER && distanceToTarget < 150) {
+                aiState = RETREAT;
+                stateTimer = 0.6f;
+            }
+            break;
+
+        case RETREAT:
+            velocity.x = -dirToTarget.x * stats.speed * 1.5f;
+            stateTimer -= dt;
+            if (stateTimer <= 0 || distanceToTarget > attackRange * 2) {
+                aiState = CHASE;
+            }
+            break;
+
+        case STUNNED:
+            // Handled in main update
+            break;
+        }
+    }
+
+    // One flow field lookup per step. Off the field (same surface as the
+    // player, unreachable, or no nav) the enemy walks straight at the target.
+    void followFlow(const Vec2& dirToTarget, const EnemySnapshot& world) {
+        if (navNode >= 0) navLink = world.flow ? world.flow->getNext(navNode) : -1;
+        const NavLink* link = navLink >= 0 ? &world.nav->getLink(navLink) : nullptr;
+
+        if (!link) {
+            velocity.x = dirToTarget.x * stats.speed;
+            return;
+        }
+
+        if (navNode < 0) {
+            // Mid-leap: keep the launch velocity; after a drop steer to the landing
+            if (link->type != NavLinkType::JUMP) {
+                velocity.x = (link->landingX > position.x ? 1.0f : -1.0f) * stats.speed;
+            }
+            return;
+        }
+
+        if (link->type != NavLinkType::JUMP) {
+            velocity.x = (link->landingX > position.x ? 1.0f : -1.0f) * stats.speed;
+            return;
+        }
+
+        float toTakeoff = link->takeoffX - position.x;
+        if (std::abs(toTakeoff) > std::max(6.0f, stats.speed)) {
+            velocity.x = (toTakeoff > 0 ? 1.0f : -1.0f) * stats.speed;
+            return;
+        }
+
+        float dx = link->landingX - position.x;
+        velocity.x = (dx > 0 ? 1.0f : -1.0f) * world.nav->launchSpeedX(dx, link->airFrames);
+        velocity.y = -link->jumpSpeed;
+        onGround = false;
+    }
+
+    // Aims at the target's chest, lifting the shot to cancel arrow drop over
+    // the estimated flight time
+    void fireArrow(const Vec2& targetPos) {
+        shotOrigin = position + Vec2(facingRight ? 12.0f : -12.0f, -size.y / 4);
+        Vec2 aim = targetPos - shotOrigin;
+        float frames = aim.length() / ARROW_SPEED;
+        Vec2 dir = aim.normalized();
+        shotVelocity = dir * ARROW_SPEED;
+        shotVelocity.y -= 0.5f * ARROW_GRAVITY * frames;
+        shotPending = true;
+    }
+
+    // Returns the arrow fired since the last call, if any
+    bool takeShot(Vec2& origin, Vec2& velocity) {
+        if (!shotPending) return false;
+        origin = shotOrigin;
+        velocity = shotVelocity;
+        shotPending = false;
+        return true;
+    }
+
+    float getArrowDamage() const { return stats.attack; }
+
+    // Commit phase: turn this step's effect intents into particles
+    void spawnPendingEffects() {
+        for (const EffectIntent& fx : pendingEffects) {
+            if (fx.kind == EffectIntent::SPARK) {
+                particles.spawn<SparkParticle>(fx.position, fx.velocity);
+            }
+            else {
+                particles.spawn<Particle>(fx.position, fx.velocity, fx.color, fx.life);
+            }
+        }
+        pendingEffects.clear();
+    }
+
+    void performAttackPattern() {
+        attackHitbox.active = true;
+        attackHitbox.damage = stats.attack;
+        attackHitbox.knockback = 5;
+        attackHitbox.hitStun = 10;
+
+        switch (type) {
+        case EnemyType::BASIC_GRUNT:
+            // Simple horizontal attack
+            attackHitbox.size = Vec2(60, 30);
+            attackHitbox.offset = Vec2(facingRight ? 30 : -30, 0);
+
+            // Attack particles
+            for (int i = 0; i < 3; ++i) {
+                Vec2 vel = Vec2(facingRight ? 3 : -3, randomFloat(-2, 2));
+                pendingEffects.push_back({ EffectIntent::PARTICLE, position + attackHitbox.offset,
+                    vel, Color(255, 100, 100), 0.3f });
+            }
+            break;
+
+        case EnemyType::NINJA_ASSASSIN:
+            // Quick multi-hit combo
+            if (attackStep == 0) {
+                attackHitbox.size = Vec2(50, 20);
+                attackHitbox.offset = Vec2(facingRight ? 25 : -25, -10);
+                attackStep = 1;
+                attackCooldown = 0.2f;
+            }
+            else if (attackStep == 1) {
+                attackHitbox.size = Vec2(50, 20);
+                attackHitbox.offset = Vec2(facingRight ? 25 : -25, 10);
+                attackStep = 2;
+                attackCooldown = 0.2f;
+            }
+            else {
+                // Dash attack
+                velocity.x = (facingRight ? 1 : -1) * 15;
+                attackHitbox.size = Vec2(70, 30);
+                attackHitbox.offset = Vec2(facingRight ? 35 : -35, 0);
+                attackStep = 0;
+                attackCooldown = 1.5f;
+            }
+            break;
+
+        case EnemyType::BOSS_SAMURAI:
+            // Complex pattern with multiple attacks
+            attackPattern = (attackPattern + 1) % 3;
+            switch (attackPattern) {
+            case 0: // Horizontal sweep
+                attackHitbox.size = Vec2(100, 40);
+                attackHitbox.offset = Vec2(facingRight ? 50 : -50, 0);
+                attackHitbox.damage = stats.attack * 1.5f;
+                break;
+            case 1: // Uppercut
+                velocity.y = -8;
+                attackHitbox.size = Vec2(60, 80);
+                attackHitbox.offset = Vec2(facingRight ? 30 : -30, -40);
+                attackHitbox.damage = stats.attack * 2;
+                attackHitbox.knockback = 10;
+                break;
+            case 2: // Ground slam
+                attackHitbox.size = Vec2(150, 60);
+                attackHitbox.offset = Vec2(0, 30);
+                attackHitbox.damage = stats.attack * 2.5f;
+                attackHitbox.knockback = 15;
+                attackHitbox.hitStun = 20;
+
+                // Shockwave particles
+                for (int i = 0; i < 10; ++i) {
+                    float angle = randomFloat(-PI / 4, PI / 4);
+                    Vec2 vel = Vec2::fromAngle(angle, randomFloat(5, 10));
+                    vel.y = -std::abs(vel.y);
+                    pendingEffects.push_back({ EffectIntent::SPARK, position + Vec2(0, size.y / 2),
+                        vel, Color(), 0.0f });
+                }
+                break;
+            }
+            break;
+        }
+
+        // Schedule hitbox deactivation
+        stateTimer = 0.2f;
+    }
+
+    void takeDamage(float damage, Vec2 knockbackDir, int stun) override {
+        Entity::takeDamage(damage, knockbackDir, stun);
+
+        // Retreat after taking damage (for smarter enemies)
+        if (type == EnemyType::NINJA_ASSASSIN && stats.getHealthPercent() < 0.3f) {
+            aiState = RETREAT;
+            stateTimer = 1.0f;
+        }
+    }
+
+    void draw(Draw& draw) override {
+        // Draw based on enemy type
+        Color enemyColor = Color(100, 0, 0);
+        if (invulnerableFrames > 0 && (invulnerableFrames % 4 < 2)) {
+            enemyColor = Color(255, 100, 100);
+        }
+
+        switch (type) {
+        case EnemyType::BASIC_GRUNT:
+            drawBasicEnemy(draw, enemyColor);
+            break;
+        case EnemyType::NINJA_ASSASSIN:
+            drawNinjaEnemy(draw, enemyColor);
+            break;
+        case EnemyType::RANGED_ARCHER:
+            drawArcherEnemy(draw, enemyColor);
+            break;
+        case EnemyType::BOSS_SAMURAI:
+            drawBossEnemy(draw, enemyColor);
+            break;
+        default:
+            drawBasicEnemy(draw, enemyColor);
+            break;
+        }
+
+        drawParticles(draw);
+        drawHealthBar(draw);
+
+        // Draw attack telegraph
+        if (attackCooldown > 0.8f && attackCooldown < 1.0f) {
+            draw.color(255, 0, 0, 100);
+            SDL_FRect telegraphRect = attackHitbox.getRect();
+            draw.rect(telegraphRect.x, telegraphRect.y, telegraphRect.w, telegraphRect.h);
+        }
+    }
+
+    void drawBasicEnemy(Draw& draw, Color color) {
+        SDL_Color c = color.toSDL();
+        draw.color(c.r, c.g, c.b, c.a);
+
+        // Simple stickman
+        float headY = position.y - size.y / 2 + 8;
+
+        // Head
+        draw.fill_circle(position.x, headY, 6);
+
+        // Body
+        draw.line(position.x, headY + 6, position.x, position.y + size.y / 2 - 10);
+
+        // Arms
+        float armY = headY + 10;
+        draw.line(position.x, armY, position.x - 10, armY + 10);
+        draw.line(position.x, armY, position.x + 10, armY + 10);
+
+        // Legs
+        float legY = position.y + size.y / 2 - 10;
+        draw.line(position.x, legY, position.x - 5, position.y + size.y / 2);
+        draw.line(position.x, legY, position.x + 5, position.y + size.y / 2);
+
+        // Weapon (club)
+        if (attackHitbox.active) {
+            draw.color(100, 50, 0);
+            Vec2 weaponPos = position + attackHitbox.offset;
+            draw.fill_rect(weaponPos.x - 5, weaponPos.y - 15, 10, 30);
+        }
+    }
+
+    void drawNinjaEnemy(Draw& draw, Color color) {
+        SDL_Color c = color.toSDL();
+        draw.color(c.r, c.g, c.b, c.a);
+
+        float headY = position.y - size.y / 2 + 6;
+
+        // Head with mask
+        draw.fill_circle(position.x, headY, 5);
+        draw.color(50, 50, 50);
+        draw.fill_rect(position.x - 5, headY - 2, 10, 4);
+
+        // Slim body
+        draw.color(c.r, c.g, c.b, c.a);
+        draw.line(position.x, headY + 5, position.x, position.y + size.y / 2 - 8);
+
+        // Dynamic arms
+        float armY = headY + 8;
+        if (attackHitbox.active) {
+            // Attack pose
+            float attackAngle = facingRight ? -PI / 4 : -3 * PI / 4;
+            Vec2 hand = Vec2(position.x, armY) + Vec2::fromAngle(attackAngle, 15);
+            draw.line(position.x, armY, hand.x, hand.y);
+
+            // Kunai
+            draw.color(150, 150, 150);
+            Vec2 kunaiTip = hand + Vec2::fromAngle(attackAngle, 20);
+            draw.line(hand.x, hand.y, kunaiTip.x, kunaiTip.y);
+        }
+        else {
+            draw.line(position.x, armY, position.x - 8, armY + 8);
+            draw.line(position.x, armY, position.x + 8, armY + 8);
+        }
+
+        // Crouched legs
+        draw.color(c.r, c.g, c.b, c.a);
+        float legY = position.y + size.y / 2 - 8;
+        draw.line(position.x, legY, position.x - 6, position.y + size.y / 2);
+        draw.line(position.x, legY, position.x + 6, position.y + size.y / 2);
+    }
+
+    void drawArcherEnemy(Draw& draw, Color color) {
+        drawBasicEnemy(draw, color);
+
+        // Bow held towards the target, drawn back while reloading
+        float dir = facingRight ? 1.0f : -1.0f;
+        float armY = position.y - size.y / 2 + 18;
+        Vec2 grip(position.x + dir * 12, armY);
+        float pull = attackCooldown > 0.8f ? 6.0f : 0.0f;
+
+        draw.color(110, 70, 30);
+        std::vector<SDL_FPoint> bow;
+        for (int i = 0; i <= 8; ++i) {
+            float a = -PI / 2.5f + (i / 8.0f) * (PI / 1.25f);
+            bow.push_back({ grip.x + dir * std::cos(a) * 8, grip.y + std::sin(a) * 16 });
+        }
+        draw.lines(bow);
+
+        draw.color(200, 200, 200);
+        Vec2 nock(grip.x - dir * pull, grip.y);
+        draw.line(bow.front().x, bow.front().y, nock.x, nock.y);
+        draw.line(nock.x, nock.y, bow.back().x, bow.back().y);
+    }
+
+    void drawBossEnemy(Draw& draw, Color color) {
+        SDL_Color c = color.toSDL();
+        draw.color(c.r, c.g, c.b, c.a);
+
+        float headY = position.y - size.y / 2 + 10;
+
+        // Samurai helmet
+        draw.fill_circle(position.x, headY, 8);
+        draw.color(150, 50, 50);
+        std::vector<SDL_FPoint> helmet = {
+            {position.x - 10, headY - 5},
+            {position.x + 10, headY - 5},
+            {position.x + 12, headY},
+            {position.x - 12, headY},
+            {position.x - 10, headY - 5}
+        };
+        draw.polygon(helmet);
+
+        // Armored body
+        draw.color(c.r, c.g, c.b, c.a);
+        std::vector<SDL_FPoint> armor = {
+            {position.x - 8, headY + 8},
+            {position.x + 8, headY + 8},
+            {position.x + 10, position.y},
+            {position.x - 10, position.y},
+            {position.x - 8, headY + 8}
+        };
+        draw.polygon(armor);
+
+        // Arms with katana
+        float armY = headY + 12;
+        if (attackHitbox.active) {
+            // Katana strike pose
+            float swordAngle = 0;
+            switch (attackPattern) {
+            case 0: swordAngle = facingRight ? PI / 4 : 3 * PI / 4; break;
+            case 1: swordAngle = facingRight ? -PI / 3 : -2 * PI / 3; break;
+            case 2: swordAngle = PI / 2; break;
+            }
+
+            Vec2 hand = Vec2(position.x, armY) + Vec2::fromAngle(swordAngle - PI / 2, 15);
+            draw.line(position.x, armY, hand.x, hand.y);
+
+            // Katana
+            Vec2 swordTip = hand + Vec2::fromAngle(swordAngle, 60);
+            draw.color(200, 200, 200);
+            for (int i = -1; i <= 1; i++) {
+                draw.line(hand.x + i, hand.y, swordTip.x + i, swordTip.y);
+            }
+
+            // Katana glow during attack
+            draw.color(255, 100, 100, 50);
+            for (int i = 1; i <= 3; i++) {
+                draw.line(hand.x, hand.y, swordTip.x, swordTip.y);
+            }
+        }
+        else {
+            // Idle pose
+            draw.color(c.r, c.g, c.b, c.a);
+            draw.line(position.x, armY, position.x - 10, armY + 12);
+            draw.line(position.x, armY, position.x + 10, armY + 12);
+        }
+
+        // Legs
+        draw.color(c.r, c.g, c.b, c.a);
+        float legY = position.y;
+        draw.line(position.x - 5, legY, position.x - 7, position.y + size.y / 2);
+        draw.line(position.x + 5, legY, position.x + 7, position.y + size.y / 2);
+    }
+};
+
+// ===== LEVEL =====
+// One-way platforms above the ground plane. Platforms live in a RectGrid so
+// collision and drawing only visit the cells near the query area, keeping the
+// cost independent of how wide the level is.
+class Level {
+private:
+    float width;
+    RectGrid platforms;
+
+public:
+    static constexpr float PLATFORM_THICKNESS = 12.0f;
+    static constexpr float TIER_HEIGHT = 110.0f;
+
+    Level() : width(WORLD_WIDTH) {}
+
+    void generate(float levelWidth) {
+        width = levelWidth;
+        platforms.reset({ 0, 0, width, GROUND_Y }, 256.0f);
+
+        float x = 150;
+        while (x < width - 150) {
+            float w = Utils::randomFloat(80, 220);
+            float y = GROUND_Y - Utils::randomInt(1, 3) * TIER_HEIGHT + Utils::randomFloat(-15, 15);
+            platforms.insert({ x, y, w, PLATFORM_THICKNESS });
+            x += w + Utils::randomFloat(60, 220);
+        }
+    }
+
+    // Land an entity on any platform top its feet crossed this step.
+    // Rising entities pass through from below.
+    void resolve(Entity& e) const {
+        if (e.velocity.y < 0) return;
+
+        float prevFeet = e.prevPosition.y + e.size.y / 2;
+        float feet = e.position.y + e.size.y / 2;
+        SDL_FRect sweep = { e.position.x - e.size.x / 2, std::min(prevFeet, feet) - 1,
+                            e.size.x, std::abs(feet - prevFeet) + 2 };
+
+        platforms.query(sweep, [&](int, const SDL_FRect& p) {
+            if (prevFeet <= p.y + 1 && feet >= p.y - 1) {
+                e.position.y = p.y - e.size.y / 2;
+                e.velocity.y = 0;
+                e.onGround = true;
+                e.hurtbox.position = e.position;
+                e.attackHitbox.position = e.position;
+            }
+            });
+    }
+
+    void draw(Draw& draw, const SDL_FRect& visible) const {
+        platforms.query(visible, [&draw](int, const SDL_FRect& p) {
+            draw.color(70, 70, 80);
+            draw.fill_rect(p.x, p.y, p.w, p.h);
+            draw.color(30, 30, 30);
+            draw.line(p.x, p.y, p.x + p.w, p.y);
+            });
+    }
+
+    float getWidth() const { return width; }
+    const RectGrid& getPlatforms() const { return platforms; }
+};
+
+// ===== GAME WORLD =====
+// Audible events of one update, for the front end to voice; the simulation
+// itself never touches audio
+enum class SoundCue : uint8_t { SLASH, HIT, HURT, DEFLECT };
+
+class GameWorld {
+private:
+    // Entities live packed in slot maps and refer to each other by handle;
+    // both maps keep their storage across waves and restarts.
+    SlotMap<Player> players;
+    Handle<Player> playerHandle;
+    SlotMap<Enemy> enemies;
+    ParticlePool worldParticles; // Also holds the spares enemies give back
+    ProjectileSystem projectiles;
+    std::vector<Handle<Enemy>> projectileTargets; // Target id - 1 -> enemy (0 is the player)
+    std::vector<ProjectileHit> projectileHits;
+    std::vector<uint32_t> activeEnemies; // Dense indices stepped this tick
+    std::vector<uint32_t> visibleEnemies; // Dense indices drawn this frame
+    DrawArena drawArena;
+    NavGraph nav;
+    FlowField flow; // Toward the player's surface
+    DecalLayer decals;
+    HudLayer hud;
+    std::unique_ptr<ThreadPool> workers; // Null: enemies step serially
+    InputManager input;
+    Scheduler scheduler;
+    Camera2D camera;
+    Level level;
+
+    GameState gameState;
+    int wave;
+    int enemiesKilled;
+    float waveTimer;
+    bool showingWaveText;
+    float waveTextTimer;
+
+    std::vector<SoundCue> soundCues; // This update's cues (see getSoundCues)
+    int heardAttacks;                // Player attack count already cued
+
+    // Cached HUD widgets (see drawUI)
+    enum HudWidget { HUD_SCORE, HUD_ABILITIES, HUD_CONTROLS };
+
+    // Cues kept per update; a huge melee does not need more voices than this
+    static constexpr size_t MAX_SOUND_CUES = 16;
+
+    // World particles this far outside the view are dropped
+    static constexpr float PARTICLE_CULL_MARGIN = 200.0f;
+
+    // Spare particles of each kind a new enemy starts with (one hit's worth)
+    static constexpr size_t ENEMY_PARTICLE_STOCK = 16;
+
+    // Enemies per parallel job; smaller steps run on the calling thread
+    static constexpr size_t ENEMIES_PER_JOB = 32;
+    static constexpr size_t ENEMIES_PER_DRAW_JOB = 16;
+
+    // The world always has exactly one live player
+    Player& player() { return *players.get(playerHandle); }
+
+public:
+    // inputSource: null for live SDL input, or a scripted/AI source for headless runs
+    explicit GameWorld(InputSource* inputSource = nullptr)
+        : input(inputSource), camera(SCREEN_WIDTH, SCREEN_HEIGHT),
+        gameState(GameState::PLAYING), wave(1), enemiesKilled(0), waveTimer(0),
+        showingWaveText(true), waveTextTimer(2.0f), heardAttacks(0) {
+
+        level.generate(WORLD_WIDTH);
+        nav.build(level.getPlatforms().getRects(), level.getWidth(), GROUND_Y);
+        decals.setBounds({ 0, 0, level.getWidth(), SCREEN_HEIGHT });
+        decals.setFadeRate(0.01f);
+        camera.setBounds({ 0, 0, level.getWidth(), SCREEN_HEIGHT });
+        projectiles.setBounds({ 0, -SCREEN_HEIGHT, level.getWidth(), GROUND_Y + SCREEN_HEIGHT });
+        projectiles.setGravity(ARROW_GRAVITY);
+        playerHandle = players.emplace(Vec2(SCREEN_WIDTH / 2, GROUND_Y - 30), &input);
+        camera.follow(player().position);
+        camera.snap();
+        setupSystems();
+        spawnWave();
+    }
+
+    void spawnWave() {
+        clearEnemies();
+        showingWaveText = true;
+        waveTextTimer = 2.0f;
+
+        int enemyCount = 2 + wave;
+
+        // Spawn within a screen of the player, inside the level
+        float minX = std::max(100.0f, player().position.x - SCREEN_WIDTH / 2 + 100);
+        float maxX = std::min(level.getWidth() - 100, player().position.x + SCREEN_WIDTH / 2 - 100);
+
+        for (int i = 0; i < enemyCount; ++i) {
+            float x = Utils::randomFloat(minX, maxX);
+            // Avoid spawning on player
+            while (std::abs(x - player().position.x) < 100) {
+                x = Utils::randomFloat(minX, maxX);
+            }
+
+            Vec2 spawnPos(x, GROUND_Y - 30);
+
+            // Spawn different enemy types based on wave
+            EnemyType type;
+            if (wave % 5 == 0) {
+                // Boss wave
+                type = EnemyType::BOSS_SAMURAI;
+            }
+            else if (wave > 3 && Utils::randomFloat(0, 1) < 0.3f) {
+                type = EnemyType::NINJA_ASSASSIN;
+            }
+            else if (wave > 1 && Utils::randomFloat(0, 1) < 0.3f) {
+                type = EnemyType::RANGED_ARCHER;
+            }
+            else if (wave > 2 && Utils::randomFloat(0, 1) < 0.4f) {
+                type = EnemyType::HEAVY_BRUTE;
+            }
+            else {
+                type = EnemyType::BASIC_GRUNT;
+            }
+
+            uint32_t seed = static_cast<uint32_t>(Utils::randomInt(1, 0x7FFFFFFF));
+            Handle<Enemy> enemy = enemies.emplace(spawnPos, type, playerHandle, seed);
+            worldParticles.lend(enemies.get(enemy)->particles, ENEMY_PARTICLE_STOCK);
+        }
+    }
+
+    // Enemy particles go back to the world's spares for the next wave
+    void clearEnemies() {
+        for (Enemy& enemy : enemies) worldParticles.reclaim(enemy.particles);
+        enemies.clear();
+    }
+
+    // Every system ticks once per fixed step of its own time domain; time slow
+    // only changes the domain scales, i.e. how many steps each one gets.
+    void setupSystems() {
+        scheduler.clear();
+
+        scheduler.add("input", TimeDomain::PLAYER, [this](float) {
+            input.update(scheduler.getClock().getTime(TimeDomain::PLAYER));
+            });
+        scheduler.add("player", TimeDomain::PLAYER, [this](float dt) {
+            player().update(dt);
+            level.resolve(player());
+            player().settleParticles(decals);
+            });
+        scheduler.add("enemies", TimeDomain::WORLD, [this](float dt) {
+            updateEnemies(dt);
+            });
+        scheduler.add("projectiles", TimeDomain::WORLD, [this](float dt) {
+            updateProjectiles(dt);
+            });
+        scheduler.add("combat", TimeDomain::WORLD, [this](float) {
+            updateCombat();
+            });
+        scheduler.add("effects", TimeDomain::EFFECTS, [this](float dt) {
+            player().updateEffects(dt);
+            updateWorldParticles(dt);
+            });
+        scheduler.add("abilities", TimeDomain::UI, [this](float dt) {
+            player().updateAbilities(dt);
+            });
+        scheduler.add("hud", TimeDomain::UI, [this](float dt) {
+            updateWaveText(dt);
+            });
+        scheduler.add("camera", TimeDomain::UI, [this](float dt) {
+            camera.follow(player().position);
+            camera.setZoom(player().isTimeSlowActive() ? 1.15f : 1.0f);
+            camera.update(dt);
+            input.setView(camera.getOrigin(), camera.getZoom());
+            });
+        scheduler.add("game_over", TimeDomain::UI, [this](float) {
+            if (!player().stats.isAlive()) {
+                gameState = GameState::GAME_OVER;
+                scheduler.stopFrame();
+            }
+            });
+    }
+
+    void update(float dt) {
+        soundCues.clear();
+        if (gameState != GameState::PLAYING) return;
+
+        GameClock& clock = scheduler.getClock();
+        clock.setScale(TimeDomain::WORLD, player().getTimeScale());
+        clock.setScale(TimeDomain::EFFECTS, player().getTimeScale());
+        clock.setScale(TimeDomain::PLAYER, player().getPlayerTimeScale());
+        clock.setScale(TimeDomain::UI, 1.0f);
+
+        scheduler.advance(dt);
+    }
+
+    void cue(SoundCue sound) {
+        if (soundCues.size() < MAX_SOUND_CUES) soundCues.push_back(sound);
+    }
+
+    void updateCombat() {
+        if (player().getAttackCount() != heardAttacks) {
+            heardAttacks = player().getAttackCount();
+            cue(SoundCue::SLASH);
+        }
+
+        // Handle combat collisions
+        handleCombat();
+
+        // Remove dead enemies
+        int killedThisFrame = static_cast<int>(
+            enemies.removeIf([this](Enemy& e) {
+                if (e.stats.isAlive()) return false;
+                worldParticles.reclaim(e.particles);
+                return true;
+                }));
+
+        enemiesKilled += killedThisFrame;
+
+        // Add screen shake for kills
+        if (killedThisFrame > 0) {
+            addCameraShake(5.0f * killedThisFrame);
+        }
+
+        // Check wave completion
+        if (enemies.empty() && !showingWaveText) {
+            wave++;
+            spawnWave();
+        }
+    }
+
+    void updateWaveText(float dt) {
+        if (showingWaveText) {
+            waveTextTimer -= dt;
+            if (waveTextTimer <= 0) {
+                showingWaveText = false;
+            }
+        }
+    }
+
+    void handleCombat() {
+        // Player attacks hitting enemies: the first enemy the blade reaches
+        // since the last test takes the hit
+        if (player().hasPendingAttack()) {
+            Enemy* struck = nullptr;
+            float first = 2.0f;
+            for (auto& enemy : enemies) {
+                float t = player().testAttack(enemy.hurtbox);
+                if (t >= 0 && t < first) {
+                    first = t;
+                    struck = &enemy;
+                }
+            }
+
+            if (struck) {
+                Enemy& enemy = *struck;
+                Vec2 knockback = (enemy.position - player().position).normalized() *
+                    player().attackHitbox.knockback;
+                knockback.y = -5; // Add upward component
+
+                enemy.takeDamage(player().attackHitbox.damage, knockback,
+                    player().attackHitbox.hitStun);
+
+                // Hit effects
+                createHitEffect(enemy.position);
+                addCameraShake(3.0f);
+                cue(SoundCue::HIT);
+
+                // Disable hitbox after hit (no multi-hit)
+                player().attackHitbox.active = false;
+            }
+        }
+        player().consumeSweep();
+
+        // Enemy attacks hitting player
+        for (auto& enemy : enemies) {
+            if (enemy.attackHitbox.active &&
+                enemy.attackHitbox.intersects(player().hurtbox)) {
+
+                Vec2 knockback = (player().position - enemy.position).normalized() *
+                    enemy.attackHitbox.knockback;
+                knockback.y = -3;
+
+                player().takeDamage(enemy.attackHitbox.damage, knockback,
+                    enemy.attackHitbox.hitStun);
+
+                createHitEffect(player().position);
+                addCameraShake(5.0f);
+                cue(SoundCue::HURT);
+
+                enemy.attackHitbox.active = false;
+            }
+        }
+    }
+
+    // threads <= 1 steps enemies on the calling thread. Results are the same
+    // for any thread count.
+    void setUpdateThreads(int threads) {
+        workers.reset();
+        if (threads > 1) workers = std::make_unique<ThreadPool>(threads);
+    }
+
+    int getUpdateThreads() const { return workers ? workers->size() : 1; }
+
+    // The field only changes when the player lands on a different surface;
+    // while airborne the last one stays valid
+    void updateFlow() {
+        const Player& p = player();
+        if (!p.onGround) return;
+        int cell = nav.locate(p.position + Vec2(0, p.size.y / 2));
+        if (cell >= 0 && cell != flow.getGoal()) flow.build(nav, cell);
+    }
+
+    // Two phases: every active enemy steps against a snapshot of the world
+    // (in parallel when workers exist), then their intents are committed
+    // one enemy at a time in storage order.
+    void updateEnemies(float dt) {
+        // Enemies well outside the view stay dormant until the camera nears
+        SDL_FRect active = camera.getVisibleRect(ACTIVE_MARGIN);
+        activeEnemies.clear();
+        for (size_t i = 0; i < enemies.size(); ++i) {
+            if (isInside(enemies[i].position, active)) {
+                activeEnemies.push_back(static_cast<uint32_t>(i));
+            }
+        }
+
+        updateFlow();
+        EnemySnapshot snapshot{ playerHandle, player().position, &nav, &flow };
+
+        size_t count = activeEnemies.size();
+        if (workers && count > ENEMIES_PER_JOB) {
+            for (size_t begin = 0; begin < count; begin += ENEMIES_PER_JOB) {
+                size_t end = std::min(count, begin + ENEMIES_PER_JOB);
+                workers->submit([this, &snapshot, begin, end, dt]() {
+                    for (size_t i = begin; i < end; ++i) {
+                        enemies[activeEnemies[i]].update(dt, snapshot);
+                    }
+                    });
+            }
+            workers->waitIdle();
+        }
+        else {
+            for (uint32_t i : activeEnemies) {
+                enemies[i].update(dt, snapshot);
+            }
+        }
+
+        Vec2 origin, velocity;
+        for (uint32_t i : activeEnemies) {
+            Enemy& enemy = enemies[i];
+            level.resolve(enemy);
+            enemy.settleParticles(decals);
+            enemy.spawnPendingEffects();
+            if (enemy.takeShot(origin, velocity)) {
+                projectiles.spawn(origin, velocity, enemy.getArrowDamage(), ProjectileTeam::ENEMY);
+            }
+        }
+    }
+
+    // Deflect first so arrows turned this step already fly back; then one
+    // swept pass against every hurtbox in range
+    void updateProjectiles(float dt) {
+        if (player().isDeflecting()) {
+            int deflected = projectiles.deflect(player().position, DEFLECT_REACH,
+                player().getFacingAngle(), DEFLECT_HALF_ARC, ProjectileTeam::PLAYER);
+            if (deflected > 0) {
+                addCameraShake(std::min(8.0f, 1.0f + deflected));
+                cue(SoundCue::DEFLECT);
+            }
+        }
+
+        projectiles.clearTargets();
+        projectileTargets.clear();
+        projectiles.addTarget(player().hurtbox.getRect(), ProjectileTeam::PLAYER);
+        for (auto& enemy : enemies) {
+            projectiles.addTarget(enemy.hurtbox.getRect(), ProjectileTeam::ENEMY);
+            projectileTargets.push_back(enemies.handleAt(projectileTargets.size()));
+        }
+
+        projectileHits.clear();
+        projectiles.update(dt, projectileHits);
+
+        for (const ProjectileHit& hit : projectileHits) {
+            Entity* victim = nullptr;
+            if (hit.target == 0) victim = &player();
+            else victim = enemies.get(projectileTargets[hit.target - 1]);
+            if (!victim) continue;
+
+            Vec2 knockback = hit.velocity.normalized() * 4.0f;
+            knockback.y = -2;
+            victim->takeDamage(hit.damage, knockback, 8);
+            createHitEffect(hit.position);
+            cue(hit.target == 0 ? SoundCue::HURT : SoundCue::HIT);
+        }
+    }
+
+    void createHitEffect(Vec2 pos) {
+        // Sparks
+        for (int i = 0; i < 8; ++i) {
+            float angle = Utils::randomFloat(0, TWO_PI);
+            Vec2 vel = Vec2::fromAngle(angle, Utils::randomFloat(3, 8));
+            worldParticles.spawn<SparkParticle>(pos, vel);
+        }
+
+        // Impact ring
+        for (int i = 0; i < 16; ++i) {
+            float angle = (i / 16.0f) * TWO_PI;
+            Vec2 vel = Vec2::fromAngle(angle, 4);
+            Particle* particle = worldParticles.spawn<Particle>(pos, vel,
+                Color(255, 255, 255), 0.3f, 2.0f);
+            particle->gravity = false;
+        }
+    }
+
+    void addCameraShake(float intensity) {
+        camera.addShake(intensity);
+    }
+
+    static bool isInside(const Vec2& p, const SDL_FRect& r) {
+        return p.x >= r.x && p.x <= r.x + r.w && p.y >= r.y && p.y <= r.y + r.h;
+    }
+
+    void updateWorldParticles(float dt) {
+        // Effects are purely visual, so ones that leave the view are dropped
+        SDL_FRect keep = camera.getVisibleRect(PARTICLE_CULL_MARGIN);
+        worldParticles.removeIf([this, &keep](const Particle& p) {
+            if (p.isResting()) p.stampDecal(decals);
+            return !p.isAlive() || p.isResting() || !isInside(p.position, keep);
+            });
+        decals.update(dt);
+
+        for (auto& particle : worldParticles) {
+            particle->update(dt);
+        }
+    }
+
+    void draw(Draw& draw, SDL_Renderer* renderer) {
+        // Background is screen space (parallax handled inside)
+        draw.reset_view();
+        drawBackground(draw);
+
+        // Everything else in world space through the camera
+        camera.apply(draw);
+        SDL_FRect visible = camera.getVisibleRect();
+
+        // Draw ground (only the visible span)
+        draw.color(50, 50, 50);
+        draw.fill_rect(visible.x, GROUND_Y, visible.w, visible.y + visible.h - GROUND_Y);
+        draw.color(30, 30, 30);
+        draw.line(visible.x, GROUND_Y, visible.x + visible.w, GROUND_Y);
+
+        decals.draw(draw, visible);
+        level.draw(draw, visible);
+        projectiles.draw(draw, visible);
+
+        // Draw world particles
+        for (auto& particle : worldParticles) {
+            if (isInside(particle->position, visible)) {
+                particle->draw(draw);
+            }
+        }
+
+        // Draw entities
+        drawEnemies(draw);
+        player().draw(draw);
+
+        // Draw UI
+        draw.reset_view();
+        drawUI(draw, renderer);
+
+        // Draw wave text
+        if (showingWaveText) {
+            drawWaveText(draw, renderer);
+        }
+
+        // Draw game over screen
+        if (gameState == GameState::GAME_OVER) {
+            drawGameOver(draw, renderer);
+        }
+    }
+
+    // With workers, groups of enemies record their vertices in parallel and
+    // are submitted in storage order, as the serial loop would draw them
+    void drawEnemies(Draw& draw) {
+        visibleEnemies.clear();
+        for (size_t i = 0; i < enemies.size(); ++i) {
+            if (camera.isVisible(enemies[i].getDrawBounds())) {
+                visibleEnemies.push_back(static_cast<uint32_t>(i));
+            }
+        }
+
+        size_t count = visibleEnemies.size();
+        if (!workers || count <= ENEMIES_PER_DRAW_JOB) {
+            for (uint32_t i : visibleEnemies) {
+                enemies[i].draw(draw);
+            }
+            return;
+        }
+
+        size_t jobs = (count + ENEMIES_PER_DRAW_JOB - 1) / ENEMIES_PER_DRAW_JOB;
+        drawArena.record(workers.get(), draw, jobs, [this, count](size_t job, Draw& recorder) {
+            size_t end = std::min(count, (job + 1) * ENEMIES_PER_DRAW_JOB);
+            for (size_t i = job * ENEMIES_PER_DRAW_JOB; i < end; ++i) {
+                enemies[visibleEnemies[i]].draw(recorder);
+            }
+            });
+        drawArena.submit(draw);
+    }
+
+    void drawBackground(Draw& draw) {
+        // Gradient background, in bands as tall as the quality tier allows
+        int band = Quality::get().gradientBand;
+        for (int y = 0; y < SCREEN_HEIGHT; y += band) {
+            float t = y / (float)SCREEN_HEIGHT;
+            int r = 20 + t * 30;
+            int g = 20 + t * 30;
+            int b = 30 + t * 40;
+
+            // Add time slow effect
+            if (player().isTimeSlowActive()) {
+                b += 30;
+                g += 10;
+            }
+
+            draw.color(r, g, b);
+            draw.fill_rect(0, y, SCREEN_WIDTH, band);
+        }
+
+        // Background particles
+        static std::vector<Vec2> bgParticles;
+        static bool initialized = false;
+        if (!initialized) {
+            for (int i = 0; i < 50; ++i) {
+                bgParticles.push_back(Vec2(Utils::randomFloat(0, SCREEN_WIDTH),
+                    Utils::randomFloat(0, GROUND_Y)));
+            }
+            initialized = true;
+        }
+
+        // Draw and update background particles, scrolled for parallax
+        float parallax = camera.getOrigin().x * 0.3f;
+        for (auto& p : bgParticles) {
+            p.x += 0.5f;
+            if (p.x > SCREEN_WIDTH) p.x = 0;
+
+            float x = std::fmod(p.x - parallax, (float)SCREEN_WIDTH);
+            if (x < 0) x += SCREEN_WIDTH;
+
+            draw.color(100, 100, 100, 50);
+            draw.fill_circle(x, p.y, 2);
+        }
+    }
+
+    // Screen-space HUD, repainted per widget only when its values change
+    void drawUI(Draw& draw, SDL_Renderer* renderer) {
+        hud.begin(draw, SCREEN_WIDTH, SCREEN_HEIGHT);
+
+        // Wave and score
+        int combo = player().getCombo();
+        hud.widget(draw, HUD_SCORE, { 10, 10, 150, 80 },
+            HudKey().add(wave).add(enemiesKilled).add(combo), [&](Draw& d) {
+                d.color(0, 0, 0, 180);
+                d.fill_rect(10, 10, 150, 80);
+                d.color(255, 255, 255);
+                d.rect(10, 10, 150, 80);
+
+                std::string waveText = "Wave: " + std::to_string(wave);
+                std::string killText = "Kills: " + std::to_string(enemiesKilled);
+                std::string comboText = "Combo: " + std::to_string(combo) + "x";
+                SDL_RenderDebugText(renderer, 20, 22, waveText.c_str());
+                SDL_RenderDebugText(renderer, 20, 44, killText.c_str());
+                SDL_RenderDebugText(renderer, 20, 66, comboText.c_str());
+            });
+
+        HudKey cooldowns;
+        player().addCooldownKey(cooldowns);
+        hud.widget(draw, HUD_ABILITIES, { 20, SCREEN_HEIGHT - 100.0f, 150, 40 }, cooldowns,
+            [&](Draw& d) { player().drawAbilityCooldowns(d); });
+
+        // Controls hint
+        static const char* controls[] = {
+            "WASD: Move",
+            "Space: Jump",
+            "LMB: Attack (draw slash)",
+            "RMB: Block",
+            "Shift: Dash",
+            "Q: Time Slow",
+            "E: Shockwave",
+            "R: Teleport",
+            "F: Deflect arrows"
+        };
+
+        hud.widget(draw, HUD_CONTROLS, { SCREEN_WIDTH - 220.0f, SCREEN_HEIGHT - 150.0f, 210, 140 },
+            HudKey(), [&](Draw& d) {
+                d.color(255, 255, 255, 100);
+                int yOffset = SCREEN_HEIGHT - 150;
+                for (const char* control : controls) {
+                    SDL_RenderDebugText(renderer, SCREEN_WIDTH - 215.0f, static_cast<float>(yOffset), control);
+                    yOffset += 15;
+                }
+            });
+
+        hud.end(draw);
+    }
+
+    void drawWaveText(Draw& draw, SDL_Renderer* renderer) {
+        float alpha = std::min(1.0f, waveTextTimer);
+
+        // Background fade
+        draw.color(0, 0, 0, 100 * alpha);
+        draw.fill_rect(0, SCREEN_HEIGHT / 2 - 50, SCREEN_WIDTH, 100);
+
+        // Wave text
+        std::string text = "WAVE " + std::to_string(wave);
+        if (wave % 5 == 0) {
+            text += " - BOSS";
+        }
+
+        // Would render large text here
+        draw.color(255, 255, 255, 255 * alpha);
+        float textX = SCREEN_WIDTH / 2 - text.length() * 10;
+        float textY = SCREEN_HEIGHT / 2;
+
+        // Simple text visualization
+        for (char c : text) {
+            draw.fill_rect(textX, textY, 15, 20);
+            textX += 20;
+        }
+    }
+
+    void drawGameOver(Draw& draw, SDL_Renderer* renderer) {
+        // Dark overlay
+        draw.color(0, 0, 0, 200);
+        draw.fill_rect(0, 0, SCREEN_WIDTH, SCREEN_HEIGHT);
+
+        // Game over text
+        draw.color(255, 0, 0);
+        std::string gameOverText = "GAME OVER";
+        float textX = SCREEN_WIDTH / 2 - gameOverText.length() * 15;
+        float textY = SCREEN_HEIGHT / 2 - 50;
+
+        for (char c : gameOverText) {
+            draw.fill_rect(textX, textY, 25, 35);
+            textX += 30;
+        }
+
+        // Stats
+        draw.color(255, 255, 255);
+        std::string statsText = "Waves Survived: " + std::to_string(wave) +
+            "  Enemies Killed: " + std::to_string(enemiesKilled);
+        // Would render stats text
+
+        // Restart prompt
+        std::string restartText = "Press R to Restart";
+        // Would render restart text
+    }
+
+    void restart() {
+        // Old handles (e.g. enemy targets) go stale rather than dangling
+        worldParticles.reclaim(player().particles);
+        players.clear();
+        playerHandle = players.emplace(Vec2(SCREEN_WIDTH / 2, GROUND_Y - 30), &input);
+        heardAttacks = 0;
+        camera.follow(player().position);
+        camera.snap();
+        clearEnemies();
+        worldParticles.clear();
+        projectiles.clear();
+        decals.clear();
+        wave = 1;
+        enemiesKilled = 0;
+        scheduler.getClock().reset();
+        gameState = GameState::PLAYING;
+        spawnWave();
+    }
+
+    bool isGameOver() const { return gameState == GameState::GAME_OVER; }
+    InputManager& getInput() { return input; }
+
+    // Read-only access for headless runners and AI input
+    GameState getState() const { return gameState; }
+    int getWave() const { return wave; }
+    int getEnemiesKilled() const { return enemiesKilled; }
+    float getSimTime() const { return scheduler.getClock().getTime(TimeDomain::UI); }
+    const Player& getPlayer() const { return *players.get(playerHandle); }
+    const Camera2D& getCamera() const { return camera; }
+    const Level& getLevel() const { return level; }
+    const SlotMap<Enemy>& getEnemies() const { return enemies; }
+    const ProjectileSystem& getProjectiles() const { return projectiles; }
+    const NavGraph& getNav() const { return nav; }
+    const FlowField& getFlow() const { return flow; }
+    const DecalLayer& getDecals() const { return decals; }
+    const std::vector<SoundCue>& getSoundCues() const { return soundCues; }
+
+    size_t getParticleCount() const {
+        size_t count = worldParticles.size() + players.get(playerHandle)->particles.size();
+        for (const Enemy& enemy : enemies) count += enemy.particles.size();
+        return count;
+    }
+};
+
@@ -0,0 +1,781 @@
+// microbench.cpp - Microbenchmarks for Utils, Vec2, Color, combat queries and Draw primitives
+// Each benchmark is calibrated so one sample takes at least --min-ms, then
+// timed for --samples samples. Reported: mean ns/op with a 95% confidence
+// interval (Student's t), standard deviation, median and fastest sample.
+// Draw benchmarks run against an offscreen software renderer, which is
+// flushed inside every sample so rasterisation is included, and also report
+// the DrawStats of a single call.
+// --compact-error N runs no benchmarks; it steps N full and compact
+// particles side by side and prints the largest differences per kernel.
+//
+// Usage: microbench [--filter text] [--samples N] [--min-ms X] [--csv] [--compact-error N]
+#include <SDL3/SDL.h>
+#include <SDL3/SDL_main.h>
+#include <vector>
+#include <string>
+#include <functional>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <cstdlib>
+#include <cmath>
+#include <thread>
+#include "utils.cpp"
+#include "renderer2d.cpp"
+#include "projectile_system.cpp"
+#include "sword_sweep.cpp"
+#include "navigation.cpp"
+#include "sph_fluid.cpp"
+#include "synth.cpp"
+#include "particle_system.cpp"
+
+// ===== HARNESS =====
+// Keeps a computed value alive so the optimiser cannot drop the work
+template <typename T>
+static inline void keep(const T& value) {
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "r"(&value) : "memory");
+#else
+    static const void* volatile sink;
+    sink = &value;
+#endif
+}
+
+struct BenchResult {
+    std::string name;
+    int samples = 0;
+    Uint64 iterations = 0; // Per sample
+    double mean = 0, stddev = 0, ci95 = 0, median = 0, fastest = 0; // ns per op
+    bool hasDrawStats = false;
+    DrawStats perCall;
+};
+
+// Two-sided 95% critical values of Student's t for 1..30 degrees of freedom
+static double tCritical95(int df) {
+    static const double table[] = {
+        12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+        2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+        2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042
+    };
+    if (df < 1) return 0.0;
+    if (df <= 30) return table[df - 1];
+    return 1.96;
+}
+
+class MicroBench {
+public:
+    using Body = std::function<void(Uint64 iterations)>;
+
+    int samples = 20;
+    double minSampleMs = 5.0;
+    std::string filter;
+
+private:
+    struct Case {
+        std::string name;
+        Body body;
+        Draw* draw; // Non-null for Draw benchmarks
+    };
+
+    std::vector<Case> cases;
+    double nsPerTick = 1e9 / static_cast<double>(SDL_GetPerformanceFrequency());
+
+    double timeNs(const Case& c, Uint64 iterations) const {
+        Uint64 start = SDL_GetPerformanceCounter();
+        c.body(iterations);
+        if (c.draw) SDL_FlushRenderer(c.draw->renderer);
+        return (SDL_GetPerformanceCounter() - start) * nsPerTick;
+    }
+
+    BenchResult run(const Case& c) const {
+        BenchResult r;
+        r.name = c.name;
+        r.samples = samples;
+
+        // Calibrate: double the batch until one sample reaches minSampleMs
+        // (this also serves as the warmup)
+        Uint64 iterations = 1;
+        while (timeNs(c, iterations) < minSampleMs * 1e6 && iterations < (1ull << 32)) {
+            iterations *= 2;
+        }
+        r.iterations = iterations;
+
+        std::vector<double> perOp(samples);
+        for (int s = 0; s < samples; ++s) {
+            perOp[s] = timeNs(c, iterations) / iterations;
+        }
+
+        double sum = 0;
+        for (double v : perOp) sum += v;
+        r.mean = sum / samples;
+
+        double var = 0;
+        for (double v : perOp) var += (v - r.mean) * (v - r.mean);
+        r.stddev = samples > 1 ? std::sqrt(var / (samples - 1)) : 0.0;
+        r.ci95 = tCritical95(samples - 1) * r.stddev / std::sqrt(static_cast<double>(samples));
+
+        std::sort(perOp.begin(), perOp.end());
+        r.median = samples % 2 ? perOp[samples / 2] : 0.5 * (perOp[samples / 2 - 1] + perOp[samples / 2]);
+        r.fastest = perOp.front();
+
+        if (c.draw) {
+            c.draw->end_frame();
+            c.body(1);
+            c.draw->end_frame();
+            r.perCall = c.draw->frame_stats();
+            r.hasDrawStats = true;
+        }
+        return r;
+    }
+
+public:
+    void add(const std::string& name, Body body, Draw* draw = nullptr) {
+        cases.push_back({ name, std::move(body), draw });
+    }
+
+    std::vector<BenchResult> runAll(bool csv) const {
+        std::vector<BenchResult> results;
+        if (csv) {
+            std::printf("name,samples,iterations,mean_ns,ci95_ns,stddev_ns,median_ns,min_ns,"
+                "sdl_calls,vertices,pixels\n");
+        }
+        else {
+            std::printf("%-28s %12s %10s %7s %10s %10s %10s  %s\n",
+                "benchmark", "ns/op", "+-95%", "", "stddev", "median", "min", "per call");
+        }
+
+        for (const Case& c : cases) {
+            if (!filter.empty() && c.name.find(filter) == std::string::npos) continue;
+            BenchResult r = run(c);
+            print(r, csv);
+            results.push_back(r);
+        }
+        return results;
+    }
+
+    static void print(const BenchResult& r, bool csv) {
+        if (csv) {
+            std::printf("%s,%d,%llu,%.3f,%.3f,%.3f,%.3f,%.3f,%llu,%llu,%.0f\n",
+                r.name.c_str(), r.samples, (unsigned long long)r.iterations,
+                r.mean, r.ci95, r.stddev, r.median, r.fastest,
+                (unsigned long long)r.perCall.sdl_calls,
+                (unsigned long long)r.perCall.vertices, r.perCall.pixels);
+            return;
+        }
+
+        double pct = r.mean > 0 ? 100.0 * r.ci95 / r.mean : 0.0;
+        std::printf("%-28s %12.2f %10.2f (%4.1f%%) %10.2f %10.2f %10.2f",
+            r.name.c_str(), r.mean, r.ci95, pct, r.stddev, r.median, r.fastest);
+        if (r.hasDrawStats) {
+            std::printf("  sdl %llu  verts %llu  px %.0f",
+                (unsigned long long)r.perCall.sdl_calls,
+                (unsigned long long)r.perCall.vertices, r.perCall.pixels);
+        }
+        std::printf("\n");
+    }
+};
+
+// ===== UTILS / VEC2 / COLOR =====
+// Inputs advance with the loop counter so nothing is folded to a constant
+static void addMathBenchmarks(MicroBench& bench) {
+    bench.add("noise/perlin", [](Uint64 n) {
+        float acc = 0;
+        for (Uint64 i = 0; i < n; ++i) acc += Utils::perlinNoise(i * 0.37f, i * 0.11f);
+        keep(acc);
+        });
+    bench.add("noise/simplex", [](Uint64 n) {
+        float acc = 0;
+        for (Uint64 i = 0; i < n; ++i) acc += Utils::simplexNoise(i * 0.37f, i * 0.11f, i * 0.05f);
+        keep(acc);
+        });
+    bench.add("noise/voronoi", [](Uint64 n) {
+        float acc = 0;
+        for (Uint64 i = 0; i < n; ++i) acc += Utils::voronoiNoise(i * 0.37f, i * 0.11f);
+        keep(acc);
+        });
+    bench.add("noise/turbulence4", [](Uint64 n) {
+        float acc = 0;
+        for (Uint64 i = 0; i < n; ++i) acc += Utils::turbulence(i * 0.37f, i * 0.11f, 4);
+        keep(acc);
+        });
+
+    struct Easing { const char* name; float (*fn)(float); };
+    static const Easing easings[] = {
+        { "quad", Utils::easeInOutQuad }, { "cubic", Utils::easeInOutCubic },
+        { "quart", Utils::easeInOutQuart }, { "quint", Utils::easeInOutQuint },
+        { "sine", Utils::easeInOutSine }, { "expo", Utils::easeInOutExpo },
+        { "circ", Utils::easeInOutCirc }, { "elastic", Utils::easeInOutElastic },
+        { "back", Utils::easeInOutBack }, { "bounce", Utils::easeInOutBounce },
+    };
+    for (const Easing& e : easings) {
+        auto fn = e.fn;
+        bench.add(std::string("ease/") + e.name, [fn](Uint64 n) {
+            float acc = 0;
+            for (Uint64 i = 0; i < n; ++i) acc += fn((i & 1023) * (1.0f / 1023.0f));
+            keep(acc);
+            });
+    }
+
+    bench.add("shape/star", [](Uint64 n) {
+        for (Uint64 i = 0; i < n; ++i) keep(Utils::generateStarPoints(5, 10.0f, 25.0f));
+        });
+    bench.add("shape/polygon", [](Uint64 n) {
+        for (Uint64 i = 0; i < n; ++i) keep(Utils::generatePolygonPoints(8, 20.0f));
+        });
+    bench.add("shape/heart", [](Uint64 n) {
+        for (Uint64 i = 0; i < n; ++i) keep(Utils::generateHeartPoints(20.0f));
+        });
+    bench.add("shape/spiral", [](Uint64 n) {
+        for (Uint64 i = 0; i < n; ++i) keep(Utils::generateSpiralPoints(30.0f, 3));
+        });
+    bench.add("shape/gear", [](Uint64 n) {
+        for (Uint64 i = 0; i < n; ++i) keep(Utils::generateGearPoints(12, 15.0f, 20.0f));
+        });
+    bench.add("shape/lightning", [](Uint64 n) {
+        for (Uint64 i = 0; i < n; ++i) keep(Utils::generateLightningPoints(Vec2(0, 0), Vec2(200, 150), 8));
+        });
+    bench.add("shape/cloud", [](Uint64 n) {
+        for (Uint64 i = 0; i < n; ++i) keep(Utils::generateCloudPoints(60.0f, 30.0f));
+        });
+
+    bench.add("color/hsv", [](Uint64 n) {
+        float acc = 0;
+        for (Uint64 i = 0; i < n; ++i) acc += Color::hsv(static_cast<float>(i % 360), 0.8f, 0.9f).g;
+        keep(acc);
+        });
+    bench.add("color/toSDL", [](Uint64 n) {
+        unsigned acc = 0;
+        for (Uint64 i = 0; i < n; ++i) {
+            float f = (i & 255) * (1.2f / 255.0f);
+            acc += Color(f, 1.0f - f, 0.5f, 1.0f).toSDL().r;
+        }
+        keep(acc);
+        });
+
+    bench.add("vec2/normalized", [](Uint64 n) {
+        Vec2 acc;
+        for (Uint64 i = 0; i < n; ++i) acc += Vec2(i * 0.5f + 1.0f, 3.0f).normalized();
+        keep(acc);
+        });
+    bench.add("vec2/rotate", [](Uint64 n) {
+        Vec2 acc;
+        for (Uint64 i = 0; i < n; ++i) acc += Vec2(1.0f, 2.0f).rotate(i * 0.01f);
+        keep(acc);
+        });
+    bench.add("vec2/lerp+dot", [](Uint64 n) {
+        float acc = 0;
+        Vec2 a(1.0f, 2.0f), b(5.0f, -3.0f);
+        for (Uint64 i = 0; i < n; ++i) {
+            Vec2 p = Vec2::lerp(a, b, (i & 255) * (1.0f / 255.0f));
+            acc += p.dot(b) + p.cross(a);
+        }
+        keep(acc);
+        });
+    bench.add("vec2/fromAngle", [](Uint64 n) {
+        Vec2 acc;
+        for (Uint64 i = 0; i < n; ++i) acc += Vec2::fromAngle(i * 0.01f, 2.0f);
+        keep(acc);
+        });
+
+    // Draw's bulk vertex transform (SSE2 where available) against Vec2::rotate
+    static std::vector<SDL_FPoint> verts(1024), out(1024);
+    for (size_t i = 0; i < verts.size(); ++i) verts[i] = { (i % 32) * 3.0f, (i / 32) * 2.0f };
+    bench.add("transform/apply1k", [](Uint64 n) {
+        Transform2D t = Transform2D::view(120.0f, 40.0f, 1.5f);
+        for (Uint64 i = 0; i < n; ++i) {
+            (t * Transform2D::rotation(i * 0.01f)).apply(verts.data(), out.data(), 1024);
+        }
+        keep(out[1023]);
+        });
+    bench.add("transform/rotate1k", [](Uint64 n) {
+        for (Uint64 i = 0; i < n; ++i) {
+            for (size_t k = 0; k < verts.size(); ++k) {
+                Vec2 p = Vec2(verts[k].x, verts[k].y).rotate(i * 0.01f);
+                out[k] = { (p.x - 120.0f) * 1.5f, (p.y - 40.0f) * 1.5f };
+            }
+        }
+        keep(out[1023]);
+        });
+}
+
+// ===== PROJECTILES =====
+// A dense volley crossing a row of hurtboxes; refilled whenever it drains
+static void addProjectileBenchmarks(MicroBench& bench) {
+    static ProjectileSystem system(8192);
+    static std::vector<ProjectileHit> hits;
+
+    auto refill = []() {
+        system.clear();
+        system.setBounds({ 0, -720, 10240, 1320 });
+        system.setGravity(0.125f);
+        for (int i = 0; i < 4096; ++i) {
+            system.spawn(Vec2(200.0f + (i % 512) * 18.0f, 100.0f + (i / 512) * 40.0f),
+                Vec2(i % 2 ? 14.0f : -14.0f, -2.0f), 5.0f, ProjectileTeam::ENEMY, 1e9f);
+        }
+        system.clearTargets();
+        for (int t = 0; t < 64; ++t) {
+            system.addTarget({ 100.0f + t * 150.0f, 500.0f, 30.0f, 60.0f }, ProjectileTeam::PLAYER);
+        }
+    };
+
+    bench.add("projectiles/update4096", [refill](Uint64 n) {
+        for (Uint64 i = 0; i < n; ++i) {
+            if (system.size() < 2048) refill();
+            hits.clear();
+            system.update(1.0f / 60.0f, hits);
+        }
+        keep(hits);
+        });
+    bench.add("projectiles/deflect4096", [refill](Uint64 n) {
+        refill();
+        int total = 0;
+        for (Uint64 i = 0; i < n; ++i) {
+            ProjectileTeam side = i % 2 ? ProjectileTeam::ENEMY : ProjectileTeam::PLAYER;
+            total += system.deflect(Vec2(2000.0f, 200.0f), 400.0f, PI, 1.3f, side, 1.0f);
+        }
+        keep(total);
+        });
+}
+
+// ===== SWORD SWEEP =====
+static void addSweepBenchmarks(MicroBench& bench) {
+    static std::vector<SDL_FRect> boxes;
+    boxes.clear();
+    for (int i = 0; i < 256; ++i) {
+        boxes.push_back({ 300.0f + (i % 16) * 12.0f, 450.0f + (i / 16) * 12.0f, 25.0f, 50.0f });
+    }
+
+    bench.add("sweep/build135deg", [](Uint64 n) {
+        SwordSweep sweep;
+        for (Uint64 i = 0; i < n; ++i) {
+            sweep.build(Vec2(400, 550), -1.3f, Vec2(400 + (i & 15), 550), 1.05f, 6.0f, 80.0f);
+        }
+        keep(sweep);
+        });
+    bench.add("sweep/test256", [](Uint64 n) {
+        SwordSweep sweep;
+        sweep.build(Vec2(400, 550), -1.3f, Vec2(425, 550), 1.05f, 6.0f, 80.0f);
+        int hits = 0;
+        for (Uint64 i = 0; i < n; ++i) {
+            for (const SDL_FRect& box : boxes) hits += sweep.test(box) >= 0;
+        }
+        keep(hits);
+        });
+}
+
+// ===== NAVIGATION =====
+// Level-sized graph: 80 ground segments and a row of platforms on three tiers
+static void addNavBenchmarks(MicroBench& bench) {
+    static NavGraph nav;
+    std::vector<SDL_FRect> platforms;
+    for (float x = 150; x < 10000; x += 280) {
+        int tier = 1 + static_cast<int>(x / 280) % 3;
+        platforms.push_back({ x, 600.0f - tier * 110.0f, 150.0f, 12.0f });
+    }
+    nav.build(platforms, 10240, 600);
+
+    bench.add("nav/flowBuild", [](Uint64 n) {
+        FlowField flow;
+        for (Uint64 i = 0; i < n; ++i) {
+            flow.build(nav, static_cast<int>(i % nav.getNodeCount()));
+        }
+        keep(flow);
+        });
+    bench.add("nav/locate256", [](Uint64 n) {
+        int found = 0;
+        for (Uint64 i = 0; i < n; ++i) {
+            for (int k = 0; k < 256; ++k) {
+                found += nav.locate(Vec2(k * 40.0f, (k & 1) ? 600.0f : 490.0f)) >= 0;
+            }
+        }
+        keep(found);
+        });
+}
+
+// ===== SPH LIQUID =====
+// Single-threaded so results compare across machines; the block settles
+// within the first few samples, later ones measure a resting pool
+static void addSphBenchmarks(MicroBench& bench) {
+    bench.add("sph/step4k", [](Uint64 n) {
+        static SphFluid fluid(8192);
+        if (fluid.size() == 0) {
+            fluid.setBounds({ 0, 0, 600, 800 });
+            fluid.addSolid({ 0, 600, 600, 20 });
+            fluid.addSolid({ 0, 200, 10, 400 });
+            fluid.addSolid({ 590, 200, 10, 400 });
+            for (int i = 0; i < 4000; ++i) {
+                fluid.spawn(Vec2(20.0f + (i % 80) * 5.0f, 595.0f - (i / 80) * 5.0f), Vec2(0, 0));
+            }
+        }
+        for (Uint64 i = 0; i < n; ++i) fluid.update(1.0f / 60.0f);
+        keep(fluid.size());
+        });
+}
+
+// One 1024-sample callback with all sixteen voices busy (no audio device)
+static void addSynthBenchmarks(MicroBench& bench) {
+    bench.add("synth/render1024x16", [](Uint64 n) {
+        static Synth synth;
+        static float out[1024];
+        for (Uint64 i = 0; i < n; ++i) {
+            if (synth.getActiveVoices() < Synth::MAX_VOICES) {
+                for (int v = 0; v < Synth::MAX_VOICES; ++v) synth.play(SynthPresets::fireball());
+            }
+            synth.render(out, 1024);
+        }
+        keep(out[0]);
+        });
+}
+
+// One 60 Hz step of a 100k snow emitter: full Particles vs compact storage
+static ParticleEmitter& snowEmitter(bool compact) {
+    static ParticleEmitter emitters[2];
+    ParticleEmitter& e = emitters[compact ? 1 : 0];
+    if (e.getParticleCount() == 0) {
+        e.maxParticles = 100000;
+        e.compact = compact;
+        if (!compact) e.init(); // Pool for the full count
+        e.active = false;
+        e.pattern = EmissionPattern::BOX;
+        e.patternRadius = 600;
+        e.lifetimeRange = { 1000.0f, 2000.0f }; // Nothing dies while measuring
+        e.speedRange = { 30.0f, 60.0f };
+        e.gravity = { 0, 30 };
+        e.wind = { 20, 0 };
+        e.behaviors.push_back(ParticleBehavior::WANDER);
+        e.emit(100000);
+    }
+    return e;
+}
+
+// Eight 2k-particle emitters recorded through a DrawArena in 512-particle
+// jobs (as the testbed does), without submitting: vertex generation only
+struct RecordJob {
+    size_t emitter, begin, end;
+};
+
+static void recordEmitters(ThreadPool* pool) {
+    static std::vector<std::unique_ptr<ParticleEmitter>> emitters;
+    static std::vector<RecordJob> jobs;
+    static DrawArena arena;
+    static Draw from;
+    if (emitters.empty()) {
+        for (int i = 0; i < 8; ++i) {
+            auto e = std::make_unique<ParticleEmitter>();
+            e->active = false;
+            e->position = { 160.0f * i + 80, 360 };
+            e->pattern = EmissionPattern::CIRCLE;
+            e->patternRadius = 150;
+            e->lifetimeRange = { 1000.0f, 2000.0f };
+            e->shape = i % 2 ? ParticleShape::STAR : ParticleShape::CIRCLE;
+            e->emit(2000);
+            e->update(1.0f / 60.0f);
+            e->sortForDraw();
+            for (size_t begin = 0; begin < e->getParticleCount(); begin += 512) {
+                jobs.push_back({ emitters.size(), begin, std::min(e->getParticleCount(), begin + 512) });
+            }
+            emitters.push_back(std::move(e));
+        }
+    }
+    arena.record(pool, from, jobs.size(), [](size_t i, Draw& recorder) {
+        const RecordJob& job = jobs[i];
+        emitters[job.emitter]->drawParticles(recorder, job.begin, job.end);
+        });
+}
+
+static void addParticleBenchmarks(MicroBench& bench) {
+    bench.add("particles/snow100k", [](Uint64 n) {
+        ParticleEmitter& e = snowEmitter(false);
+        for (Uint64 i = 0; i < n; ++i) e.update(1.0f / 60.0f);
+        keep(e.getParticleCount());
+        });
+    bench.add("particles/snow100k compact", [](Uint64 n) {
+        ParticleEmitter& e = snowEmitter(true);
+        for (Uint64 i = 0; i < n; ++i) e.update(1.0f / 60.0f);
+        keep(e.getParticleCount());
+        });
+
+    // Same recording on the calling thread and on a worker per core; the
+    // ratio is how well vertex generation scales
+    bench.add("particles/record8x2k 1 worker", [](Uint64 n) {
+        for (Uint64 i = 0; i < n; ++i) recordEmitters(nullptr);
+        });
+    int workers = std::max(2, static_cast<int>(std::thread::hardware_concurrency()));
+    bench.add("particles/record8x2k " + std::to_string(workers) + " workers", [workers](Uint64 n) {
+        static ThreadPool pool(workers);
+        for (Uint64 i = 0; i < n; ++i) recordEmitters(&pool);
+        });
+}
+
+// ===== COMPACT ERROR =====
+// Full Particles and CompactParticles spawned identically and stepped side
+// by side under gravity, wind and drag. There are no random forces, so every
+// difference is quantisation. Each particle goes four times into one store,
+// which runs the SSE2 kernel, and once into another, which only has a
+// scalar tail. Lifetime error is what remains beyond the one frame either
+// side may round to.
+struct CompactError {
+    double lifetime = 0; // % of the lifetime
+    double size = 0;     // px
+    double position = 0; // px
+    double rotation = 0; // rad
+};
+
+static void measureCompact(const CompactParticles& cp, size_t i, const Particle& p, CompactError& error) {
+    float size = cp.startSize(i) * (1.0f - 0.9f * Utils::easeInOutCubic(cp.ageFraction(i)));
+    double turn = std::remainder(static_cast<double>(cp.rotationRadians(i)) - p.rotation, TWO_PI);
+    error.size = std::max(error.size, static_cast<double>(std::abs(size - p.getCurrentSize())));
+    error.position = std::max(error.position, static_cast<double>((Vec2(cp.x[i], cp.y[i]) - p.position).length()));
+    error.rotation = std::max(error.rotation, std::abs(turn));
+}
+
+static void measureDeath(float compact, float full, float lifetime, float dt, CompactError& error) {
+    float beyond = std::max(0.0f, std::abs(compact - full) - dt);
+    error.lifetime = std::max(error.lifetime, 100.0 * beyond / lifetime);
+}
+
+static void reportCompactError(int count) {
+    const float dt = 1.0f / 60.0f;
+    CompactForces forces;
+    forces.gravity = { 0, 30 };
+    forces.wind = { 20, 0 };
+    CompactError lanes, tail;
+    Utils::seedRandom(99);
+
+    for (int n = 0; n < count; ++n) {
+        Particle p;
+        p.position = { Utils::randomFloat(0, 1280), Utils::randomFloat(0, 720) };
+        p.velocity = Vec2::fromAngle(Utils::randomFloat(0, TWO_PI), Utils::randomFloat(0, 200));
+        p.lifetime = Utils::randomFloat(0.3f, 20.0f);
+        p.startSize = Utils::randomFloat(1, 64);
+        p.endSize = p.startSize * 0.1f;
+        p.rotation = Utils::randomFloat(0, TWO_PI);
+        p.angularVelocity = Utils::randomFloat(-180, 180);
+        p.mass = Utils::randomFloat(0.8f, 1.2f);
+
+        CompactParticles vector, scalar;
+        for (int i = 0; i < 4; ++i) {
+            vector.spawn(p.position, p.velocity, p.lifetime, p.startSize, p.rotation, p.angularVelocity, p.mass);
+        }
+        scalar.spawn(p.position, p.velocity, p.lifetime, p.startSize, p.rotation, p.angularVelocity, p.mass);
+
+        float fullDeath = 0, vectorDeath = 0, scalarDeath = 0;
+        for (int step = 1; fullDeath == 0 || vectorDeath == 0 || scalarDeath == 0; ++step) {
+            float now = step * dt;
+            if (fullDeath == 0) {
+                p.applyForce(forces.gravity * p.mass);
+                p.applyForce(forces.wind);
+                p.update(dt);
+                if (!p.isAlive()) fullDeath = now;
+            }
+            // Each store stops at its first death: removal shifts the rest
+            // out of their SSE2 lanes
+            if (vectorDeath == 0) {
+                vector.update(dt, forces);
+                if (vector.count() < 4) vectorDeath = now;
+            }
+            if (scalarDeath == 0) {
+                scalar.update(dt, forces);
+                if (scalar.count() < 1) scalarDeath = now;
+            }
+            if (fullDeath != 0) continue;
+            if (vectorDeath == 0) {
+                for (size_t i = 0; i < 4; ++i) measureCompact(vector, i, p, lanes);
+            }
+            if (scalarDeath == 0) measureCompact(scalar, 0, p, tail);
+        }
+        measureDeath(vectorDeath, fullDeath, p.lifetime, dt, lanes);
+        measureDeath(scalarDeath, fullDeath, p.lifetime, dt, tail);
+    }
+
+#ifdef PARTICLE_SSE2
+    const char* lanesName = "sse2";
+#else
+    const char* lanesName = "scalar (no SSE2)";
+#endif
+    std::printf("Compact vs full particles: %d particles, 0.3-20 s lives, up to 180 rad/s spin\n", count);
+    std::printf("%-18s %12s %10s %12s %12s\n", "kernel", "lifetime %", "size px", "position px", "rotation rad");
+    for (const auto& [name, error] : { std::pair{ lanesName, lanes }, std::pair{ "scalar", tail } }) {
+        std::printf("%-18s %12.3f %10.3f %12.4f %12.3f\n", name, error.lifetime, error.size, error.position,
+            error.rotation);
+    }
+}
+
+// ===== DRAW =====
+// Shapes are sized like typical game content (particles, UI panels, bodies)
+static void addDrawBenchmarks(MicroBench& bench, Draw& draw) {
+    Draw* d = &draw;
+    draw.color(255, 255, 255, 200);
+
+    auto add = [&](const char* name, std::function<void(Draw&, Uint64)> op) {
+        bench.add(std::string("draw/") + name, [d, op](Uint64 n) { op(*d, n); }, d);
+    };
+
+    static std::vector<SDL_FPoint> points, polyline, polygon;
+    static std::vector<SDL_FRect> rects;
+    points.clear();
+    polyline.clear();
+    polygon.clear();
+    rects.clear();
+    for (int i = 0; i < 256; ++i) {
+        points.push_back({ 40.0f + (i * 37) % 1200, 40.0f + (i * 53) % 640 });
+        rects.push_back({ 40.0f + (i * 37) % 1200, 40.0f + (i * 53) % 640, 6.0f, 6.0f });
+    }
+    for (int i = 0; i < 32; ++i) {
+        polyline.push_back({ 100.0f + i * 20.0f, 300.0f + 40.0f * std::sin(i * 0.5f) });
+    }
+    for (const Vec2& p : Utils::generateStarPoints(6, 30.0f, 70.0f)) {
+        polygon.push_back({ 640.0f + p.x, 360.0f + p.y });
+    }
+
+    add("clear", [](Draw& dr, Uint64 n) {
+        for (Uint64 i = 0; i < n; ++i) dr.clear();
+        });
+    add("color", [](Draw& dr, Uint64 n) {
+        for (Uint64 i = 0; i < n; ++i) dr.color(static_cast<Uint8>(i), 128, 64, 200);
+        dr.color(255, 255, 255, 200);
+        });
+    add("point", [](Draw& dr, Uint64 n) {
+        for (Uint64 i = 0; i < n; ++i) dr.point(static_cast<float>(i % 1280), 100.0f);
+        });
+    add("points256", [](Draw& dr, Uint64 n) {
+        for (Uint64 i = 0; i < n; ++i) dr.points(points);
+        });
+    add("line", [](Draw& dr, Uint64 n) {
+        for (Uint64 i = 0; i < n; ++i) dr.line(10.0f, 10.0f, 300.0f, 10.0f + (i & 255));
+        });
+    add("lines32", [](Draw& dr, Uint64 n) {
+        for (Uint64 i = 0; i < n; ++i) dr.lines(polyline);
+        });
+    add("polygon", [](Draw& dr, Uint64 n) {
+        for (Uint64 i = 0; i < n; ++i) dr.polygon(polygon);
+        });
+    add("rect", [](Draw& dr, Uint64 n) {
+        for (Uint64 i = 0; i < n; ++i) dr.rect(100.0f, 100.0f, 64.0f, 48.0f);
+        });
+    add("rects256", [](Draw& dr, Uint64 n) {
+        for (Uint64 i = 0; i < n; ++i) dr.rects(rects.data(), static_cast<int>(rects.size()));
+        });
+    add("fill_rect", [](Draw& dr, Uint64 n) {
+        for (Uint64 i = 0; i < n; ++i) dr.fill_rect(100.0f, 100.0f, 64.0f, 48.0f);
+        });
+    add("fill_rects256", [](Draw& dr, Uint64 n) {
+        for (Uint64 i = 0; i < n; ++i) dr.fill_rects(rects.data(), static_cast<int>(rects.size()));
+        });
+    add("circle r20", [](Draw& dr, Uint64 n) {
+        for (Uint64 i = 0; i < n; ++i) dr.circle(640, 360, 20);
+        });
+    add("fill_circle r4", [](Draw& dr, Uint64 n) {
+        for (Uint64 i = 0; i < n; ++i) dr.fill_circle(640, 360, 4);
+        });
+    add("fill_circle r20", [](Draw& dr, Uint64 n) {
+        for (Uint64 i = 0; i < n; ++i) dr.fill_circle(640, 360, 20);
+        });
+    // The same circle recorded into a chunk (as a DrawArena worker would)
+    // and submitted as one geometry call
+    add("fill_circle r20 recorded", [](Draw& dr, Uint64 n) {
+        static DrawChunk chunk;
+        chunk.clear();
+        dr.record_into(&chunk);
+        for (Uint64 i = 0; i < n; ++i) dr.fill_circle(640, 360, 20);
+        dr.record_into(nullptr);
+        dr.submit_geometry(chunk.vertices.data(), static_cast<int>(chunk.vertices.size()),
+            chunk.indices.data(), static_cast<int>(chunk.indices.size()));
+        });
+    add("ellipse", [](Draw& dr, Uint64 n) {
+        for (Uint64 i = 0; i < n; ++i) dr.ellipse(640, 360, 40, 20);
+        });
+    add("fill_polygon", [](Draw& dr, Uint64 n) {
+        for (Uint64 i = 0; i < n; ++i) dr.fill_polygon(polygon, 255, 128, 0, 200);
+        });
+
+    // Concave star: ear clipping per call vs the cached mesh under a transform
+    static std::vector<SDL_FPoint> star;
+    star.clear();
+    for (const Vec2& p : Utils::generateStarPoints(5, 8.0f, 20.0f)) star.push_back({ 640 + p.x, 360 + p.y });
+    static PolygonMesh unitStar;
+    std::vector<SDL_FPoint> outline;
+    for (const Vec2& p : Utils::generateStarPoints(5, 0.4f, 1.0f)) outline.push_back({ p.x, p.y });
+    unitStar = PolygonMesh(std::move(outline));
+    add("fill_polygon star", [](Draw& dr, Uint64 n) {
+        for (Uint64 i = 0; i < n; ++i) dr.fill_polygon(star, 255, 128, 0, 200);
+        });
+    add("fill_mesh star", [](Draw& dr, Uint64 n) {
+        dr.push_transform();
+        dr.translate(640.0f, 360.0f);
+        dr.scale(20.0f, 20.0f);
+        for (Uint64 i = 0; i < n; ++i) dr.fill_mesh(unitStar, 255, 128, 0, 200);
+        dr.pop_transform();
+        });
+    add("fill_rect+view", [](Draw& dr, Uint64 n) {
+        dr.set_view(120.0f, 40.0f, 1.5f);
+        for (Uint64 i = 0; i < n; ++i) dr.fill_rect(100.0f, 100.0f, 64.0f, 48.0f);
+        dr.reset_view();
+        });
+    add("fill_rect+rotate", [](Draw& dr, Uint64 n) {
+        dr.set_view(120.0f, 40.0f, 1.5f);
+        dr.rotate(0.3f);
+        for (Uint64 i = 0; i < n; ++i) dr.fill_rect(100.0f, 100.0f, 64.0f, 48.0f);
+        dr.reset_view();
+        });
+}
+
+int main(int argc, char* argv[]) {
+    MicroBench bench;
+    bool csv = false;
+    int compactError = 0;
+
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--filter") == 0 && i + 1 < argc) {
+            bench.filter = argv[++i];
+        }
+        else if (std::strcmp(argv[i], "--samples") == 0 && i + 1 < argc) {
+            bench.samples = std::max(2, std::atoi(argv[++i]));
+        }
+        else if (std::strcmp(argv[i], "--min-ms") == 0 && i + 1 < argc) {
+            bench.minSampleMs = std::max(0.01, std::atof(argv[++i]));
+        }
+        else if (std::strcmp(argv[i], "--csv") == 0) {
+            csv = true;
+        }
+        else if (std::strcmp(argv[i], "--compact-error") == 0 && i + 1 < argc) {
+            compactError = std::max(1, std::atoi(argv[++i]));
+        }
+        else {
+            std::fprintf(stderr,
+                "Usage: microbench [--filter text] [--samples N] [--min-ms X] [--csv] [--compact-error N]\n");
+            return 1;
+        }
+    }
+
+    if (compactError > 0) {
+        reportCompactError(compactError);
+        return 0;
+    }
+
+    addMathBenchmarks(bench);
+    addProjectileBenchmarks(bench);
+    addSweepBenchmarks(bench);
+    addNavBenchmarks(bench);
+    addSphBenchmarks(bench);
+    addSynthBenchmarks(bench);
+    addParticleBenchmarks(bench);
+
+    // Software rendering needs no video subsystem or window
+    SDL_Surface* surface = SDL_CreateSurface(1280, 720, SDL_PIXELFORMAT_ARGB8888);
+    SDL_Renderer* renderer = surface ? SDL_CreateSoftwareRenderer(surface) : nullptr;
+    Draw draw(renderer);
+    if (renderer) {
+        addDrawBenchmarks(bench, draw);
+    }
+    else {
+        std::fprintf(stderr, "No software renderer (%s); skipping draw benchmarks\n", SDL_GetError());
+    }
+
+    bench.runAll(csv);
+
+    if (renderer) SDL_DestroyRenderer(renderer);
+    if (surface) SDL_DestroySurface(surface);
+    SDL_Quit();
+    return 0;
+}
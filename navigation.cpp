@@ -0,0 +1,281 @@
+// navigation.cpp - Platform navigation graph and a shared flow field for horde pathing
+// Nodes are walkable surfaces: the ground split into fixed-width segments plus
+// every platform top. Links are precomputed from the level's platform rects:
+//   WALK - between neighbouring ground segments
+//   JUMP - ballistic leap onto a surface (launch speed and air time stored)
+//   DROP - walk off a platform edge onto the highest surface below
+// FlowField runs one reverse Dijkstra from the goal node, so every agent in
+// the level paths with a single lookup (its node's next link) per step.
+// Both are read-only after building and safe to query from several threads.
+#pragma once
+#include <SDL3/SDL.h>
+#include <vector>
+#include <queue>
+#include <cmath>
+#include <algorithm>
+#include "utils.cpp"
+#include "renderer2d.cpp"
+
+// Movement limits the links must respect, in pixels per 60 Hz frame
+struct NavMotion {
+    float gravity = 0.5f;
+    float airDrag = 0.98f;      // Horizontal velocity factor per airborne frame
+    float maxJumpSpeed = 13.0f; // Launch speed straight up
+    float maxAirSpeed = 7.0f;   // Horizontal launch speed
+    float clearance = 20.0f;    // Apex margin above the landing surface
+};
+
+enum class NavLinkType : uint8_t { WALK, JUMP, DROP };
+
+struct NavLink {
+    int from, to;
+    NavLinkType type;
+    float takeoffX;  // Where to leave `from`
+    float landingX;  // Where to arrive on `to`
+    float jumpSpeed; // JUMP: upward launch speed
+    float airFrames; // JUMP: frames from launch to landing
+    float cost;
+};
+
+struct NavNode {
+    float x0, x1; // Walkable span
+    float y;      // Surface top
+    bool ground;
+};
+
+class NavGraph {
+private:
+    static constexpr float EDGE_INSET = 4.0f;   // Take-off point inside an edge
+    static constexpr float LAND_INSET = 20.0f;  // Landing point inside an edge
+    static constexpr float MAX_LEAP = 260.0f;   // Horizontal gap never worth testing
+    static constexpr float JUMP_COST = 60.0f;   // Bias against leaving the ground
+    static constexpr float SURFACE_TOLERANCE = 2.0f;
+
+    std::vector<NavNode> nodes;
+    std::vector<NavLink> links;
+    std::vector<std::vector<int>> outgoing, incoming;
+
+    // Platform node ids per column of COLUMN_WIDTH for locate()
+    static constexpr float COLUMN_WIDTH = 128.0f;
+    std::vector<std::vector<int>> columns;
+
+    NavMotion motion;
+    float groundY;
+    float segmentWidth;
+    int groundCount;
+
+    int column(float x) const {
+        int c = static_cast<int>(std::floor(x / COLUMN_WIDTH));
+        return std::clamp(c, 0, static_cast<int>(columns.size()) - 1);
+    }
+
+    // Cost runs centre to centre, so walking across a node is paid for too
+    void addLink(NavLink link) {
+        const NavNode& a = nodes[link.from];
+        const NavNode& b = nodes[link.to];
+        link.cost += std::abs(link.takeoffX - (a.x0 + a.x1) * 0.5f) +
+            std::abs(link.landingX - link.takeoffX) +
+            std::abs((b.x0 + b.x1) * 0.5f - link.landingX) + std::abs(a.y - b.y);
+        int id = static_cast<int>(links.size());
+        links.push_back(link);
+        outgoing[link.from].push_back(id);
+        incoming[link.to].push_back(id);
+    }
+
+    // Highest surface whose top is below y at x, ground if nothing else
+    int surfaceBelow(float x, float y) const {
+        int best = groundAt(x);
+        for (int id : columns[column(x)]) {
+            const NavNode& n = nodes[id];
+            if (x >= n.x0 && x <= n.x1 && n.y > y && n.y < nodes[best].y) best = id;
+        }
+        return best;
+    }
+
+    // Ballistic leap from (tx, a.y) to (lx, b.y); false if out of reach
+    bool solveJump(const NavNode& a, const NavNode& b, float tx, float lx,
+        float& speed, float& frames) const {
+        float rise = a.y - b.y;
+        float apex = std::max(rise, 0.0f) + motion.clearance;
+        speed = std::sqrt(2.0f * motion.gravity * apex);
+        if (speed > motion.maxJumpSpeed) return false;
+
+        float fall = apex - rise;
+        frames = speed / motion.gravity + std::sqrt(2.0f * fall / motion.gravity);
+        return launchSpeedX(lx - tx, frames) <= motion.maxAirSpeed;
+    }
+
+    void linkJump(int from, int to) {
+        const NavNode& a = nodes[from];
+        const NavNode& b = nodes[to];
+
+        float tx, lx;
+        float lo = std::max(a.x0, b.x0), hi = std::min(a.x1, b.x1);
+        if (lo <= hi) {
+            // Spans overlap: straight up through the one-way platform
+            if (a.y <= b.y) return; // Never jump onto a surface below in place
+            lx = std::clamp((lo + hi) * 0.5f, b.x0 + LAND_INSET, b.x1 - LAND_INSET);
+            if (lx < b.x0 || lx > b.x1) lx = (b.x0 + b.x1) * 0.5f;
+            tx = std::clamp(lx, a.x0, a.x1);
+        }
+        else if (a.x1 < b.x0) {
+            if (b.x0 - a.x1 > MAX_LEAP) return;
+            tx = a.x1 - EDGE_INSET;
+            lx = std::min(b.x0 + LAND_INSET, (b.x0 + b.x1) * 0.5f);
+        }
+        else {
+            if (a.x0 - b.x1 > MAX_LEAP) return;
+            tx = a.x0 + EDGE_INSET;
+            lx = std::max(b.x1 - LAND_INSET, (b.x0 + b.x1) * 0.5f);
+        }
+
+        float speed, frames;
+        if (!solveJump(a, b, tx, lx, speed, frames)) return;
+        addLink({ from, to, NavLinkType::JUMP, tx, lx, speed, frames, JUMP_COST });
+    }
+
+    void linkDrop(int from, float edgeX, float outward) {
+        float lx = edgeX + outward * LAND_INSET;
+        if (lx < 0 || lx > nodes[groundCount - 1].x1) return;
+        int to = surfaceBelow(lx, nodes[from].y);
+        addLink({ from, to, NavLinkType::DROP, edgeX, lx, 0.0f, 0.0f, 0.0f });
+    }
+
+public:
+    NavGraph() : groundY(0), segmentWidth(128.0f), groundCount(0) {}
+
+    // Horizontal launch speed that covers dx in `frames` under air drag
+    float launchSpeedX(float dx, float frames) const {
+        float k = 1.0f - motion.airDrag;
+        float travel = k > 0 ? (1.0f - std::pow(motion.airDrag, frames)) / k : frames;
+        return std::abs(dx) / std::max(travel, 1.0f);
+    }
+
+    void build(const std::vector<SDL_FRect>& platforms, float width, float ground,
+        const NavMotion& limits = NavMotion(), float segment = 128.0f) {
+        motion = limits;
+        groundY = ground;
+        segmentWidth = segment;
+        nodes.clear();
+        links.clear();
+
+        groundCount = std::max(1, static_cast<int>(std::ceil(width / segmentWidth)));
+        for (int i = 0; i < groundCount; ++i) {
+            nodes.push_back({ i * segmentWidth, std::min(width, (i + 1) * segmentWidth), ground, true });
+        }
+        for (const SDL_FRect& p : platforms) {
+            nodes.push_back({ p.x, p.x + p.w, p.y, false });
+        }
+
+        size_t count = nodes.size();
+        outgoing.assign(count, {});
+        incoming.assign(count, {});
+        columns.assign(static_cast<size_t>(std::ceil(width / COLUMN_WIDTH)) + 1, {});
+        for (int id = groundCount; id < static_cast<int>(count); ++id) {
+            int c0 = column(nodes[id].x0), c1 = column(nodes[id].x1);
+            for (int c = c0; c <= c1; ++c) columns[c].push_back(id);
+        }
+
+        for (int i = 0; i + 1 < groundCount; ++i) {
+            float edge = nodes[i].x1;
+            addLink({ i, i + 1, NavLinkType::WALK, edge, edge, 0.0f, 0.0f, 0.0f });
+            addLink({ i + 1, i, NavLinkType::WALK, edge, edge, 0.0f, 0.0f, 0.0f });
+        }
+
+        for (int to = groundCount; to < static_cast<int>(count); ++to) {
+            for (int from = 0; from < static_cast<int>(count); ++from) {
+                if (from == to) continue;
+                const NavNode& a = nodes[from];
+                const NavNode& b = nodes[to];
+                if (a.x1 < b.x0 - MAX_LEAP || a.x0 > b.x1 + MAX_LEAP) continue;
+                linkJump(from, to);
+            }
+            linkDrop(to, nodes[to].x0, -1.0f);
+            linkDrop(to, nodes[to].x1, 1.0f);
+        }
+    }
+
+    // Node whose surface the feet stand on, or -1 while airborne
+    int locate(Vec2 feet) const {
+        if (nodes.empty()) return -1;
+        for (int id : columns[column(feet.x)]) {
+            const NavNode& n = nodes[id];
+            if (feet.x >= n.x0 && feet.x <= n.x1 && std::abs(feet.y - n.y) <= SURFACE_TOLERANCE) {
+                return id;
+            }
+        }
+        if (std::abs(feet.y - groundY) <= SURFACE_TOLERANCE) return groundAt(feet.x);
+        return -1;
+    }
+
+    int groundAt(float x) const {
+        int i = static_cast<int>(std::floor(x / segmentWidth));
+        return std::clamp(i, 0, groundCount - 1);
+    }
+
+    size_t getNodeCount() const { return nodes.size(); }
+    size_t getLinkCount() const { return links.size(); }
+    const NavNode& getNode(int id) const { return nodes[id]; }
+    const NavLink& getLink(int id) const { return links[id]; }
+    const std::vector<int>& getIncoming(int node) const { return incoming[node]; }
+    const NavMotion& getMotion() const { return motion; }
+
+    // Debug view: jumps in yellow, drops in blue (walk links are implied)
+    void draw(Draw& draw, const SDL_FRect& visible) const {
+        for (const NavLink& link : links) {
+            if (link.type == NavLinkType::WALK) continue;
+            float y0 = nodes[link.from].y, y1 = nodes[link.to].y;
+            if (std::max(link.takeoffX, link.landingX) < visible.x ||
+                std::min(link.takeoffX, link.landingX) > visible.x + visible.w) continue;
+
+            if (link.type == NavLinkType::JUMP) draw.color(230, 200, 60);
+            else draw.color(80, 140, 230);
+            draw.line(link.takeoffX, y0, link.landingX, y1);
+        }
+    }
+};
+
+// Next link toward one goal node for every node of a NavGraph
+class FlowField {
+private:
+    std::vector<int> next;   // Link to take from each node, -1 at the goal or if unreachable
+    std::vector<float> cost; // Path cost to the goal
+    int goal;
+
+public:
+    FlowField() : goal(-1) {}
+
+    // Reverse Dijkstra from the goal over incoming links
+    void build(const NavGraph& graph, int goalNode) {
+        size_t count = graph.getNodeCount();
+        goal = goalNode;
+        next.assign(count, -1);
+        cost.assign(count, INFINITY);
+        if (goal < 0 || goal >= static_cast<int>(count)) return;
+
+        using Entry = std::pair<float, int>;
+        std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> open;
+        cost[goal] = 0;
+        open.push({ 0.0f, goal });
+
+        while (!open.empty()) {
+            auto [c, node] = open.top();
+            open.pop();
+            if (c > cost[node]) continue;
+
+            for (int id : graph.getIncoming(node)) {
+                const NavLink& link = graph.getLink(id);
+                float total = c + link.cost;
+                if (total < cost[link.from]) {
+                    cost[link.from] = total;
+                    next[link.from] = id;
+                    open.push({ total, link.from });
+                }
+            }
+        }
+    }
+
+    int getGoal() const { return goal; }
+    int getNext(int node) const { return node >= 0 && node < static_cast<int>(next.size()) ? next[node] : -1; }
+    float getCost(int node) const { return cost[node]; }
+};
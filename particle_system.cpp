@@ -4,7 +4,7 @@
 #include <vector>
 #include <memory>
 #include <deque>
-#include <unordered_map>
+#include <type_traits>
 #include <functional>
 #include <algorithm>
 #include <cmath>
@@ -13,6 +13,12 @@
 #include <chrono>
 #include "renderer2d.cpp"  // Your Draw struct
 #include "utils.cpp"        // Utils struct we just created
+#include "sph_fluid.cpp"    // SPH liquid for the water presets
+#include "hud_layer.cpp"    // Overlay panels cached in a render target
+#include "quality_settings.cpp" // Calibrated quality tier knobs
+#include "telemetry.cpp"    // Frame telemetry rings (--telemetry)
+#include "draw_arena.cpp"   // Particle vertices built on the worker pool
+#include "compact_particles.cpp" // Quantised storage for huge ambient emitters
 
 // Particle system enums
 enum class ParticleShape {
@@ -31,6 +37,7 @@ enum class ParticleShape {
     FLAME,
     SPARKLE,
     BUBBLE,
+    GEAR,
     CUSTOM
 };
 
@@ -83,6 +90,22 @@ struct ColorRampPoint {
     ColorRampPoint(float time, const Color& col) : t(time), color(col) {}
 };
 
+// Colour at lifetime fraction t; `fallback` when there is no ramp
+static Color sampleColorRamp(const std::vector<ColorRampPoint>& ramp, float t, const Color& fallback) {
+    if (ramp.empty()) return fallback;
+
+    // Find surrounding color points
+    for (size_t i = 0; i < ramp.size() - 1; ++i) {
+        if (t >= ramp[i].t && t <= ramp[i + 1].t) {
+            float localT = (t - ramp[i].t) / (ramp[i + 1].t - ramp[i].t);
+            return Color::lerp(ramp[i].color, ramp[i + 1].color, localT);
+        }
+    }
+
+    // Return last color if beyond range
+    return ramp.back().color;
+}
+
 // Force field for particle physics
 struct ForceField {
     Vec2 position;
@@ -173,8 +196,9 @@ struct Particle {
     bool collides = false;
     float collisionRadius = 0;
 
-    // Custom data
-    std::unordered_map<std::string, float> customData;
+    // Index into the owning emitter's attribute channels, fixed when the
+    // emitter creates the particle (see ParticleAttributes)
+    Uint32 slot = 0;
 
     // Constructor
     Particle() {
@@ -193,7 +217,6 @@ struct Particle {
         size = startSize = endSize = 10;
         trail.clear();
         behaviors.clear();
-        customData.clear();
         mass = 1.0f;
         drag = 0.98f;
         bounce = 0.8f;
@@ -339,20 +362,7 @@ struct Particle {
 
     // Get current color based on lifetime
     Color getCurrentColor() const {
-        if (colorRamp.empty()) return color;
-
-        float t = age / lifetime;
-
-        // Find surrounding color points
-        for (size_t i = 0; i < colorRamp.size() - 1; ++i) {
-            if (t >= colorRamp[i].t && t <= colorRamp[i + 1].t) {
-                float localT = (t - colorRamp[i].t) / (colorRamp[i + 1].t - colorRamp[i].t);
-                return Color::lerp(colorRamp[i].color, colorRamp[i + 1].color, localT);
-            }
-        }
-
-        // Return last color if beyond range
-        return colorRamp.back().color;
+        return sampleColorRamp(colorRamp, age / lifetime, color);
     }
 
     // Get current size based on lifetime
@@ -392,12 +402,153 @@ struct Particle {
     }
 };
 
+// ===== UNIT SHAPES =====
+// Radius-1 outlines triangulated once and shared by every emitter; each
+// particle places one with Draw's transform (one geometry call when filled)
+static PolygonMesh makeUnitMesh(const std::vector<Vec2>& points) {
+    std::vector<SDL_FPoint> outline;
+    outline.reserve(points.size());
+    for (const Vec2& p : points) {
+        outline.push_back({ p.x, p.y });
+    }
+    return PolygonMesh(std::move(outline));
+}
+
+static const PolygonMesh& unitShapeMesh(ParticleShape shape) {
+    static const PolygonMesh star = makeUnitMesh(Utils::generateStarPoints(5, 0.4f, 1.0f));
+    static const PolygonMesh hexagon = makeUnitMesh(Utils::generatePolygonPoints(6, 1.0f));
+    static const PolygonMesh triangle = makeUnitMesh(Utils::generatePolygonPoints(3, 1.0f));
+    static const PolygonMesh heart = makeUnitMesh(Utils::generateHeartPoints(1.0f));
+    static const PolygonMesh gear = makeUnitMesh(Utils::generateGearPoints(10, 0.75f, 1.0f));
+    static const PolygonMesh cloud = makeUnitMesh(Utils::generateCloudPoints(1.8f, 1.6f));
+
+    switch (shape) {
+    case ParticleShape::STAR: return star;
+    case ParticleShape::TRIANGLE: return triangle;
+    case ParticleShape::HEART: return heart;
+    case ParticleShape::GEAR: return gear;
+    case ParticleShape::SMOKE_PUFF: return cloud;
+    default: return hexagon;
+    }
+}
+
+// Handle to one declared attribute; resolve it once, then use it per particle
+template <typename T>
+struct ParticleAttribute {
+    int channel = -1;
+    bool valid() const { return channel >= 0; }
+};
+
+// Custom per-particle values an emitter's callbacks keep between frames (a
+// phase, a home position, a hit count). Attributes are declared by name up
+// front and stored as one dense array per attribute, indexed by
+// Particle::slot. Names are only looked up when declaring, so callbacks
+// read and write through a handle with no hashing or allocation.
+class ParticleAttributes {
+private:
+    template <typename T>
+    struct Channels {
+        std::vector<std::string> names;
+        std::vector<T> defaults;
+        std::vector<std::vector<T>> values; // [channel][slot]
+    };
+
+    Channels<float> floats;
+    Channels<int> ints;
+    Channels<Vec2> vectors;
+    Channels<Color> colors;
+    size_t slots = 0;
+
+    template <typename T>
+    Channels<T>& channels() {
+        static_assert(std::is_same_v<T, float> || std::is_same_v<T, int> ||
+            std::is_same_v<T, Vec2> || std::is_same_v<T, Color>,
+            "Particle attributes are float, int, Vec2 or Color");
+        if constexpr (std::is_same_v<T, float>) return floats;
+        else if constexpr (std::is_same_v<T, int>) return ints;
+        else if constexpr (std::is_same_v<T, Vec2>) return vectors;
+        else return colors;
+    }
+
+    template <typename T>
+    const Channels<T>& channels() const {
+        return const_cast<ParticleAttributes*>(this)->channels<T>();
+    }
+
+    template <typename T>
+    static void grow(Channels<T>& c, size_t count) {
+        for (size_t i = 0; i < c.values.size(); ++i) c.values[i].resize(count, c.defaults[i]);
+    }
+
+    template <typename T>
+    static void resetSlot(Channels<T>& c, Uint32 slot) {
+        for (size_t i = 0; i < c.values.size(); ++i) c.values[i][slot] = c.defaults[i];
+    }
+
+public:
+    // Declaring a name twice returns the first handle
+    template <typename T>
+    ParticleAttribute<T> declare(const std::string& name, T initial = T()) {
+        ParticleAttribute<T> existing = find<T>(name);
+        if (existing.valid()) return existing;
+
+        Channels<T>& c = channels<T>();
+        c.names.push_back(name);
+        c.defaults.push_back(initial);
+        c.values.emplace_back(slots, initial);
+        return { static_cast<int>(c.names.size()) - 1 };
+    }
+
+    // Invalid handle if no attribute of that name and type was declared
+    template <typename T>
+    ParticleAttribute<T> find(const std::string& name) const {
+        const Channels<T>& c = channels<T>();
+        for (size_t i = 0; i < c.names.size(); ++i) {
+            if (c.names[i] == name) return { static_cast<int>(i) };
+        }
+        return {};
+    }
+
+    template <typename T>
+    T& get(ParticleAttribute<T> attribute, const Particle& p) {
+        return channels<T>().values[attribute.channel][p.slot];
+    }
+
+    template <typename T>
+    const T& get(ParticleAttribute<T> attribute, const Particle& p) const {
+        return channels<T>().values[attribute.channel][p.slot];
+    }
+
+    // Called as the emitter creates particles for its pool
+    void resize(size_t count) {
+        slots = count;
+        grow(floats, count);
+        grow(ints, count);
+        grow(vectors, count);
+        grow(colors, count);
+    }
+
+    // Back to the declared defaults, before the spawn callback runs
+    void reset(Uint32 slot) {
+        resetSlot(floats, slot);
+        resetSlot(ints, slot);
+        resetSlot(vectors, slot);
+        resetSlot(colors, slot);
+    }
+
+    bool empty() const {
+        return floats.names.empty() && ints.names.empty() && vectors.names.empty() && colors.names.empty();
+    }
+
+    size_t slotCount() const { return slots; }
+};
+
 // Particle Emitter struct
 struct ParticleEmitter {
     // Particle management
     std::vector<std::unique_ptr<Particle>> activeParticles;
     std::vector<std::unique_ptr<Particle>> particlePool;
-    size_t maxParticles = 5000;
+    size_t maxParticles = Quality::get().maxParticles;
 
     // Transform
     Vec2 position;
@@ -460,6 +611,16 @@ struct ParticleEmitter {
     bool enableCollision = false;
     std::vector<SDL_FRect> collisionRects;
 
+    // Compact storage for huge ambient emitters (snow, stars): 28 bytes per
+    // particle instead of a Particle each. Only used while the emitter needs
+    // nothing a compact particle lacks (see compactSupported).
+    bool compact = false;
+    CompactParticles compactParticles;
+    std::vector<Color> compactColors; // colorRamp sampled per colour index
+
+    // Custom per-particle values for the callbacks
+    ParticleAttributes attributes;
+
     // Callbacks
     std::function<void(Particle&)> onParticleSpawn;
     std::function<void(Particle&)> onParticleUpdate;
@@ -472,9 +633,13 @@ struct ParticleEmitter {
 
     // Initialize emitter
     void init() {
-        // Initialize particle pool
+        // Initialize particle pool; each particle keeps its attribute slot
+        size_t firstSlot = attributes.slotCount();
+        attributes.resize(firstSlot + maxParticles);
         for (size_t i = 0; i < maxParticles; ++i) {
-            particlePool.push_back(std::make_unique<Particle>());
+            auto particle = std::make_unique<Particle>();
+            particle->slot = static_cast<Uint32>(firstSlot + i);
+            particlePool.push_back(std::move(particle));
         }
 
         // Default color ramp
@@ -560,8 +725,62 @@ struct ParticleEmitter {
         return Vec2::fromAngle(angle, speed);
     }
 
+    // Trails, force fields, collision, callbacks, attributes and steering
+    // behaviours need full particles
+    bool compactSupported() const {
+        if (enableTrails || enableCollision || !forceFields.empty()) return false;
+        if (onParticleSpawn || onParticleUpdate || onParticleDeath) return false;
+        if (!attributes.empty()) return false;
+        for (ParticleBehavior behavior : behaviors) {
+            if (behavior != ParticleBehavior::GRAVITY && behavior != ParticleBehavior::WIND &&
+                behavior != ParticleBehavior::WANDER && behavior != ParticleBehavior::TURBULENCE) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool usesCompact() const { return compact && compactSupported(); }
+
+    // The behaviours compact particles support, as the same forces
+    // Particle::applyBehaviors would apply
+    CompactForces compactForces() const {
+        CompactForces f;
+        f.gravity = gravity;
+        f.wind = wind;
+        f.turbulence = turbulence;
+        f.drag = drag;
+        for (ParticleBehavior behavior : behaviors) {
+            switch (behavior) {
+            case ParticleBehavior::GRAVITY: f.gravity.y += 98; break;
+            case ParticleBehavior::WIND: f.windJitter = 10; break;
+            case ParticleBehavior::WANDER: f.wander = 20; break;
+            case ParticleBehavior::TURBULENCE: f.flowNoise = 50; break;
+            default: break;
+            }
+        }
+        return f;
+    }
+
+    void emitCompact(int count) {
+        for (int i = 0; i < count && compactParticles.count() < maxParticles; ++i) {
+            Vec2 pos = getEmissionPosition();
+            Vec2 vel = getEmissionVelocity();
+            float life = Utils::randomFloat(lifetimeRange.first, lifetimeRange.second);
+            float size = Utils::randomFloat(sizeRange.first, sizeRange.second);
+            float rot = Utils::randomFloat(0, TWO_PI);
+            float spin = Utils::randomFloat(angularVelRange.first, angularVelRange.second);
+            float mass = Utils::randomFloat(massRange.first, massRange.second);
+            compactParticles.spawn(pos, vel, life, size, rot, spin, mass);
+        }
+    }
+
     // Emit particles
     void emit(int count = 1) {
+        if (usesCompact()) {
+            emitCompact(count);
+            return;
+        }
         for (int i = 0; i < count && activeParticles.size() < maxParticles; ++i) {
             Particle* p = getPooledParticle();
             if (!p) break;
@@ -588,7 +807,7 @@ struct ParticleEmitter {
             p->distortionAmount = distortionAmount;
 
             // Trail
-            p->maxTrailLength = enableTrails ? trailLength : 0;
+            p->maxTrailLength = enableTrails ? std::min(trailLength, Quality::get().maxTrailLength) : 0;
             p->trailFadeRate = trailFadeRate;
 
             // Behaviors
@@ -604,7 +823,8 @@ struct ParticleEmitter {
             p->collides = enableCollision;
             p->collisionRadius = p->startSize / 2;
 
-            // Custom spawn callback
+            // Custom spawn callback, starting from the attribute defaults
+            attributes.reset(p->slot);
             if (onParticleSpawn) {
                 onParticleSpawn(*p);
             }
@@ -637,6 +857,8 @@ struct ParticleEmitter {
             emit(numToEmit);
         }
 
+        compactParticles.update(dt, compactForces());
+
         // Update particles
         auto it = activeParticles.begin();
         while (it != activeParticles.end()) {
@@ -708,42 +930,95 @@ struct ParticleEmitter {
             returnToPool(std::move(p));
         }
         activeParticles.clear();
+        compactParticles.clear();
     }
 
     // Draw particles
-    void draw(SDL_Renderer* renderer, Draw& draw) {
-        // Sort particles by blend mode for proper rendering
+    void draw(Draw& draw) {
+        sortForDraw();
+        drawParticles(draw);
+    }
+
+    // Sort particles by blend mode for proper rendering, and sample the
+    // colour table compact particles index
+    void sortForDraw() {
         std::stable_sort(activeParticles.begin(), activeParticles.end(),
             [](const auto& a, const auto& b) {
                 return static_cast<int>(a->blendMode) < static_cast<int>(b->blendMode);
             });
 
-        // Draw each particle
-        for (auto& p : activeParticles) {
-            drawParticle(renderer, draw, *p);
+        if (compactParticles.count() > 0) {
+            compactColors.resize(CompactParticles::COLOR_STEPS);
+            for (int i = 0; i < CompactParticles::COLOR_STEPS; ++i) {
+                float t = (i + 0.5f) / CompactParticles::COLOR_STEPS;
+                compactColors[i] = sampleColorRamp(colorRamp, t, Color());
+            }
+        }
+    }
+
+    // Draw each particle in its current order, under the Draw transform
+    void drawParticles(Draw& draw) {
+        drawParticles(draw, 0, getParticleCount());
+    }
+
+    // A slice of the sorted particles (full ones first, then compact);
+    // slices only read the emitter, so recording Draws can draw them from
+    // several threads at once
+    void drawParticles(Draw& draw, size_t begin, size_t end) {
+        size_t full = activeParticles.size();
+        for (size_t i = begin; i < std::min(end, full); ++i) {
+            drawParticle(draw, *activeParticles[i]);
+        }
+        if (end > full) {
+            drawCompactParticles(draw, std::max(begin, full) - full,
+                std::min(end - full, compactParticles.count()));
+        }
+    }
+
+    // Same look as drawParticle for a Particle with the emitter's settings
+    // and the default fades
+    void drawCompactParticles(Draw& draw, size_t begin, size_t end) {
+        if (begin >= end || compactColors.empty()) return;
+        setBlendMode(draw, blendMode);
+        const CompactParticles& cp = compactParticles;
+        for (size_t i = begin; i < end; ++i) {
+            float t = cp.ageFraction(i);
+            float life = cp.lifetime(i);
+            float age = t * life;
+
+            float size = cp.startSize(i) * (1.0f - 0.9f * Utils::easeInOutCubic(t));
+            if (enablePulse) {
+                size *= 1.0f + std::sin(age * pulseRate * TWO_PI) * pulseAmount;
+            }
+
+            float alpha = 1.0f;
+            if (age < 0.1f) alpha *= age / 0.1f;
+            if (age > life - 0.2f) alpha *= 1.0f - (age - (life - 0.2f)) / 0.2f;
+            if (enableShimmer) {
+                alpha *= 0.75f + 0.25f * std::sin(age * shimmerRate * TWO_PI);
+            }
+
+            Color color = compactColors[cp.colorIndex(i)];
+            color.a *= Utils::clamp(alpha, 0.0f, 1.0f);
+            Vec2 pos(cp.x[i], cp.y[i]);
+
+            if (enableGlow) {
+                drawGlow(draw, pos, size * 2, color, glowIntensity);
+            }
+            drawShape(draw, shape, pos, size, cp.rotationRadians(i), color);
         }
+        draw.blend(SDL_BLENDMODE_BLEND);
     }
 
     // Draw individual particle
-    void drawParticle(SDL_Renderer* renderer, Draw& draw, Particle& particle) {
+    void drawParticle(Draw& draw, Particle& particle) {
         Color color = particle.getCurrentColor();
         float size = particle.size;
         float alpha = particle.getCurrentAlpha();
 
         color.a *= alpha;
 
-        // Set blend mode
-        switch (particle.blendMode) {
-        case BlendMode::ADD:
-            SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_ADD);
-            break;
-        case BlendMode::MULTIPLY:
-            SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_MUL);
-            break;
-        default:
-            SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
-            break;
-        }
+        setBlendMode(draw, particle.blendMode);
 
         // Draw trail
         if (!particle.trail.empty()) {
@@ -759,12 +1034,26 @@ struct ParticleEmitter {
         drawShape(draw, particle.shape, particle.position, size, particle.rotation, color);
 
         // Reset blend mode
-        SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
+        draw.blend(SDL_BLENDMODE_BLEND);
+    }
+
+    static void setBlendMode(Draw& draw, BlendMode mode) {
+        switch (mode) {
+        case BlendMode::ADD:
+            draw.blend(SDL_BLENDMODE_ADD);
+            break;
+        case BlendMode::MULTIPLY:
+            draw.blend(SDL_BLENDMODE_MUL);
+            break;
+        default:
+            draw.blend(SDL_BLENDMODE_BLEND);
+            break;
+        }
     }
 
     // Draw glow effect
     void drawGlow(Draw& draw, const Vec2& pos, float size, const Color& color, float intensity) {
-        int layers = static_cast<int>(5 * intensity);
+        int layers = static_cast<int>(Quality::get().glowLayers * intensity);
         for (int i = layers; i > 0; --i) {
             float t = static_cast<float>(i) / layers;
             Color glowColor = color;
@@ -799,6 +1088,28 @@ struct ParticleEmitter {
         }
     }
 
+    // Unit shapes are placed by the Draw transform, so their vertices are
+    // moved in one bulk pass instead of one Vec2::rotate each
+    void placeUnitShape(Draw& draw, const Vec2& pos, float size, float rotation) {
+        draw.push_transform();
+        draw.translate(pos.x, pos.y);
+        draw.rotate(rotation);
+        draw.scale(size, size);
+    }
+
+    void drawOutline(Draw& draw, ParticleShape shape, const Vec2& pos, float size, float rotation) {
+        placeUnitShape(draw, pos, size, rotation);
+        draw.polygon(unitShapeMesh(shape).points);
+        draw.pop_transform();
+    }
+
+    void fillShape(Draw& draw, ParticleShape shape, const Vec2& pos, float size, float rotation,
+        const SDL_Color& c) {
+        placeUnitShape(draw, pos, size, rotation);
+        draw.fill_mesh(unitShapeMesh(shape), c.r, c.g, c.b, c.a);
+        draw.pop_transform();
+    }
+
     // Draw particle shape
     void drawShape(Draw& draw, ParticleShape shape, const Vec2& pos, float size,
         float rotation, const Color& color) {
@@ -818,24 +1129,12 @@ struct ParticleEmitter {
         }
 
         case ParticleShape::STAR: {
-            auto points = Utils::generateStarPoints(5, size * 0.4f, size);
-            std::vector<SDL_FPoint> sdlPoints;
-            for (const auto& p : points) {
-                Vec2 rotated = p.rotate(rotation);
-                sdlPoints.push_back({ pos.x + rotated.x, pos.y + rotated.y });
-            }
-            draw.polygon(sdlPoints);
+            fillShape(draw, shape, pos, size, rotation, c);
             break;
         }
 
         case ParticleShape::HEXAGON: {
-            auto points = Utils::generatePolygonPoints(6, size);
-            std::vector<SDL_FPoint> sdlPoints;
-            for (const auto& p : points) {
-                Vec2 rotated = p.rotate(rotation);
-                sdlPoints.push_back({ pos.x + rotated.x, pos.y + rotated.y });
-            }
-            draw.polygon(sdlPoints);
+            drawOutline(draw, shape, pos, size, rotation);
             break;
         }
 
@@ -848,24 +1147,12 @@ struct ParticleEmitter {
         }
 
         case ParticleShape::HEART: {
-            auto points = Utils::generateHeartPoints(size);
-            std::vector<SDL_FPoint> sdlPoints;
-            for (const auto& p : points) {
-                Vec2 rotated = p.rotate(rotation);
-                sdlPoints.push_back({ pos.x + rotated.x, pos.y + rotated.y });
-            }
-            draw.polygon(sdlPoints);
+            fillShape(draw, shape, pos, size, rotation, c);
             break;
         }
 
         case ParticleShape::TRIANGLE: {
-            auto points = Utils::generatePolygonPoints(3, size);
-            std::vector<SDL_FPoint> sdlPoints;
-            for (const auto& p : points) {
-                Vec2 rotated = p.rotate(rotation);
-                sdlPoints.push_back({ pos.x + rotated.x, pos.y + rotated.y });
-            }
-            draw.polygon(sdlPoints);
+            drawOutline(draw, shape, pos, size, rotation);
             break;
         }
 
@@ -941,17 +1228,13 @@ struct ParticleEmitter {
         }
 
         case ParticleShape::SMOKE_PUFF: {
-            // Draw cloud-like shape
-            for (int i = 0; i < 5; ++i) {
-                float angle = (i / 5.0f) * TWO_PI;
-                float offsetRadius = size * 0.5f;
-                Vec2 offset = Vec2::fromAngle(angle, offsetRadius);
-                draw.fill_circle(static_cast<int>(pos.x + offset.x),
-                    static_cast<int>(pos.y + offset.y),
-                    static_cast<int>(size * 0.6f));
-            }
-            draw.fill_circle(static_cast<int>(pos.x), static_cast<int>(pos.y),
-                static_cast<int>(size * 0.7f));
+            // Bumpy cloud outline, filled in one call (was six scanline circles)
+            fillShape(draw, shape, pos, size, rotation, c);
+            break;
+        }
+
+        case ParticleShape::GEAR: {
+            fillShape(draw, shape, pos, size, rotation, c);
             break;
         }
 
@@ -965,7 +1248,111 @@ struct ParticleEmitter {
 
     // Get particle count
     size_t getParticleCount() const {
-        return activeParticles.size();
+        return activeParticles.size() + compactParticles.count();
+    }
+};
+
+// One placement of an instanced effect
+struct EmitterInstance {
+    Vec2 position;
+    float rotation = 0;
+    float scale = 1;
+    Color tint = Color(1.0f, 1.0f, 1.0f, 1.0f); // Multiplied into every particle colour
+    float timeOffset = 0; // Seconds into the loop; picks the nearest phase copy
+
+    EmitterInstance(const Vec2& pos = Vec2(), float offset = 0) : position(pos), timeOffset(offset) {}
+};
+
+// Ambient effect placed many times (torches along a wall, smoke columns,
+// door dust): the looping simulation runs once per phase copy in local space
+// around the origin and is drawn at every instance's transform with its
+// tint, so the simulation cost does not grow with the number of placements.
+// Phase copies are pre-warmed `period / phases` apart so neighbouring
+// instances do not flicker in lockstep. Particles keep their local frame:
+// gravity, force fields and collision rects rotate and scale with the
+// instance.
+class InstancedEmitter {
+private:
+    std::vector<std::unique_ptr<ParticleEmitter>> phases;
+    std::vector<EmitterInstance> instances;
+    float period;
+
+    static constexpr float WARMUP_STEP = 1.0f / 30.0f;
+
+    int phaseFor(float timeOffset) const {
+        float t = std::fmod(timeOffset, period);
+        if (t < 0) t += period;
+        int count = static_cast<int>(phases.size());
+        return static_cast<int>(t / period * count + 0.5f) % count;
+    }
+
+public:
+    // setup configures one emitter; its position is overridden to the origin
+    InstancedEmitter(const std::function<void(ParticleEmitter&)>& setup, int phaseCount = 1,
+        float loopPeriod = 2.0f) : period(std::max(loopPeriod, WARMUP_STEP)) {
+        phaseCount = std::max(phaseCount, 1);
+        for (int i = 0; i < phaseCount; ++i) {
+            auto emitter = std::make_unique<ParticleEmitter>();
+            setup(*emitter);
+            emitter->position = { 0, 0 };
+            // A full loop fills the copy, then each gets its own head start
+            float warmup = period + period * i / phaseCount;
+            for (float t = 0; t < warmup; t += WARMUP_STEP) {
+                emitter->update(WARMUP_STEP);
+            }
+            phases.push_back(std::move(emitter));
+        }
+    }
+
+    EmitterInstance& addInstance(const Vec2& position, float timeOffset = 0) {
+        instances.emplace_back(position, timeOffset);
+        return instances.back();
+    }
+
+    std::vector<EmitterInstance>& getInstances() { return instances; }
+    size_t getInstanceCount() const { return instances.size(); }
+    int getPhaseCount() const { return static_cast<int>(phases.size()); }
+
+    void update(float dt) {
+        for (auto& phase : phases) {
+            phase->update(dt);
+        }
+    }
+
+    void clear() {
+        for (auto& phase : phases) {
+            phase->clear();
+        }
+    }
+
+    void draw(Draw& draw) {
+        for (auto& phase : phases) {
+            phase->sortForDraw();
+        }
+
+        // Instance tints apply on top of the caller's, which is restored after
+        SDL_Color outer = draw.tint_color;
+        for (const EmitterInstance& instance : instances) {
+            SDL_Color tint = instance.tint.toSDL();
+            draw.apply_tint(tint.r, tint.g, tint.b, tint.a);
+            draw.push_transform();
+            draw.translate(instance.position.x, instance.position.y);
+            draw.rotate(instance.rotation);
+            draw.scale(instance.scale, instance.scale);
+            draw.tint(tint.r, tint.g, tint.b, tint.a);
+            phases[phaseFor(instance.timeOffset)]->drawParticles(draw);
+            draw.pop_transform();
+            draw.tint_color = outer;
+        }
+    }
+
+    // Particles simulated, not drawn
+    size_t getParticleCount() const {
+        size_t count = 0;
+        for (const auto& phase : phases) {
+            count += phase->getParticleCount();
+        }
+        return count;
     }
 };
 
@@ -984,7 +1371,24 @@ private:
 
     // Particle system
     std::vector<std::unique_ptr<ParticleEmitter>> emitters;
+    std::vector<std::unique_ptr<InstancedEmitter>> instancedEmitters;
     int currentEffectIndex;
+
+    // Water presets run as SPH liquid unless toggled back to ballistic
+    // particles (W); the solver spreads over the worker pool
+    ThreadPool workers;
+    std::unique_ptr<SphFluid> liquid;
+    bool liquidMode;
+
+    // Particle vertices are recorded on the same pool, in slices of one
+    // emitter, and submitted in order on the main thread
+    static constexpr size_t PARTICLES_PER_DRAW_JOB = 512;
+    struct DrawJob {
+        size_t emitter; // Index into emitters, then instancedEmitters
+        size_t begin, end;
+    };
+    std::vector<DrawJob> drawJobs;
+    DrawArena drawArena;
     std::vector<std::string> effectNames;
 
     // Mouse state
@@ -996,11 +1400,31 @@ private:
     bool showHelp;
     bool paused;
 
+    // F9 render trace capture (one file per effect, for render_replay)
+    static constexpr int CAPTURE_FRAMES = 120;
+    RenderTrace trace;
+    bool traceRecording;
+
     // Performance tracking
     int frameCount;
     float fpsTimer;
     float currentFPS;
 
+    // Stats readout, sampled a few times a second so the cached panel is
+    // not repainted every frame
+    static constexpr float STATS_INTERVAL = 0.25f;
+    struct StatsSample {
+        int particles = 0;
+        size_t emitters = 0;
+        DrawStats draw;
+    };
+    StatsSample statsSample;
+    float statsTimer;
+
+    // Overlay panels, repainted only when what they show changes
+    enum HudWidget { HUD_STATS, HUD_HELP, HUD_EFFECT_NAME };
+    HudLayer hud;
+
     // Screen dimensions
     static constexpr int SCREEN_WIDTH = 1280;
     static constexpr int SCREEN_HEIGHT = 720;
@@ -1008,9 +1432,10 @@ private:
 public:
     ParticleTestbed() : window(nullptr), renderer(nullptr), running(true),
         deltaTime(0), lastFrameTime(0), currentEffectIndex(0),
-        mouseX(0), mouseY(0), mousePressed(false),
+        liquidMode(true), mouseX(0), mouseY(0), mousePressed(false),
         showStats(true), showHelp(false), paused(false),
-        frameCount(0), fpsTimer(0), currentFPS(0) {
+        trace(SCREEN_WIDTH, SCREEN_HEIGHT), traceRecording(false),
+        frameCount(0), fpsTimer(0), currentFPS(0), statsTimer(STATS_INTERVAL) {
         initEffectNames();
     }
 
@@ -1031,7 +1456,9 @@ public:
             "Galaxy",
             "Fountain",
             "Confetti",
-            "Mouse Trail"
+            "Mouse Trail",
+            "Waterfall",
+            "Torch Row (instanced)"
         };
     }
 
@@ -1067,6 +1494,9 @@ public:
         // Initialize utils
         Utils::initRandom();
 
+        // Pool sizes and glow layers below follow the machine's tier
+        Quality::init(renderer);
+
         // Load first effect
         loadEffect(0);
 
@@ -1077,6 +1507,8 @@ public:
 
     void cleanup() {
         emitters.clear();
+        instancedEmitters.clear();
+        liquid.reset();
 
         if (renderer) {
             SDL_DestroyRenderer(renderer);
@@ -1094,6 +1526,8 @@ public:
     void loadEffect(int index) {
         currentEffectIndex = index;
         emitters.clear();
+        instancedEmitters.clear();
+        liquid.reset();
 
         switch (index) {
         case 0: createFireEffect(); break;
@@ -1108,6 +1542,8 @@ public:
         case 9: createFountainEffect(); break;
         case 10: createConfettiEffect(); break;
         case 11: createMouseTrailEffect(); break;
+        case 12: createWaterfallEffect(); break;
+        case 13: createTorchRowEffect(); break;
         default: createFireEffect(); break;
         }
     }
@@ -1168,15 +1604,23 @@ public:
         emitter->shape = ParticleShape::STAR;
         emitter->blendMode = BlendMode::ADD;
         emitter->enableGlow = true;
-        emitter->enablePulse = true;
-        emitter->pulseRate = 2.0f;
-        emitter->pulseAmount = 0.3f;
         emitter->enableShimmer = true;
         emitter->shimmerRate = 5.0f;
 
         emitter->behaviors.push_back(ParticleBehavior::ORBIT);
         emitter->targetPosition = emitter->position;
 
+        // Sparks pulse out of step, each with its own phase
+        ParticleAttribute<float> phase = emitter->attributes.declare<float>("phase");
+        ParticleEmitter* magic = emitter.get();
+        emitter->onParticleSpawn = [magic, phase](Particle& p) {
+            magic->attributes.get(phase, p) = Utils::randomFloat(0, TWO_PI);
+        };
+        emitter->onParticleUpdate = [magic, phase](Particle& p) {
+            float pulse = std::sin(p.age * 2.0f * TWO_PI + magic->attributes.get(phase, p)) * 0.3f;
+            p.size = p.getCurrentSize() * (1.0f + pulse);
+        };
+
         ForceField field;
         field.position = emitter->position;
         field.radius = 100;
@@ -1293,6 +1737,7 @@ public:
         emitter->gravity = { 0, 30 };
         emitter->wind = { 20, 0 };
         emitter->behaviors.push_back(ParticleBehavior::WANDER);
+        emitter->compact = true;
 
         emitters.push_back(std::move(emitter));
     }
@@ -1377,11 +1822,29 @@ public:
         emitter->blendMode = BlendMode::ADD;
         emitter->enableGlow = true;
         emitter->enableShimmer = true;
+        emitter->compact = true;
 
         emitters.push_back(std::move(emitter));
     }
 
+    // Liquid over the whole screen; anything leaving it drains away
+    SphFluid& createLiquid() {
+        liquid = std::make_unique<SphFluid>(16384, &workers);
+        liquid->setBounds({ 0, 0, static_cast<float>(SCREEN_WIDTH), static_cast<float>(SCREEN_HEIGHT) });
+        return *liquid;
+    }
+
     void createFountainEffect() {
+        if (liquidMode) {
+            // Jet into a basin that overflows over its walls
+            SphFluid& fluid = createLiquid();
+            fluid.addSolid({ 240, 640, 800, 20 });
+            fluid.addSolid({ 220, 520, 20, 140 });
+            fluid.addSolid({ 1040, 520, 20, 140 });
+            fluid.addSource(Vec2(SCREEN_WIDTH / 2.0f, 630), Vec2(0, -420), 600, 10);
+            return;
+        }
+
         auto emitter = std::make_unique<ParticleEmitter>();
         emitter->position = { SCREEN_WIDTH / 2.0f, SCREEN_HEIGHT - 50 };
         emitter->emissionRate = 150;
@@ -1440,6 +1903,46 @@ public:
         emitters.push_back(std::move(emitter));
     }
 
+    void createWaterfallEffect() {
+        if (liquidMode) {
+            // Three ledges stepping down into an overflowing basin
+            SphFluid& fluid = createLiquid();
+            fluid.addSolid({ 60, 140, 260, 16 });
+            fluid.addSolid({ 300, 300, 280, 16 });
+            fluid.addSolid({ 560, 460, 300, 16 });
+            fluid.addSolid({ 700, 660, 520, 20 });
+            fluid.addSolid({ 680, 560, 20, 120 });
+            fluid.addSolid({ 1200, 560, 20, 120 });
+            fluid.addSource(Vec2(90, 110), Vec2(140, 0), 900, 20);
+            return;
+        }
+
+        auto emitter = std::make_unique<ParticleEmitter>();
+        emitter->position = { 320, 140 };
+        emitter->emissionRate = 300;
+        emitter->pattern = EmissionPattern::LINE;
+        emitter->patternRadius = 20;
+        emitter->rotation = HALF_PI;
+
+        emitter->lifetimeRange = { 2.0f, 3.0f };
+        emitter->sizeRange = { 3.0f, 6.0f };
+        emitter->speedRange = { 80.0f, 140.0f };
+        emitter->angleRange = { -0.1f, 0.1f };
+
+        emitter->colorRamp = {
+            ColorRampPoint(0.0f, Color(100, 150, 255, 200)),
+            ColorRampPoint(0.7f, Color(150, 200, 255, 150)),
+            ColorRampPoint(1.0f, Color(200, 220, 255, 0))
+        };
+
+        emitter->shape = ParticleShape::CIRCLE;
+        emitter->blendMode = BlendMode::NORMAL;
+        emitter->gravity = { 0, 400 };
+        emitter->drag = 0.99f;
+
+        emitters.push_back(std::move(emitter));
+    }
+
     void createMouseTrailEffect() {
         auto emitter = std::make_unique<ParticleEmitter>();
         emitter->emissionRate = 100;
@@ -1468,6 +1971,67 @@ public:
         emitters.push_back(std::move(emitter));
     }
 
+    // Sixteen torches and four smoke columns, simulated as five emitters
+    void createTorchRowEffect() {
+        auto torches = std::make_unique<InstancedEmitter>([](ParticleEmitter& e) {
+            e.emissionRate = 40;
+            e.pattern = EmissionPattern::CONE;
+            e.patternAngle = HALF_PI / 3;
+            e.patternRadius = 6;
+            e.rotation = -HALF_PI;
+            e.lifetimeRange = { 0.4f, 0.9f };
+            e.sizeRange = { 5.0f, 9.0f };
+            e.speedRange = { 30.0f, 70.0f };
+            e.angleRange = { -HALF_PI - 0.25f, -HALF_PI + 0.25f };
+            e.colorRamp = {
+                ColorRampPoint(0.0f, Color(255, 255, 200)),
+                ColorRampPoint(0.3f, Color(255, 180, 80)),
+                ColorRampPoint(1.0f, Color(120, 20, 0, 0))
+            };
+            e.shape = ParticleShape::FLAME;
+            e.blendMode = BlendMode::ADD;
+            e.glowIntensity = 0.8f;
+            e.gravity = { 0, -40 };
+            e.turbulence = 15;
+        }, 3, 0.9f);
+
+        for (int i = 0; i < 16; ++i) {
+            float x = SCREEN_WIDTH * (i % 8 + 0.5f) / 8.0f;
+            float y = i < 8 ? SCREEN_HEIGHT * 0.3f : SCREEN_HEIGHT * 0.65f;
+            EmitterInstance& torch = torches->addInstance({ x, y }, i * 0.37f);
+            // Cooler flames on the lower wall
+            if (i >= 8) torch.tint = Color(0.6f, 0.8f, 1.0f, 1.0f);
+        }
+        instancedEmitters.push_back(std::move(torches));
+
+        auto smoke = std::make_unique<InstancedEmitter>([](ParticleEmitter& e) {
+            e.emissionRate = 12;
+            e.pattern = EmissionPattern::CONE;
+            e.patternAngle = HALF_PI / 3;
+            e.rotation = -HALF_PI;
+            e.lifetimeRange = { 2.0f, 3.5f };
+            e.sizeRange = { 14.0f, 26.0f };
+            e.speedRange = { 20.0f, 40.0f };
+            e.angleRange = { -HALF_PI - 0.3f, -HALF_PI + 0.3f };
+            e.colorRamp = {
+                ColorRampPoint(0.0f, Color(140, 140, 140, 160)),
+                ColorRampPoint(1.0f, Color(60, 60, 60, 0))
+            };
+            e.shape = ParticleShape::SMOKE_PUFF;
+            e.blendMode = BlendMode::NORMAL;
+            e.enableGlow = false;
+            e.gravity = { 0, -15 };
+            e.turbulence = 20;
+        }, 2, 3.5f);
+
+        for (int i = 0; i < 4; ++i) {
+            EmitterInstance& column = smoke->addInstance(
+                { SCREEN_WIDTH * (i + 0.5f) / 4.0f, SCREEN_HEIGHT - 60.0f }, i * 1.7f);
+            column.scale = 0.8f + 0.15f * i;
+        }
+        instancedEmitters.push_back(std::move(smoke));
+    }
+
     void handleEvents() {
         SDL_Event event;
         while (SDL_PollEvent(&event)) {
@@ -1518,6 +2082,21 @@ public:
             for (auto& emitter : emitters) {
                 emitter->clear();
             }
+            for (auto& emitter : instancedEmitters) {
+                emitter->clear();
+            }
+            if (liquid) liquid->clear();
+            break;
+        case SDLK_W:
+            liquidMode = !liquidMode;
+            loadEffect(currentEffectIndex);
+            break;
+        case SDLK_F9:
+            if (!traceRecording) {
+                trace.clear();
+                draw.start_capture(trace, CAPTURE_FRAMES);
+                traceRecording = true;
+            }
             break;
         case SDLK_1: case SDLK_2: case SDLK_3: case SDLK_4: case SDLK_5:
         case SDLK_6: case SDLK_7: case SDLK_8: case SDLK_9:
@@ -1527,6 +2106,14 @@ public:
     }
 
     void handleMouseClick(float x, float y) {
+        // Drop a blob of liquid
+        if (liquid) {
+            for (int i = 0; i < 300; ++i) {
+                Vec2 offset = Vec2::fromAngle(Utils::randomFloat(0, TWO_PI), Utils::randomFloat(0, 40));
+                liquid->spawn(Vec2(x, y) + offset, Vec2(0, 0));
+            }
+        }
+
         // Create explosion at mouse position
         if (currentEffectIndex == 2) {
             emitters[0]->position = { x, y };
@@ -1551,6 +2138,13 @@ public:
 
             emitter->update(deltaTime);
         }
+        for (auto& emitter : instancedEmitters) {
+            emitter->update(deltaTime);
+        }
+
+        if (liquid) {
+            liquid->update(deltaTime);
+        }
 
         // Update FPS
         frameCount++;
@@ -1560,75 +2154,161 @@ public:
             frameCount = 0;
             fpsTimer = 0;
         }
+
+        statsTimer += deltaTime;
+        if (statsTimer >= STATS_INTERVAL) {
+            statsTimer = 0;
+            sampleStats();
+        }
+    }
+
+    void sampleStats() {
+        statsSample.particles = 0;
+        for (const auto& emitter : emitters) {
+            statsSample.particles += emitter->getParticleCount();
+        }
+        for (const auto& emitter : instancedEmitters) {
+            statsSample.particles += emitter->getParticleCount();
+        }
+        if (liquid) statsSample.particles += static_cast<int>(liquid->size());
+        statsSample.emitters = emitters.size() + instancedEmitters.size();
+        statsSample.draw = draw.frame_stats();
     }
 
     void render() {
         // Clear screen with gradient
-        for (int y = 0; y < SCREEN_HEIGHT; y += 2) {
+        int band = Quality::get().gradientBand;
+        for (int y = 0; y < SCREEN_HEIGHT; y += band) {
             int intensity = 20 + (y * 20 / SCREEN_HEIGHT);
             draw.color(intensity, intensity, intensity + 10);
-            draw.fill_rect(0, y, SCREEN_WIDTH, 2);
+            draw.fill_rect(0, y, SCREEN_WIDTH, band);
         }
 
-        // Draw particles
-        for (auto& emitter : emitters) {
-            emitter->draw(renderer, draw);
+        drawEmitters();
+
+        if (liquid) {
+            liquid->drawSolids(draw);
+            liquid->drawSurface(draw);
         }
 
         // Draw UI
         drawUI();
 
         draw.present();
+
+        if (traceRecording && !draw.capturing()) {
+            traceRecording = false;
+            std::string path = "particles_" + std::to_string(currentEffectIndex + 1) + ".ktrace";
+            bool saved = trace.save(path);
+            SDL_Log("Render trace: %u frames, %zu bytes %s %s", trace.getFrameCount(),
+                trace.getByteSize(), saved ? "written to" : "could not be written to", path.c_str());
+        }
+    }
+
+    void drawEmitters() {
+        drawJobs.clear();
+        for (size_t i = 0; i < emitters.size(); ++i) {
+            emitters[i]->sortForDraw();
+            size_t count = emitters[i]->getParticleCount();
+            for (size_t begin = 0; begin < count; begin += PARTICLES_PER_DRAW_JOB) {
+                drawJobs.push_back({ i, begin, std::min(count, begin + PARTICLES_PER_DRAW_JOB) });
+            }
+        }
+        for (size_t i = 0; i < instancedEmitters.size(); ++i) {
+            drawJobs.push_back({ emitters.size() + i, 0, 0 });
+        }
+
+        drawArena.record(&workers, draw, drawJobs.size(), [this](size_t i, Draw& recorder) {
+            const DrawJob& job = drawJobs[i];
+            if (job.emitter < emitters.size()) {
+                emitters[job.emitter]->drawParticles(recorder, job.begin, job.end);
+            }
+            else {
+                instancedEmitters[job.emitter - emitters.size()]->draw(recorder);
+            }
+            });
+        drawArena.submit(draw);
     }
 
     void drawUI() {
+        hud.begin(draw, SCREEN_WIDTH, SCREEN_HEIGHT);
+
         if (showStats) {
-            drawStats();
+            const DrawStats& ds = statsSample.draw;
+            HudKey key;
+            key.add(static_cast<int>(currentFPS)).add(statsSample.particles).add(statsSample.emitters)
+                .add(ds.primitives).add(ds.sdl_calls).add(ds.vertices)
+                .add(ds.color_changes).add(ds.blend_changes)
+                .add(static_cast<long long>(ds.pixels)).add(paused);
+            hud.widget(draw, HUD_STATS, { 10, 10, 260, 200 }, key, [&](Draw&) { drawStats(); });
         }
 
         if (showHelp) {
-            drawHelp();
+            hud.widget(draw, HUD_HELP, { SCREEN_WIDTH / 2 - 200, SCREEN_HEIGHT / 2 - 150, 400, 300 },
+                HudKey(), [&](Draw&) { drawHelp(); });
         }
 
         // Draw effect name
-        draw.color(0, 0, 0, 180);
-        draw.fill_rect(SCREEN_WIDTH / 2 - 150, SCREEN_HEIGHT - 50, 300, 40);
-        draw.color(255, 255, 255);
-        draw.rect(SCREEN_WIDTH / 2 - 150, SCREEN_HEIGHT - 50, 300, 40);
+        const std::string& name = effectNames[currentEffectIndex];
+        hud.widget(draw, HUD_EFFECT_NAME, { SCREEN_WIDTH / 2 - 150, SCREEN_HEIGHT - 50, 300, 40 },
+            HudKey().add(name), [&](Draw&) {
+                draw.color(0, 0, 0, 180);
+                draw.fill_rect(SCREEN_WIDTH / 2 - 150, SCREEN_HEIGHT - 50, 300, 40);
+                draw.color(255, 255, 255);
+                draw.rect(SCREEN_WIDTH / 2 - 150, SCREEN_HEIGHT - 50, 300, 40);
+
+                draw.color(255, 255, 255);
+                SDL_RenderDebugText(renderer, SCREEN_WIDTH / 2 - name.length() * 4,
+                    SCREEN_HEIGHT - 35, name.c_str());
+            });
 
-        SDL_SetRenderDrawColor(renderer, 255, 255, 255, 255);
-        std::string name = effectNames[currentEffectIndex];
-        SDL_RenderDebugText(renderer, SCREEN_WIDTH / 2 - name.length() * 4,
-            SCREEN_HEIGHT - 35, name.c_str());
+        hud.end(draw);
     }
 
     void drawStats() {
         draw.color(0, 0, 0, 200);
-        draw.fill_rect(10, 10, 200, 100);
+        draw.fill_rect(10, 10, 260, 200);
         draw.color(255, 255, 255);
-        draw.rect(10, 10, 200, 100);
+        draw.rect(10, 10, 260, 200);
 
-        SDL_SetRenderDrawColor(renderer, 255, 255, 255, 255);
+        draw.color(255, 255, 255);
 
         std::stringstream ss;
         ss << "FPS: " << static_cast<int>(currentFPS);
         SDL_RenderDebugText(renderer, 20, 20, ss.str().c_str());
 
-        int totalParticles = 0;
-        for (const auto& emitter : emitters) {
-            totalParticles += emitter->getParticleCount();
-        }
-
         ss.str("");
-        ss << "Particles: " << totalParticles;
+        ss << "Particles: " << statsSample.particles;
         SDL_RenderDebugText(renderer, 20, 40, ss.str().c_str());
 
         ss.str("");
-        ss << "Emitters: " << emitters.size();
+        ss << "Emitters: " << statsSample.emitters;
         SDL_RenderDebugText(renderer, 20, 60, ss.str().c_str());
 
+        // Renderer cost of a recent frame
+        const DrawStats& ds = statsSample.draw;
+        ss.str("");
+        ss << "Draw calls: " << ds.primitives;
+        SDL_RenderDebugText(renderer, 20, 80, ss.str().c_str());
+
+        ss.str("");
+        ss << "SDL calls: " << ds.sdl_calls;
+        SDL_RenderDebugText(renderer, 20, 100, ss.str().c_str());
+
+        ss.str("");
+        ss << "Vertices: " << ds.vertices;
+        SDL_RenderDebugText(renderer, 20, 120, ss.str().c_str());
+
+        ss.str("");
+        ss << "Color/blend changes: " << ds.color_changes << "/" << ds.blend_changes;
+        SDL_RenderDebugText(renderer, 20, 140, ss.str().c_str());
+
+        ss.str("");
+        ss << "Pixels (est): " << static_cast<long long>(ds.pixels);
+        SDL_RenderDebugText(renderer, 20, 160, ss.str().c_str());
+
         if (paused) {
-            SDL_RenderDebugText(renderer, 20, 80, "PAUSED");
+            SDL_RenderDebugText(renderer, 20, 180, "PAUSED");
         }
     }
 
@@ -1638,7 +2318,7 @@ public:
         draw.color(255, 255, 255);
         draw.rect(SCREEN_WIDTH / 2 - 200, SCREEN_HEIGHT / 2 - 150, 400, 300);
 
-        SDL_SetRenderDrawColor(renderer, 255, 255, 255, 255);
+        draw.color(255, 255, 255);
         int y = SCREEN_HEIGHT / 2 - 130;
 
         SDL_RenderDebugText(renderer, SCREEN_WIDTH / 2 - 40, y, "CONTROLS");
@@ -1654,19 +2334,40 @@ public:
             "R - Restart effect");
         SDL_RenderDebugText(renderer, SCREEN_WIDTH / 2 - 180, y += 20,
             "C - Clear particles");
+        SDL_RenderDebugText(renderer, SCREEN_WIDTH / 2 - 180, y += 20,
+            "W - Water as SPH liquid / particles");
         SDL_RenderDebugText(renderer, SCREEN_WIDTH / 2 - 180, y += 20,
             "S - Toggle stats");
         SDL_RenderDebugText(renderer, SCREEN_WIDTH / 2 - 180, y += 20,
             "H - Toggle help");
+        SDL_RenderDebugText(renderer, SCREEN_WIDTH / 2 - 180, y += 20,
+            "F9 - Capture render trace");
         SDL_RenderDebugText(renderer, SCREEN_WIDTH / 2 - 180, y += 20,
             "ESC - Exit");
     }
 
+    void recordTelemetry(Uint64 updateTicks, Uint64 renderTicks) {
+        if (!Telemetry::instance().isEnabled()) return;
+        size_t particles = liquid ? liquid->size() : 0;
+        for (auto& emitter : emitters) particles += emitter->getParticleCount();
+
+        const DrawStats& stats = draw.frame_stats();
+        Telemetry::record(TelemetryKind::FRAME_US, static_cast<Uint32>(deltaTime * 1000000.0f));
+        Telemetry::record(TelemetryKind::UPDATE_US, Telemetry::microseconds(updateTicks));
+        Telemetry::record(TelemetryKind::RENDER_US, Telemetry::microseconds(renderTicks));
+        Telemetry::record(TelemetryKind::PARTICLES, static_cast<Uint32>(particles));
+        Telemetry::record(TelemetryKind::DRAW_CALLS, static_cast<Uint32>(stats.primitives));
+        Telemetry::record(TelemetryKind::SDL_CALLS, static_cast<Uint32>(stats.sdl_calls));
+    }
+
     void run() {
         while (running) {
             handleEvents();
+            Uint64 updateStart = SDL_GetPerformanceCounter();
             update();
+            Uint64 renderStart = SDL_GetPerformanceCounter();
             render();
+            recordTelemetry(renderStart - updateStart, SDL_GetPerformanceCounter() - renderStart);
 
             // Cap framerate to 60 FPS
             SDL_Delay(16);
@@ -1676,8 +2377,6 @@ public:
 
 //// Main entry point
 //int main(int argc, char* argv[]) {
-//    (void)argc; (void)argv;
-//
 //    SDL_SetAppMetadata("Particle System Testbed", "1.0", "com.example.particles");
 //
 //    ParticleTestbed testbed;
@@ -1686,6 +2385,12 @@ public:
 //        return -1;
 //    }
 //
+//    // --telemetry writes particles_telemetry_N.ktel for telemetry_decode
+//    for (int i = 1; i < argc; ++i) {
+//        if (std::strcmp(argv[i], "--telemetry") == 0) Telemetry::instance().start("particles_telemetry");
+//    }
+//
 //    testbed.run();
+//    Telemetry::instance().stop();
 //    return 0;
 //}
\ No newline at end of file
@@ -13,6 +13,10 @@
 #include <map>
 #include <unordered_map>
 #include "renderer2d.cpp"
+#include "asset_manager.cpp"
+#include "synth.cpp"
+#include "hud_layer.cpp"
+#include "quality_settings.cpp"
 
 // Constants
 static constexpr int SCREEN_WIDTH = 1200;
@@ -49,85 +53,51 @@ static std::uniform_real_distribution<float> rand_float(0.0f, 1.0f);
 static std::uniform_int_distribution<int> rand_int(0, 100);
 
 // Sound system
+// Effects are synthesised in the audio callback (synth.cpp), so there are
+// no clips to load; walking retriggers a varied footstep every STEP_INTERVAL.
 struct SoundSystem {
-    SDL_AudioStream* jump_sound = nullptr;
-    SDL_AudioStream* walk_sound = nullptr;
-    SDL_AudioStream* fireball_sound = nullptr;
-    SDL_AudioStream* music_stream = nullptr;
+    static constexpr Uint64 STEP_INTERVAL_MS = 280;
 
-    Uint8* jump_data = nullptr;
-    Uint32 jump_len = 0;
-    Uint8* walk_data = nullptr;
-    Uint32 walk_len = 0;
-    Uint8* fireball_data = nullptr;
-    Uint32 fireball_len = 0;
+    Synth synth;
+    SDL_AudioStream* music_stream = nullptr;
 
     bool walking_sound_playing = false;
+    Uint64 last_step = 0;
 
     void init() {
-        SDL_AudioSpec spec;
-
-        // Load sound effects
-        if (SDL_LoadWAV("sounds/jump.wav", &spec, &jump_data, &jump_len)) {
-            jump_sound = SDL_OpenAudioDeviceStream(SDL_AUDIO_DEVICE_DEFAULT_PLAYBACK, &spec, nullptr, nullptr);
-            if (jump_sound) SDL_ResumeAudioStreamDevice(jump_sound);
-        }
-
-        if (SDL_LoadWAV("sounds/walk.wav", &spec, &walk_data, &walk_len)) {
-            walk_sound = SDL_OpenAudioDeviceStream(SDL_AUDIO_DEVICE_DEFAULT_PLAYBACK, &spec, nullptr, nullptr);
-            if (walk_sound) SDL_ResumeAudioStreamDevice(walk_sound);
-        }
-
-        if (SDL_LoadWAV("sounds/fireball.wav", &spec, &fireball_data, &fireball_len)) {
-            fireball_sound = SDL_OpenAudioDeviceStream(SDL_AUDIO_DEVICE_DEFAULT_PLAYBACK, &spec, nullptr, nullptr);
-            if (fireball_sound) SDL_ResumeAudioStreamDevice(fireball_sound);
-        }
+        if (!synth.open()) SDL_Log("Sound effects unavailable: %s", SDL_GetError());
     }
 
     void play_jump() {
-        if (jump_sound && jump_data) {
-            SDL_ClearAudioStream(jump_sound);
-            SDL_PutAudioStreamData(jump_sound, jump_data, jump_len);
-        }
+        synth.play(SynthPresets::jump());
     }
 
     void play_fireball() {
-        if (fireball_sound && fireball_data) {
-            SDL_ClearAudioStream(fireball_sound);
-            SDL_PutAudioStreamData(fireball_sound, fireball_data, fireball_len);
-        }
+        synth.play(SynthPresets::fireball());
     }
 
     void start_walking() {
-        if (!walking_sound_playing && walk_sound && walk_data) {
+        if (!walking_sound_playing) {
             walking_sound_playing = true;
-            SDL_PutAudioStreamData(walk_sound, walk_data, walk_len);
+            last_step = 0;
         }
     }
 
     void stop_walking() {
-        if (walking_sound_playing && walk_sound) {
-            walking_sound_playing = false;
-            SDL_ClearAudioStream(walk_sound);
-        }
+        walking_sound_playing = false;
     }
 
     void update_walking() {
-        if (walking_sound_playing && walk_sound && walk_data) {
-            if (SDL_GetAudioStreamQueued(walk_sound) < (int)walk_len / 2) {
-                SDL_PutAudioStreamData(walk_sound, walk_data, walk_len);
-            }
+        Uint64 now = SDL_GetTicks();
+        if (walking_sound_playing && now - last_step >= STEP_INTERVAL_MS) {
+            last_step = now;
+            synth.play(SynthPresets::step(), 0.8f);
         }
     }
 
     void cleanup() {
-        if (jump_sound) SDL_DestroyAudioStream(jump_sound);
-        if (walk_sound) SDL_DestroyAudioStream(walk_sound);
-        if (fireball_sound) SDL_DestroyAudioStream(fireball_sound);
+        synth.close();
         if (music_stream) SDL_DestroyAudioStream(music_stream);
-        SDL_free(jump_data);
-        SDL_free(walk_data);
-        SDL_free(fireball_data);
     }
 };
 
@@ -1053,11 +1023,12 @@ struct Level {
 
     void draw_background(Draw& draw) {
         // Gradient background
-        for (int y = 0; y < SCREEN_HEIGHT; y++) {
+        int band = Quality::get().gradientBand;
+        for (int y = 0; y < SCREEN_HEIGHT; y += band) {
             float ratio = (float)y / SCREEN_HEIGHT;
             int gray = BACKGROUND.r * (1 - ratio * 0.3f);
             draw.color(gray, gray, gray);
-            draw.line(0, y, SCREEN_WIDTH, y);
+            draw.fill_rect(0, y, SCREEN_WIDTH, band);
         }
 
         // Fog particles
@@ -1271,10 +1242,11 @@ struct Menu {
 
     void draw(Draw& draw, SDL_Renderer* renderer) {
         // Background gradient
-        for (int y = 0; y < SCREEN_HEIGHT; y++) {
+        int band = Quality::get().gradientBand;
+        for (int y = 0; y < SCREEN_HEIGHT; y += band) {
             int gray = 160 - (y / (float)SCREEN_HEIGHT) * 60;
             draw.color(gray, gray, gray);
-            draw.line(0, y, SCREEN_WIDTH, y);
+            draw.fill_rect(0, y, SCREEN_WIDTH, band);
         }
 
         // Fog
@@ -1346,6 +1318,15 @@ private:
     Level* level;
     Player player;
     TransitionState transition;
+    std::unique_ptr<AssetManager> assets;
+
+    // Ability and key readouts, repainted only when they change
+    enum HudWidget { HUD_ABILITIES, HUD_HINT };
+    HudLayer hud;
+
+    // F9 render trace capture for render_replay
+    RenderTrace trace{ SCREEN_WIDTH, SCREEN_HEIGHT };
+    bool trace_recording = false;
     EndingScreen ending_screen;
     bool running;
     Uint64 last_time;
@@ -1381,6 +1362,9 @@ public:
         }
 
         draw.set_renderer(renderer);
+        Quality::init(renderer);
+        menu = Menu(); // Rebuilt so its fog follows the tier
+        assets = std::make_unique<AssetManager>(renderer);
         sound_system.init();
 
         load_levels();
@@ -1553,6 +1537,12 @@ public:
                 running = false;
             }
 
+            if (event.type == SDL_EVENT_KEY_DOWN && event.key.key == SDLK_F9 && !trace_recording) {
+                trace.clear();
+                draw.start_capture(trace, 120);
+                trace_recording = true;
+            }
+
             if (state == GameState::MENU) {
                 if (event.type == SDL_EVENT_MOUSE_BUTTON_DOWN) {
                     float x, y;
@@ -1576,6 +1566,8 @@ public:
         float dt = (current_time - last_time) / 1000.0f;
         last_time = current_time;
 
+        assets->update();
+
         float mouse_x, mouse_y;
         SDL_GetMouseState(&mouse_x, &mouse_y);
 
@@ -1660,27 +1652,35 @@ public:
             }
 
             // Abilities text
-            int ui_y = 20;
-            draw.color(LIGHT_GRAY.r, LIGHT_GRAY.g, LIGHT_GRAY.b);
-
-            if (player.double_jump_available) {
-                SDL_RenderDebugText(renderer, 20, ui_y, "Double Jump");
-                ui_y += 25;
-            }
+            hud.begin(draw, SCREEN_WIDTH, SCREEN_HEIGHT);
+            HudKey abilities;
+            abilities.add(player.double_jump_available).add(player.can_fireball).add(player.keys);
+            hud.widget(draw, HUD_ABILITIES, { 10, 10, 200, 80 }, abilities, [&](Draw& d) {
+                int ui_y = 20;
+                d.color(LIGHT_GRAY.r, LIGHT_GRAY.g, LIGHT_GRAY.b);
+
+                if (player.double_jump_available) {
+                    SDL_RenderDebugText(renderer, 20, ui_y, "Double Jump");
+                    ui_y += 25;
+                }
 
-            if (player.can_fireball) {
-                SDL_RenderDebugText(renderer, 20, ui_y, "Light: F");
-                ui_y += 25;
-            }
+                if (player.can_fireball) {
+                    SDL_RenderDebugText(renderer, 20, ui_y, "Light: F");
+                    ui_y += 25;
+                }
 
-            if (player.keys > 0) {
-                draw.color(WHITE.r, WHITE.g, WHITE.b);
-                SDL_RenderDebugTextFormat(renderer, 20, ui_y, "Keys: %d", player.keys);
-            }
+                if (player.keys > 0) {
+                    d.color(WHITE.r, WHITE.g, WHITE.b);
+                    SDL_RenderDebugTextFormat(renderer, 20, ui_y, "Keys: %d", player.keys);
+                }
+                });
 
             // Hint
-            draw.color(LIGHT_GRAY.r, LIGHT_GRAY.g, LIGHT_GRAY.b, 100);
-            SDL_RenderDebugText(renderer, 20, SCREEN_HEIGHT - 30, "S: Drop");
+            hud.widget(draw, HUD_HINT, { 10, SCREEN_HEIGHT - 40, 200, 30 }, HudKey(), [&](Draw& d) {
+                d.color(LIGHT_GRAY.r, LIGHT_GRAY.g, LIGHT_GRAY.b, 100);
+                SDL_RenderDebugText(renderer, 20, SCREEN_HEIGHT - 30, "S: Drop");
+                });
+            hud.end(draw);
 
         }
         else if (state == GameState::TRANSITIONING) {
@@ -1688,14 +1688,14 @@ public:
             draw.color(DARK_GRAY.r, DARK_GRAY.g, DARK_GRAY.b);
             draw.fill_rect(0, 0, SCREEN_WIDTH, SCREEN_HEIGHT);
 
-            // Draw sliding levels (simplified)
-            float old_x = -transition.offset_x;
-            float new_x = SCREEN_WIDTH - transition.offset_x;
-
-            // Just show a sliding effect
+            // Draw sliding levels (simplified): old level at 0, new one a
+            // screen to the right, both scrolled by one transform
+            draw.push_transform();
+            draw.translate(-transition.offset_x, 0);
             draw.color(SILHOUETTE.r, SILHOUETTE.g, SILHOUETTE.b);
-            draw.fill_rect(old_x, 0, SCREEN_WIDTH, SCREEN_HEIGHT);
-            draw.fill_rect(new_x, 0, SCREEN_WIDTH, SCREEN_HEIGHT);
+            draw.fill_rect(0, 0, SCREEN_WIDTH, SCREEN_HEIGHT);
+            draw.fill_rect(SCREEN_WIDTH, 0, SCREEN_WIDTH, SCREEN_HEIGHT);
+            draw.pop_transform();
 
         }
         else if (state == GameState::ENDING) {
@@ -1703,6 +1703,13 @@ public:
         }
 
         draw.present();
+
+        if (trace_recording && !draw.capturing()) {
+            trace_recording = false;
+            bool saved = trace.save("platformer.ktrace");
+            SDL_Log("Render trace: %u frames %s platformer.ktrace", trace.getFrameCount(),
+                saved ? "written to" : "could not be written to");
+        }
     }
 
     void run() {
@@ -1718,6 +1725,7 @@ public:
 
     ~Game() {
         sound_system.cleanup();
+        assets.reset();
         if (renderer) SDL_DestroyRenderer(renderer);
         if (window) SDL_DestroyWindow(window);
         SDL_Quit();
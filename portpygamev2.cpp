@@ -13,6 +13,7 @@
 #include <array>
 #include <sstream>
 #include "renderer2d.cpp"
+#include "synth.cpp"
 
 // Constants
 constexpr int SCREEN_WIDTH = 1200;
@@ -67,8 +68,15 @@ private:
     SDL_AudioStream* walking_stream;
     bool walking_playing;
 
+    // Effects are synthesised on the fly instead of loaded
+    static constexpr Uint64 STEP_INTERVAL_MS = 280;
+    Synth synth;
+    std::unordered_map<std::string, const SynthPatch*> patches;
+    Uint64 last_step;
+
 public:
-    AudioManager() : audio_device(0), music_stream(nullptr), walking_stream(nullptr), walking_playing(false) {}
+    AudioManager() : audio_device(0), music_stream(nullptr), walking_stream(nullptr), walking_playing(false),
+        last_step(0) {}
 
     ~AudioManager() {
         cleanup();
@@ -80,11 +88,16 @@ public:
             SDL_Log("Failed to open audio device: %s", SDL_GetError());
             return false;
         }
+        if (!synth.open()) {
+            SDL_Log("Sound effects unavailable: %s", SDL_GetError());
+        }
         return true;
     }
 
     void cleanup() {
         stopWalking();
+        synth.close();
+        patches.clear();
 
         for (auto& [name, stream] : sound_streams) {
             if (stream) {
@@ -111,6 +124,16 @@ public:
     }
 
     bool loadSound(const std::string& name, const std::string& filepath) {
+        // Effects are parameter sets, nothing to read or decode
+        const SynthPatch* patch = nullptr;
+        if (name == "jump") patch = &SynthPresets::jump();
+        else if (name == "walk") patch = &SynthPresets::step();
+        else if (name == "fireball") patch = &SynthPresets::fireball();
+        if (patch) {
+            patches[name] = patch;
+            return true;
+        }
+
         // Create dummy sound for now - in production, load actual WAV files
         SDL_AudioSpec spec;
         spec.freq = 44100;
@@ -136,6 +159,12 @@ public:
     }
 
     void playSound(const std::string& name, float volume = 1.0f) {
+        auto patch = patches.find(name);
+        if (patch != patches.end()) {
+            synth.play(*patch->second, volume);
+            return;
+        }
+
         auto it = sound_streams.find(name);
         if (it != sound_streams.end() && it->second) {
             SDL_SetAudioStreamGain(it->second, volume);
@@ -144,21 +173,19 @@ public:
         }
     }
 
+    // Called every frame while walking: a fresh, slightly varied footstep
+    // every STEP_INTERVAL_MS
     void startWalking(float volume = 0.4f) {
-        if (!walking_playing) {
+        Uint64 now = SDL_GetTicks();
+        if (!walking_playing || now - last_step >= STEP_INTERVAL_MS) {
             playSound("walk", volume);
+            last_step = now;
             walking_playing = true;
         }
     }
 
     void stopWalking() {
-        if (walking_playing) {
-            auto it = sound_streams.find("walk");
-            if (it != sound_streams.end() && it->second) {
-                SDL_ClearAudioStream(it->second);
-            }
-            walking_playing = false;
-        }
+        walking_playing = false;
     }
 
     void playMusic(const std::string& name, float volume = 0.4f) {
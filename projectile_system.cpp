@@ -0,0 +1,247 @@
+// projectile_system.cpp - Pooled projectiles (arrows) with swept hits and batched deflect
+// Projectiles are stored structure-of-arrays in a fixed-capacity pool: spawn
+// appends, despawn swaps the last live projectile into the hole, so both are
+// O(1) and the update loops stream through tightly packed arrays. Nothing
+// outside the system keeps a reference to a projectile, so they may move.
+#pragma once
+#include <SDL3/SDL.h>
+#include <vector>
+#include <cmath>
+#include <algorithm>
+#include <cstdint>
+#include "utils.cpp"
+#include "renderer2d.cpp"
+#include "spatial_grid.cpp"
+
+enum class ProjectileTeam : uint8_t {
+    PLAYER, // Deflected arrows; hit enemies
+    ENEMY   // Archer arrows; hit the player
+};
+
+struct ProjectileHit {
+    int target;          // Id returned by addTarget
+    Vec2 position;       // Point of impact on the target's box
+    Vec2 velocity;       // Projectile velocity at impact
+    float damage;
+};
+
+class ProjectileSystem {
+private:
+    // Structure of arrays, count live entries packed at the front
+    std::vector<float> posX, posY;
+    std::vector<float> velX, velY;
+    std::vector<float> life;
+    std::vector<float> damage;
+    std::vector<ProjectileTeam> team;
+    size_t count;
+    size_t capacity;
+
+    // Hurtbox broadphase, rebuilt every step
+    RectGrid targets;
+    std::vector<ProjectileTeam> targetTeams;
+
+    SDL_FRect bounds;   // Projectiles leaving this area (or below its bottom) expire
+    float gravity;      // Per 60 Hz frame, like entity physics
+    float radius;       // Collision radius added to every hurtbox
+
+    void despawn(size_t i) {
+        size_t last = --count;
+        posX[i] = posX[last]; posY[i] = posY[last];
+        velX[i] = velX[last]; velY[i] = velY[last];
+        life[i] = life[last];
+        damage[i] = damage[last];
+        team[i] = team[last];
+    }
+
+    // Entry time in [0, 1] of segment p0 + d*t into rect r, or -1 if it misses
+    static float sweepRect(float x0, float y0, float dx, float dy, const SDL_FRect& r) {
+        float tMin = 0.0f, tMax = 1.0f;
+
+        if (std::abs(dx) < 1e-6f) {
+            if (x0 < r.x || x0 > r.x + r.w) return -1.0f;
+        }
+        else {
+            float inv = 1.0f / dx;
+            float t1 = (r.x - x0) * inv, t2 = (r.x + r.w - x0) * inv;
+            if (t1 > t2) std::swap(t1, t2);
+            tMin = std::max(tMin, t1);
+            tMax = std::min(tMax, t2);
+        }
+
+        if (std::abs(dy) < 1e-6f) {
+            if (y0 < r.y || y0 > r.y + r.h) return -1.0f;
+        }
+        else {
+            float inv = 1.0f / dy;
+            float t1 = (r.y - y0) * inv, t2 = (r.y + r.h - y0) * inv;
+            if (t1 > t2) std::swap(t1, t2);
+            tMin = std::max(tMin, t1);
+            tMax = std::min(tMax, t2);
+        }
+
+        return tMin <= tMax ? tMin : -1.0f;
+    }
+
+public:
+    explicit ProjectileSystem(size_t maxProjectiles = 8192)
+        : count(0), capacity(maxProjectiles), bounds{ 0, 0, 0, 0 },
+        gravity(0.0f), radius(2.0f) {
+        posX.resize(capacity); posY.resize(capacity);
+        velX.resize(capacity); velY.resize(capacity);
+        life.resize(capacity);
+        damage.resize(capacity);
+        team.resize(capacity);
+    }
+
+    void setBounds(const SDL_FRect& area) {
+        bounds = area;
+        targets.reset(area, 256.0f);
+    }
+
+    void setGravity(float g) { gravity = g; }
+    void setRadius(float r) { radius = r; }
+
+    // Velocity in pixels per 60 Hz frame. Returns false when the pool is full.
+    bool spawn(Vec2 position, Vec2 velocity, float dmg, ProjectileTeam owner, float lifetime = 4.0f) {
+        if (count == capacity) return false;
+        size_t i = count++;
+        posX[i] = position.x; posY[i] = position.y;
+        velX[i] = velocity.x; velY[i] = velocity.y;
+        life[i] = lifetime;
+        damage[i] = dmg;
+        team[i] = owner;
+        return true;
+    }
+
+    void clear() { count = 0; }
+
+    // ===== TARGETS =====
+    // Register this step's hurtboxes; ids are dense from 0 in call order
+    void clearTargets() {
+        targets.clear();
+        targetTeams.clear();
+    }
+
+    int addTarget(const SDL_FRect& hurtbox, ProjectileTeam side) {
+        SDL_FRect r = { hurtbox.x - radius, hurtbox.y - radius,
+                        hurtbox.w + radius * 2, hurtbox.h + radius * 2 };
+        targetTeams.push_back(side);
+        return targets.insert(r);
+    }
+
+    // ===== UPDATE =====
+    // Advances every projectile along its path for this step and tests the
+    // whole segment against the hurtboxes near it, so fast arrows cannot
+    // tunnel. Each projectile hits at most the first box it enters and is
+    // then removed; hits are appended to `hits`.
+    void update(float dt, std::vector<ProjectileHit>& hits) {
+        float step = dt * 60.0f;
+        float fall = gravity * step;
+        float floorY = bounds.y + bounds.h;
+        bool anyTargets = targets.size() > 0;
+
+        size_t i = 0;
+        while (i < count) {
+            velY[i] += fall;
+            float x0 = posX[i], y0 = posY[i];
+            float dx = velX[i] * step, dy = velY[i] * step;
+            life[i] -= dt;
+
+            int hitTarget = -1;
+            float hitT = 2.0f;
+            if (anyTargets) {
+                SDL_FRect sweep = { std::min(x0, x0 + dx), std::min(y0, y0 + dy),
+                                    std::abs(dx), std::abs(dy) };
+                ProjectileTeam side = team[i];
+                targets.query(sweep, [&](int id, const SDL_FRect& r) {
+                    if (targetTeams[id] == side) return;
+                    float t = sweepRect(x0, y0, dx, dy, r);
+                    if (t >= 0.0f && t < hitT) {
+                        hitT = t;
+                        hitTarget = id;
+                    }
+                    });
+            }
+
+            if (hitTarget >= 0) {
+                hits.push_back({ hitTarget, Vec2(x0 + dx * hitT, y0 + dy * hitT),
+                                 Vec2(velX[i], velY[i]), damage[i] });
+                despawn(i);
+                continue;
+            }
+
+            posX[i] = x0 + dx;
+            posY[i] = y0 + dy;
+            if (life[i] <= 0 || posY[i] >= floorY ||
+                posX[i] < bounds.x || posX[i] > bounds.x + bounds.w) {
+                despawn(i);
+                continue;
+            }
+            ++i;
+        }
+    }
+
+    // ===== DEFLECT =====
+    // Reflects every projectile not owned by `side` that lies inside the arc
+    // (origin, reach, facing angle +- halfArc) back out along the arc's
+    // normal at its position, and hands it to `side`. One linear pass over
+    // the pool; returns how many were deflected.
+    int deflect(Vec2 origin, float reach, float facing, float halfArc,
+        ProjectileTeam side, float speedScale = 1.25f) {
+        float fx = std::cos(facing), fy = std::sin(facing);
+        float cosArc = std::cos(halfArc);
+        float reachSq = reach * reach;
+        int deflected = 0;
+
+        for (size_t i = 0; i < count; ++i) {
+            if (team[i] == side) continue;
+
+            float rx = posX[i] - origin.x, ry = posY[i] - origin.y;
+            float distSq = rx * rx + ry * ry;
+            if (distSq > reachSq || distSq < 1e-6f) continue;
+
+            float dist = std::sqrt(distSq);
+            if (rx * fx + ry * fy < cosArc * dist) continue;
+
+            // v' = v - 2 (v.n) n, with n pointing out from the origin
+            float nx = rx / dist, ny = ry / dist;
+            float vn = velX[i] * nx + velY[i] * ny;
+            if (vn < 0) {
+                velX[i] -= 2 * vn * nx;
+                velY[i] -= 2 * vn * ny;
+            }
+            velX[i] *= speedScale;
+            velY[i] *= speedScale;
+            team[i] = side;
+            ++deflected;
+        }
+        return deflected;
+    }
+
+    // ===== DRAW =====
+    // Arrows as short shafts along their velocity; only those inside visible
+    void draw(Draw& draw, const SDL_FRect& visible) const {
+        const ProjectileTeam sides[] = { ProjectileTeam::ENEMY, ProjectileTeam::PLAYER };
+        for (ProjectileTeam side : sides) {
+            if (side == ProjectileTeam::ENEMY) draw.color(120, 80, 40);
+            else draw.color(120, 220, 255);
+
+            for (size_t i = 0; i < count; ++i) {
+                if (team[i] != side) continue;
+                float x = posX[i], y = posY[i];
+                if (x < visible.x || x > visible.x + visible.w ||
+                    y < visible.y || y > visible.y + visible.h) continue;
+
+                float speed = std::sqrt(velX[i] * velX[i] + velY[i] * velY[i]);
+                float k = speed > 0 ? 14.0f / speed : 0.0f;
+                draw.line(x - velX[i] * k, y - velY[i] * k, x, y);
+            }
+        }
+    }
+
+    size_t size() const { return count; }
+    size_t getCapacity() const { return capacity; }
+    Vec2 getPosition(size_t i) const { return Vec2(posX[i], posY[i]); }
+    Vec2 getVelocity(size_t i) const { return Vec2(velX[i], velY[i]); }
+    ProjectileTeam getTeam(size_t i) const { return team[i]; }
+};
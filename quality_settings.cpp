@@ -0,0 +1,219 @@
+// quality_settings.cpp - Visual quality tiers, picked once per machine by a startup calibration
+// Every knob that trades looks for fill rate lives in QualitySettings: glow
+// rings, trail length, particle pool size, gradient band height.
+// On first launch Quality::init() times a short representative workload
+// (an emitter-style particle update plus glow circles and gradient bands
+// drawn into an offscreen target), maps the cost to a tier and saves it in
+// the SDL pref dir, shared by every game. Later launches just load the file.
+// CPPSDL_QUALITY=low|medium|high|ultra overrides the tier for one run.
+// Without a renderer (headless tools) the tier stays HIGH, the old defaults.
+#pragma once
+#include <SDL3/SDL.h>
+#include <vector>
+#include <string>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+#include "renderer2d.cpp"
+
+enum class QualityTier : uint8_t { LOW, MEDIUM, HIGH, ULTRA };
+
+struct QualitySettings {
+    QualityTier tier = QualityTier::HIGH;
+    int glowLayers = 5;          // Glow rings per unit of emitter glowIntensity
+    int maxTrailLength = 10;     // Cap on an emitter's trailLength
+    size_t maxParticles = 5000;  // Particle pool per emitter
+    int sparkGlowLayers = 3;     // Halo circles around a sword spark
+    int gradientBand = 2;        // Height in px of one background gradient band
+
+    static QualitySettings forTier(QualityTier tier) {
+        QualitySettings s;
+        s.tier = tier;
+        switch (tier) {
+        case QualityTier::LOW:
+            s.glowLayers = 1; s.maxTrailLength = 3; s.maxParticles = 1500;
+            s.sparkGlowLayers = 1; s.gradientBand = 8;
+            break;
+        case QualityTier::MEDIUM:
+            s.glowLayers = 3; s.maxTrailLength = 6; s.maxParticles = 3000;
+            s.sparkGlowLayers = 2; s.gradientBand = 4;
+            break;
+        case QualityTier::HIGH:
+            break;
+        case QualityTier::ULTRA:
+            s.glowLayers = 7; s.maxTrailLength = 16; s.maxParticles = 8000;
+            s.sparkGlowLayers = 4; s.gradientBand = 1;
+            break;
+        }
+        return s;
+    }
+};
+
+struct Quality {
+    // Calibration workload: roughly the effects of a busy HIGH-tier frame
+    static constexpr int CALIBRATION_PARTICLES = 5000;
+    static constexpr int CALIBRATION_GLOWS = 150;
+    static constexpr int CALIBRATION_SIZE = 512;
+    static constexpr int CALIBRATION_RUNS = 3;
+    // Workload cost (ms) that still fits each tier into a 60 Hz frame
+    static constexpr double ULTRA_MS = 4.0;  // A quarter of the frame
+    static constexpr double HIGH_MS = 8.0;   // Half
+    static constexpr double MEDIUM_MS = 16.0;
+
+    static QualitySettings& get() {
+        static QualitySettings settings;
+        return settings;
+    }
+
+    static void set(QualityTier tier) { get() = QualitySettings::forTier(tier); }
+
+    static const char* name(QualityTier tier) {
+        switch (tier) {
+        case QualityTier::LOW: return "low";
+        case QualityTier::MEDIUM: return "medium";
+        case QualityTier::HIGH: return "high";
+        case QualityTier::ULTRA: return "ultra";
+        }
+        return "high";
+    }
+
+    static bool parse(const char* text, QualityTier& tier) {
+        for (QualityTier t : { QualityTier::LOW, QualityTier::MEDIUM, QualityTier::HIGH, QualityTier::ULTRA }) {
+            if (std::strcmp(text, name(t)) == 0) {
+                tier = t;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    static QualityTier tierForCost(double ms) {
+        if (ms <= ULTRA_MS) return QualityTier::ULTRA;
+        if (ms <= HIGH_MS) return QualityTier::HIGH;
+        if (ms <= MEDIUM_MS) return QualityTier::MEDIUM;
+        return QualityTier::LOW;
+    }
+
+    // Shared by all the games so one calibration covers the machine
+    static std::string settingsPath() {
+        char* dir = SDL_GetPrefPath("cppsdl", "shared");
+        if (!dir) return "";
+        std::string path = std::string(dir) + "quality.cfg";
+        SDL_free(dir);
+        return path;
+    }
+
+    static bool load(const std::string& path, QualityTier& tier) {
+        if (path.empty()) return false;
+        FILE* file = std::fopen(path.c_str(), "r");
+        if (!file) return false;
+        char text[16] = {};
+        bool ok = std::fscanf(file, "tier=%15s", text) == 1 && parse(text, tier);
+        std::fclose(file);
+        return ok;
+    }
+
+    static bool save(const std::string& path, QualityTier tier, double costMs) {
+        if (path.empty()) return false;
+        FILE* file = std::fopen(path.c_str(), "w");
+        if (!file) return false;
+        std::fprintf(file, "tier=%s\ncost_ms=%.2f\n", name(tier), costMs);
+        std::fclose(file);
+        return true;
+    }
+
+    // Best of a few runs of the workload, in ms. The 1x1 readback waits for
+    // the GPU so the draw cost is measured, not just its submission.
+    static double calibrate(SDL_Renderer* renderer) {
+        SDL_Texture* target = renderer ? SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888,
+            SDL_TEXTUREACCESS_TARGET, CALIBRATION_SIZE, CALIBRATION_SIZE) : nullptr;
+        SDL_Texture* screen = renderer ? SDL_GetRenderTarget(renderer) : nullptr;
+        Draw draw(renderer);
+
+        struct Body { float x, y, vx, vy, life; };
+        std::vector<Body> bodies(CALIBRATION_PARTICLES);
+        for (int i = 0; i < CALIBRATION_PARTICLES; ++i) {
+            float angle = i * 0.618f;
+            bodies[i] = { 256.0f, 256.0f, std::cos(angle) * 90.0f, std::sin(angle) * 90.0f, 2.0f };
+        }
+
+        double best = 1e9;
+        float sink = 0;
+        for (int run = 0; run < CALIBRATION_RUNS; ++run) {
+            Uint64 start = SDL_GetPerformanceCounter();
+
+            // Emitter-style update: gravity, drag, noise wobble, ageing
+            const float dt = 1.0f / 60.0f;
+            for (int step = 0; step < 4; ++step) {
+                for (Body& b : bodies) {
+                    b.vx = b.vx * 0.99f + std::sin(b.y * 0.05f) * 2.0f * dt;
+                    b.vy = b.vy * 0.99f + 98.0f * dt;
+                    b.x += b.vx * dt;
+                    b.y += b.vy * dt;
+                    b.life -= dt;
+                    sink += b.life;
+                }
+            }
+
+            if (target) {
+                SDL_SetRenderTarget(renderer, target);
+                for (int y = 0; y < CALIBRATION_SIZE; y += 2) {
+                    draw.color(20, 20, 20 + y * 40 / CALIBRATION_SIZE);
+                    draw.fill_rect(0, static_cast<float>(y), CALIBRATION_SIZE, 2);
+                }
+                draw.blend(SDL_BLENDMODE_ADD);
+                for (int i = 0; i < CALIBRATION_GLOWS; ++i) {
+                    const Body& b = bodies[i * (CALIBRATION_PARTICLES / CALIBRATION_GLOWS)];
+                    int x = static_cast<int>(b.x) & (CALIBRATION_SIZE - 1);
+                    int y = static_cast<int>(b.y) & (CALIBRATION_SIZE - 1);
+                    for (int layer = 5; layer > 0; --layer) {
+                        draw.color(255, 180, 80, 10 * layer);
+                        draw.fill_circle(x, y, 4 + layer * 3);
+                    }
+                }
+                draw.blend(SDL_BLENDMODE_BLEND);
+
+                SDL_Rect pixel = { 0, 0, 1, 1 };
+                SDL_Surface* readback = SDL_RenderReadPixels(renderer, &pixel);
+                if (readback) SDL_DestroySurface(readback);
+                SDL_SetRenderTarget(renderer, screen);
+            }
+
+            double ms = (SDL_GetPerformanceCounter() - start) * 1000.0 / SDL_GetPerformanceFrequency();
+            best = std::min(best, ms);
+        }
+
+        if (target) SDL_DestroyTexture(target);
+        volatile float keep = sink; // Keeps the update loop from being optimised out
+        (void)keep;
+        return best;
+    }
+
+    // Call once after the renderer exists, before building effects
+    static QualityTier init(SDL_Renderer* renderer) {
+        QualityTier tier = QualityTier::HIGH;
+        const char* forced = std::getenv("CPPSDL_QUALITY");
+        if (forced && parse(forced, tier)) {
+            SDL_Log("Quality: %s (CPPSDL_QUALITY)", name(tier));
+        }
+        else if (!renderer) {
+            tier = QualityTier::HIGH;
+        }
+        else {
+            std::string path = settingsPath();
+            if (load(path, tier)) {
+                SDL_Log("Quality: %s", name(tier));
+            }
+            else {
+                double ms = calibrate(renderer);
+                tier = tierForCost(ms);
+                save(path, tier, ms);
+                SDL_Log("Quality: calibrated %.2f ms -> %s", ms, name(tier));
+            }
+        }
+        set(tier);
+        return tier;
+    }
+};
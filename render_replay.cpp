@@ -0,0 +1,348 @@
+// render_replay.cpp - Replays captured Draw traces and times each renderer path
+// Traces are written by Draw::start_capture (F9 in katanastick, the particle
+// testbed and the platformer). Each trace is replayed against:
+//   immediate - one SDL call per recorded primitive on the GPU renderer
+//   batched   - runs of rects/points (and fill_circle scanlines) merged into
+//               single SDL_RenderFillRects/SDL_RenderRects/SDL_RenderPoints calls
+//   software  - the immediate stream on SDL's software renderer
+// Geometry batches (draws recorded on worker threads, see draw_arena.cpp) are
+// one op and replay as one SDL_RenderGeometry in every mode.
+// --record writes the software replay's frames through FrameRecorder (a .y4m
+// path gives one stream, anything else is a PPM sequence prefix), so CI can
+// keep reference frames and check that recording leaves frame times flat.
+//
+// Usage: render_replay <trace.ktrace>... [--mode immediate|batched|software|all] [--repeat N]
+//                      [--record out.y4m|prefix]
+#include <SDL3/SDL.h>
+#include <SDL3/SDL_main.h>
+#include <vector>
+#include <string>
+#include <cstdio>
+#include <cstring>
+#include <cstdlib>
+#include <cmath>
+#include <algorithm>
+#include "renderer2d.cpp"
+#include "frame_recorder.cpp"
+
+enum class ReplayMode { IMMEDIATE, BATCHED, SOFTWARE };
+
+static const char* modeName(ReplayMode mode) {
+    switch (mode) {
+    case ReplayMode::IMMEDIATE: return "immediate";
+    case ReplayMode::BATCHED: return "batched";
+    case ReplayMode::SOFTWARE: return "software";
+    }
+    return "?";
+}
+
+// ===== BATCHER =====
+// Collects consecutive same-kind primitives and flushes them as one call.
+// Any state change or different primitive flushes first, so the result is
+// identical to the immediate stream.
+class ReplayBatcher {
+private:
+    enum Kind { NONE, FILL_RECTS, RECTS, POINTS };
+
+    Draw& draw;
+    Kind kind = NONE;
+    std::vector<SDL_FRect> rects;
+    std::vector<SDL_FPoint> points;
+
+public:
+    explicit ReplayBatcher(Draw& d) : draw(d) {}
+
+    void flush() {
+        if (kind == FILL_RECTS) draw.fill_rects(rects.data(), static_cast<int>(rects.size()));
+        else if (kind == RECTS) draw.rects(rects.data(), static_cast<int>(rects.size()));
+        else if (kind == POINTS) draw.points(points);
+        rects.clear();
+        points.clear();
+        kind = NONE;
+    }
+
+    void begin(Kind k) {
+        if (kind != k) flush();
+        kind = k;
+    }
+
+    void fillRect(const SDL_FRect& r) { begin(FILL_RECTS); rects.push_back(r); }
+    void rect(const SDL_FRect& r) { begin(RECTS); rects.push_back(r); }
+    void point(float x, float y) { begin(POINTS); points.push_back({ x, y }); }
+
+    void pointRun(const SDL_FPoint* pts, int count) {
+        begin(POINTS);
+        points.insert(points.end(), pts, pts + count);
+    }
+
+    // Same scanlines as Draw::fill_circle, emitted as 1px-high rects
+    void fillCircle(int cx, int cy, int radius) {
+        if (radius <= 0) return;
+        begin(FILL_RECTS);
+        int rsquared = radius * radius;
+        for (int dy = -radius; dy <= radius; ++dy) {
+            int dx = static_cast<int>(std::sqrt(rsquared - dy * dy));
+            rects.push_back({ static_cast<float>(cx - dx), static_cast<float>(cy + dy),
+                              static_cast<float>(2 * dx + 1), 1.0f });
+        }
+    }
+};
+
+// ===== REPLAY =====
+// Plays one frame (up to OP_FRAME_END). Returns false at end of trace.
+static bool replayFrame(RenderTrace::Reader& in, Draw& draw, bool batched) {
+    ReplayBatcher batch(draw);
+    int count;
+
+    while (!in.done()) {
+        auto op = static_cast<RenderTrace::Op>(in.get<uint8_t>());
+        switch (op) {
+        case RenderTrace::OP_COLOR: {
+            Uint8 r = in.get<Uint8>(), g = in.get<Uint8>(), b = in.get<Uint8>(), a = in.get<Uint8>();
+            batch.flush();
+            draw.color(r, g, b, a);
+            break;
+        }
+        case RenderTrace::OP_BLEND:
+            batch.flush();
+            draw.blend(static_cast<SDL_BlendMode>(in.get<uint32_t>()));
+            break;
+        case RenderTrace::OP_CLEAR:
+            batch.flush();
+            draw.clear();
+            break;
+        case RenderTrace::OP_POINT: {
+            float x = in.get<float>(), y = in.get<float>();
+            if (batched) batch.point(x, y);
+            else draw.point(x, y);
+            break;
+        }
+        case RenderTrace::OP_POINTS: {
+            const SDL_FPoint* pts = in.getPoints(count);
+            if (batched) batch.pointRun(pts, count);
+            else draw.points(pts, count);
+            break;
+        }
+        case RenderTrace::OP_LINE: {
+            float x1 = in.get<float>(), y1 = in.get<float>();
+            float x2 = in.get<float>(), y2 = in.get<float>();
+            batch.flush();
+            draw.line(x1, y1, x2, y2);
+            break;
+        }
+        case RenderTrace::OP_LINES: {
+            const SDL_FPoint* pts = in.getPoints(count);
+            batch.flush();
+            draw.lines(pts, count);
+            break;
+        }
+        case RenderTrace::OP_RECT:
+        case RenderTrace::OP_FILL_RECT: {
+            SDL_FRect r;
+            r.x = in.get<float>(); r.y = in.get<float>();
+            r.w = in.get<float>(); r.h = in.get<float>();
+            bool filled = op == RenderTrace::OP_FILL_RECT;
+            if (batched) {
+                if (filled) batch.fillRect(r);
+                else batch.rect(r);
+            }
+            else if (filled) draw.fill_rect(r.x, r.y, r.w, r.h);
+            else draw.rect(r.x, r.y, r.w, r.h);
+            break;
+        }
+        case RenderTrace::OP_CIRCLE:
+        case RenderTrace::OP_FILL_CIRCLE: {
+            int cx = static_cast<int>(in.get<float>());
+            int cy = static_cast<int>(in.get<float>());
+            int radius = static_cast<int>(in.get<float>());
+            if (op == RenderTrace::OP_CIRCLE) {
+                batch.flush();
+                draw.circle(cx, cy, radius);
+            }
+            else if (batched) batch.fillCircle(cx, cy, radius);
+            else draw.fill_circle(cx, cy, radius);
+            break;
+        }
+        case RenderTrace::OP_FILL_POLYGON: {
+            Uint8 r = in.get<Uint8>(), g = in.get<Uint8>(), b = in.get<Uint8>(), a = in.get<Uint8>();
+            const SDL_FPoint* pts = in.getPoints(count);
+            batch.flush();
+            draw.fill_polygon(std::vector<SDL_FPoint>(pts, pts + count), r, g, b, a);
+            break;
+        }
+        case RenderTrace::OP_GEOMETRY: {
+            const SDL_Vertex* verts;
+            const int* indices;
+            int indexCount;
+            if (!in.getGeometry(verts, count, indices, indexCount)) return false;
+            batch.flush();
+            draw.submit_geometry(verts, count, indices, indexCount);
+            break;
+        }
+        case RenderTrace::OP_CLIP: {
+            bool enabled = in.get<uint8_t>() != 0;
+            SDL_Rect r;
+            r.x = in.get<int32_t>(); r.y = in.get<int32_t>();
+            r.w = in.get<int32_t>(); r.h = in.get<int32_t>();
+            batch.flush();
+            draw.screen_clip(enabled ? &r : nullptr);
+            break;
+        }
+        case RenderTrace::OP_FRAME_END:
+            batch.flush();
+            return true;
+        default:
+            std::fprintf(stderr, "Corrupt trace (op %d)\n", static_cast<int>(op));
+            return false;
+        }
+    }
+    batch.flush();
+    return false;
+}
+
+struct ReplayResult {
+    int frames = 0;
+    double totalMs = 0;
+    double worstMs = 0;
+    DrawStats stats; // Summed over all frames
+};
+
+static ReplayResult replayTrace(const RenderTrace& trace, SDL_Renderer* renderer,
+    ReplayMode mode, int repeat, FrameRecorder* recorder = nullptr) {
+    Draw draw(renderer);
+    ReplayResult result;
+    double toMs = 1000.0 / SDL_GetPerformanceFrequency();
+    bool batched = mode == ReplayMode::BATCHED;
+
+    for (int r = 0; r < repeat; ++r) {
+        RenderTrace::Reader in(trace);
+        while (!in.done()) {
+            Uint64 start = SDL_GetPerformanceCounter();
+            if (recorder && r == 0) recorder->beginFrame(draw);
+            bool ok = replayFrame(in, draw, batched);
+            if (recorder) recorder->endFrame(draw);
+            draw.present();
+            double ms = (SDL_GetPerformanceCounter() - start) * toMs;
+
+            if (!ok) break; // Trailing partial frame or corrupt data
+            result.frames++;
+            result.totalMs += ms;
+            result.worstMs = std::max(result.worstMs, ms);
+            result.stats += draw.frame_stats();
+        }
+    }
+    return result;
+}
+
+static void printResult(const char* trace, ReplayMode mode, const ReplayResult& r) {
+    double n = std::max(1, r.frames);
+    std::printf("%-24s %-10s %6d frames  avg %8.3f ms  worst %8.3f ms  "
+        "prims %8.0f  sdl %8.0f  verts %9.0f\n",
+        trace, modeName(mode), r.frames, r.totalMs / n, r.worstMs,
+        r.stats.primitives / n, r.stats.sdl_calls / n, r.stats.vertices / n);
+}
+
+int main(int argc, char* argv[]) {
+    std::vector<std::string> paths;
+    std::vector<ReplayMode> modes = { ReplayMode::IMMEDIATE, ReplayMode::BATCHED, ReplayMode::SOFTWARE };
+    int repeat = 1;
+    std::string recordPath;
+
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--mode") == 0 && i + 1 < argc) {
+            std::string m = argv[++i];
+            if (m == "immediate") modes = { ReplayMode::IMMEDIATE };
+            else if (m == "batched") modes = { ReplayMode::BATCHED };
+            else if (m == "software") modes = { ReplayMode::SOFTWARE };
+            else if (m != "all") {
+                std::fprintf(stderr, "Unknown mode %s\n", m.c_str());
+                return 1;
+            }
+        }
+        else if (std::strcmp(argv[i], "--repeat") == 0 && i + 1 < argc) {
+            repeat = std::max(1, std::atoi(argv[++i]));
+        }
+        else if (std::strcmp(argv[i], "--record") == 0 && i + 1 < argc) {
+            recordPath = argv[++i];
+        }
+        else {
+            paths.push_back(argv[i]);
+        }
+    }
+
+    if (paths.empty()) {
+        std::fprintf(stderr,
+            "Usage: render_replay <trace.ktrace>... [--mode immediate|batched|software|all] [--repeat N]\n"
+            "                     [--record out.y4m|prefix]\n");
+        return 1;
+    }
+
+    if (!SDL_Init(SDL_INIT_VIDEO)) {
+        std::fprintf(stderr, "SDL_Init failed: %s\n", SDL_GetError());
+        return 1;
+    }
+
+    for (const auto& path : paths) {
+        RenderTrace trace;
+        if (!trace.load(path)) {
+            std::fprintf(stderr, "Could not read trace %s\n", path.c_str());
+            continue;
+        }
+
+        int w = static_cast<int>(std::max(1u, trace.width));
+        int h = static_cast<int>(std::max(1u, trace.height));
+        std::string name = path.substr(path.find_last_of("/\\") + 1);
+
+        for (ReplayMode mode : modes) {
+            SDL_Window* window = nullptr;
+            SDL_Surface* surface = nullptr;
+            SDL_Renderer* renderer = nullptr;
+
+            if (mode == ReplayMode::SOFTWARE) {
+                surface = SDL_CreateSurface(w, h, SDL_PIXELFORMAT_ARGB8888);
+                if (surface) renderer = SDL_CreateSoftwareRenderer(surface);
+            }
+            else {
+                window = SDL_CreateWindow("render_replay", w, h, SDL_WINDOW_HIDDEN);
+                if (window) renderer = SDL_CreateRenderer(window, nullptr);
+                if (renderer) SDL_SetRenderVSync(renderer, 0);
+            }
+
+            if (!renderer) {
+                std::fprintf(stderr, "%s: no %s renderer (%s)\n", name.c_str(),
+                    modeName(mode), SDL_GetError());
+            }
+            else if (mode == ReplayMode::SOFTWARE && !recordPath.empty()) {
+                // Several traces get numbered outputs so none overwrites another
+                std::string output = recordPath;
+                if (paths.size() > 1) {
+                    size_t dot = output.rfind(".y4m");
+                    std::string suffix = "_" + std::to_string(&path - paths.data());
+                    if (dot != std::string::npos) output.insert(dot, suffix);
+                    else output += suffix;
+                }
+                bool y4m = output.size() > 4 && output.compare(output.size() - 4, 4, ".y4m") == 0;
+
+                FrameRecorder recorder;
+                if (!recorder.start(renderer, output, y4m ? RecordFormat::Y4M : RecordFormat::PPM_SEQUENCE, w, h)) {
+                    std::fprintf(stderr, "%s: could not record to %s\n", name.c_str(), output.c_str());
+                }
+                printResult(name.c_str(), mode, replayTrace(trace, renderer, mode, repeat, &recorder));
+                int frames = recorder.stop();
+                std::printf("%-24s recorded %d frames to %s (%d dropped)\n",
+                    name.c_str(), frames, output.c_str(), recorder.getDropped());
+                SDL_DestroyRenderer(renderer);
+            }
+            else {
+                printResult(name.c_str(), mode, replayTrace(trace, renderer, mode, repeat));
+                SDL_DestroyRenderer(renderer);
+            }
+
+            if (surface) SDL_DestroySurface(surface);
+            if (window) SDL_DestroyWindow(window);
+        }
+    }
+
+    SDL_Quit();
+    return 0;
+}
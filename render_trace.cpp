@@ -0,0 +1,271 @@
+// render_trace.cpp - Compact binary trace of Draw calls for offline replay
+// Draw appends one record per primitive (already in screen space) while a
+// capture is active; render_replay plays traces back against different
+// renderer paths.
+//
+// File layout: "KTRC" | u32 version | u32 width | u32 height | u32 frames |
+// u64 byte count | op stream. Each op is a u8 opcode followed by its payload;
+// OP_FRAME_END closes a frame.
+#pragma once
+#include <SDL3/SDL.h>
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <cstring>
+#include <cstdio>
+
+class RenderTrace {
+public:
+    enum Op : uint8_t {
+        OP_COLOR,        // u8 r, g, b, a
+        OP_BLEND,        // u32 mode
+        OP_CLEAR,
+        OP_POINT,        // f32 x, y
+        OP_POINTS,       // u32 n, n * (f32 x, y)
+        OP_LINE,         // f32 x1, y1, x2, y2
+        OP_LINES,        // u32 n, n * (f32 x, y)
+        OP_RECT,         // f32 x, y, w, h
+        OP_FILL_RECT,    // f32 x, y, w, h
+        OP_CIRCLE,       // f32 cx, cy, r
+        OP_FILL_CIRCLE,  // f32 cx, cy, r
+        OP_FILL_POLYGON, // u8 r, g, b, a, u32 n, n * (f32 x, y)
+        OP_FRAME_END,
+        OP_CLIP,         // u8 enabled, i32 x, y, w, h (version 2)
+        OP_GEOMETRY,     // u32 n, n * (f32 x, y, u8 r, g, b, a), u32 m, m * i32 index (version 3)
+        OP_COUNT
+    };
+
+    // Later versions only add ops, so older traces still load
+    static constexpr uint32_t VERSION = 3;
+
+    uint32_t width = 0, height = 0;
+
+private:
+    std::vector<uint8_t> bytes;
+    uint32_t frames = 0;
+
+    template <typename T>
+    void put(const T& v) {
+        size_t at = bytes.size();
+        bytes.resize(at + sizeof(T));
+        std::memcpy(bytes.data() + at, &v, sizeof(T));
+    }
+
+    void putPoints(const SDL_FPoint* pts, int count) {
+        put<uint32_t>(static_cast<uint32_t>(count));
+        size_t at = bytes.size();
+        bytes.resize(at + sizeof(SDL_FPoint) * count);
+        std::memcpy(bytes.data() + at, pts, sizeof(SDL_FPoint) * count);
+    }
+
+public:
+    RenderTrace(uint32_t w = 0, uint32_t h = 0) : width(w), height(h) {}
+
+    void clear() {
+        bytes.clear();
+        frames = 0;
+    }
+
+    // ===== RECORDING =====
+    void color(Uint8 r, Uint8 g, Uint8 b, Uint8 a) {
+        put<uint8_t>(OP_COLOR);
+        put(r); put(g); put(b); put(a);
+    }
+
+    void blend(SDL_BlendMode mode) {
+        put<uint8_t>(OP_BLEND);
+        put<uint32_t>(static_cast<uint32_t>(mode));
+    }
+
+    void clearTarget() { put<uint8_t>(OP_CLEAR); }
+
+    void point(float x, float y) {
+        put<uint8_t>(OP_POINT);
+        put(x); put(y);
+    }
+
+    void points(const SDL_FPoint* pts, int count) {
+        put<uint8_t>(OP_POINTS);
+        putPoints(pts, count);
+    }
+
+    void line(float x1, float y1, float x2, float y2) {
+        put<uint8_t>(OP_LINE);
+        put(x1); put(y1); put(x2); put(y2);
+    }
+
+    void lines(const SDL_FPoint* pts, int count) {
+        put<uint8_t>(OP_LINES);
+        putPoints(pts, count);
+    }
+
+    void rect(const SDL_FRect& r, bool filled) {
+        put<uint8_t>(filled ? OP_FILL_RECT : OP_RECT);
+        put(r.x); put(r.y); put(r.w); put(r.h);
+    }
+
+    void circle(float cx, float cy, float radius, bool filled) {
+        put<uint8_t>(filled ? OP_FILL_CIRCLE : OP_CIRCLE);
+        put(cx); put(cy); put(radius);
+    }
+
+    void fillPolygon(const SDL_FPoint* pts, int count, Uint8 r, Uint8 g, Uint8 b, Uint8 a) {
+        put<uint8_t>(OP_FILL_POLYGON);
+        put(r); put(g); put(b); put(a);
+        putPoints(pts, count);
+    }
+
+    // One recorded batch (Draw::submit_geometry), replayed as one call
+    void geometry(const SDL_Vertex* verts, int count, const int* indices, int indexCount) {
+        put<uint8_t>(OP_GEOMETRY);
+        put<uint32_t>(static_cast<uint32_t>(count));
+        size_t at = bytes.size();
+        bytes.resize(at + (sizeof(SDL_FPoint) + 4) * count);
+        uint8_t* out = bytes.data() + at;
+        for (int i = 0; i < count; ++i) {
+            std::memcpy(out, &verts[i].position, sizeof(SDL_FPoint));
+            out += sizeof(SDL_FPoint);
+            const SDL_FColor& c = verts[i].color;
+            *out++ = static_cast<uint8_t>(c.r * 255 + 0.5f);
+            *out++ = static_cast<uint8_t>(c.g * 255 + 0.5f);
+            *out++ = static_cast<uint8_t>(c.b * 255 + 0.5f);
+            *out++ = static_cast<uint8_t>(c.a * 255 + 0.5f);
+        }
+        put<uint32_t>(static_cast<uint32_t>(indexCount));
+        at = bytes.size();
+        bytes.resize(at + sizeof(int32_t) * indexCount);
+        std::memcpy(bytes.data() + at, indices, sizeof(int32_t) * indexCount);
+    }
+
+    void clip(const SDL_Rect* r) {
+        put<uint8_t>(OP_CLIP);
+        put<uint8_t>(r ? 1 : 0);
+        SDL_Rect area = r ? *r : SDL_Rect{ 0, 0, 0, 0 };
+        put<int32_t>(area.x); put<int32_t>(area.y); put<int32_t>(area.w); put<int32_t>(area.h);
+    }
+
+    void endFrame() {
+        put<uint8_t>(OP_FRAME_END);
+        frames++;
+    }
+
+    uint32_t getFrameCount() const { return frames; }
+    size_t getByteSize() const { return bytes.size(); }
+    const std::vector<uint8_t>& getBytes() const { return bytes; }
+
+    // ===== FILE I/O =====
+    bool save(const std::string& path) const {
+        FILE* f = std::fopen(path.c_str(), "wb");
+        if (!f) return false;
+
+        uint64_t size = bytes.size();
+        bool ok = std::fwrite("KTRC", 1, 4, f) == 4;
+        ok = ok && std::fwrite(&VERSION, sizeof(VERSION), 1, f) == 1;
+        ok = ok && std::fwrite(&width, sizeof(width), 1, f) == 1;
+        ok = ok && std::fwrite(&height, sizeof(height), 1, f) == 1;
+        ok = ok && std::fwrite(&frames, sizeof(frames), 1, f) == 1;
+        ok = ok && std::fwrite(&size, sizeof(size), 1, f) == 1;
+        ok = ok && (size == 0 || std::fwrite(bytes.data(), 1, size, f) == size);
+        std::fclose(f);
+        return ok;
+    }
+
+    bool load(const std::string& path) {
+        FILE* f = std::fopen(path.c_str(), "rb");
+        if (!f) return false;
+
+        char magic[4];
+        uint32_t version = 0;
+        uint64_t size = 0;
+        bool ok = std::fread(magic, 1, 4, f) == 4 && std::memcmp(magic, "KTRC", 4) == 0;
+        ok = ok && std::fread(&version, sizeof(version), 1, f) == 1 &&
+            version >= 1 && version <= VERSION;
+        ok = ok && std::fread(&width, sizeof(width), 1, f) == 1;
+        ok = ok && std::fread(&height, sizeof(height), 1, f) == 1;
+        ok = ok && std::fread(&frames, sizeof(frames), 1, f) == 1;
+        ok = ok && std::fread(&size, sizeof(size), 1, f) == 1;
+        if (ok) {
+            bytes.resize(size);
+            ok = size == 0 || std::fread(bytes.data(), 1, size, f) == size;
+        }
+        std::fclose(f);
+        if (!ok) clear();
+        return ok;
+    }
+
+    // ===== READING =====
+    // Sequential decoder over the op stream
+    class Reader {
+    private:
+        const std::vector<uint8_t>& data;
+        size_t pos = 0;
+        std::vector<SDL_FPoint> points;
+        std::vector<SDL_Vertex> vertices;
+        std::vector<int> indices;
+
+    public:
+        explicit Reader(const RenderTrace& trace) : data(trace.bytes) {}
+
+        bool done() const { return pos >= data.size(); }
+        void rewind() { pos = 0; }
+
+        template <typename T>
+        T get() {
+            T v{};
+            if (pos + sizeof(T) <= data.size()) std::memcpy(&v, data.data() + pos, sizeof(T));
+            pos += sizeof(T);
+            return v;
+        }
+
+        // Ops are byte packed, so point runs are copied out to aligned
+        // storage; valid until the next getPoints call
+        const SDL_FPoint* getPoints(int& count) {
+            count = static_cast<int>(get<uint32_t>());
+            size_t size = sizeof(SDL_FPoint) * count;
+            if (pos + size > data.size()) {
+                count = 0;
+                pos = data.size();
+                return nullptr;
+            }
+            points.resize(count);
+            std::memcpy(points.data(), data.data() + pos, size);
+            pos += size;
+            return points.data();
+        }
+
+        // OP_GEOMETRY payload; valid until the next getGeometry call
+        bool getGeometry(const SDL_Vertex*& verts, int& count, const int*& idx, int& indexCount) {
+            count = static_cast<int>(get<uint32_t>());
+            size_t size = (sizeof(SDL_FPoint) + 4) * static_cast<size_t>(count);
+            if (pos + size > data.size()) {
+                pos = data.size();
+                return false;
+            }
+            vertices.resize(count);
+            const uint8_t* in = data.data() + pos;
+            for (int i = 0; i < count; ++i) {
+                SDL_Vertex& v = vertices[i];
+                std::memcpy(&v.position, in, sizeof(SDL_FPoint));
+                in += sizeof(SDL_FPoint);
+                v.color = { in[0] / 255.0f, in[1] / 255.0f, in[2] / 255.0f, in[3] / 255.0f };
+                v.tex_coord = { 0, 0 };
+                in += 4;
+            }
+            pos += size;
+
+            indexCount = static_cast<int>(get<uint32_t>());
+            size = sizeof(int32_t) * static_cast<size_t>(indexCount);
+            if (pos + size > data.size()) {
+                pos = data.size();
+                return false;
+            }
+            indices.resize(indexCount);
+            std::memcpy(indices.data(), data.data() + pos, size);
+            pos += size;
+
+            verts = vertices.data();
+            idx = indices.data();
+            return true;
+        }
+    };
+};
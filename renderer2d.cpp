@@ -3,11 +3,275 @@
 #include <SDL3/SDL.h>
 #include <vector>
 #include <cmath>
+#include <cstdio>
+#include <string>
 #include <algorithm>
+#include "render_trace.cpp"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define DRAW_SSE2 1
+#endif
+
+// Per-frame cost counters. Pixel counts are estimates in screen space
+// (areas for fills, lengths for outlines) before clipping.
+struct DrawStats {
+    Uint64 primitives = 0;    // Draw method calls
+    Uint64 sdl_calls = 0;     // Underlying SDL render/state calls
+    Uint64 vertices = 0;      // Points and vertices submitted
+    Uint64 color_changes = 0; // Draw colour set to a different value
+    Uint64 blend_changes = 0; // Blend mode set to a different value
+    double pixels = 0;        // Estimated pixels touched
+
+    DrawStats& operator+=(const DrawStats& o) {
+        primitives += o.primitives;
+        sdl_calls += o.sdl_calls;
+        vertices += o.vertices;
+        color_changes += o.color_changes;
+        blend_changes += o.blend_changes;
+        pixels += o.pixels;
+        return *this;
+    }
+
+    std::string to_string() const {
+        char buf[192];
+        std::snprintf(buf, sizeof(buf),
+            "prims %llu  sdl %llu  verts %llu  color %llu  blend %llu  px %.0fk",
+            (unsigned long long)primitives, (unsigned long long)sdl_calls,
+            (unsigned long long)vertices, (unsigned long long)color_changes,
+            (unsigned long long)blend_changes, pixels / 1000.0);
+        return buf;
+    }
+};
+
+// 2D affine transform: screen = (a*x + c*y + tx, b*x + d*y + ty)
+struct Transform2D {
+    float a = 1.0f, b = 0.0f, c = 0.0f, d = 1.0f, tx = 0.0f, ty = 0.0f;
+
+    static Transform2D translation(float x, float y) {
+        Transform2D t;
+        t.tx = x;
+        t.ty = y;
+        return t;
+    }
+
+    static Transform2D scaling(float x, float y) {
+        Transform2D t;
+        t.a = x;
+        t.d = y;
+        return t;
+    }
+
+    static Transform2D rotation(float radians) {
+        Transform2D t;
+        t.a = t.d = std::cos(radians);
+        t.b = std::sin(radians);
+        t.c = -t.b;
+        return t;
+    }
+
+    // Camera: world point (x, y) at the screen's top-left, scaled by zoom
+    static Transform2D view(float x, float y, float zoom) {
+        Transform2D t;
+        t.a = t.d = zoom;
+        t.tx = -x * zoom;
+        t.ty = -y * zoom;
+        return t;
+    }
+
+    // Applies m first, then this
+    Transform2D operator*(const Transform2D& m) const {
+        Transform2D t;
+        t.a = a * m.a + c * m.b;
+        t.b = b * m.a + d * m.b;
+        t.c = a * m.c + c * m.d;
+        t.d = b * m.c + d * m.d;
+        t.tx = a * m.tx + c * m.ty + tx;
+        t.ty = b * m.tx + d * m.ty + ty;
+        return t;
+    }
+
+    bool is_identity() const {
+        return a == 1.0f && b == 0.0f && c == 0.0f && d == 1.0f && tx == 0.0f && ty == 0.0f;
+    }
+
+    // No rotation or shear: rects stay rects
+    bool is_axis_aligned() const { return b == 0.0f && c == 0.0f; }
+
+    // Linear scale factor (sqrt of the area scale), for radii and pixel estimates
+    float scale() const { return std::sqrt(std::abs(a * d - b * c)); }
+
+    SDL_FPoint apply(float x, float y) const {
+        return { a * x + c * y + tx, b * x + d * y + ty };
+    }
+
+    // Bulk transform, two points per SSE2 register; out may alias in
+    void apply(const SDL_FPoint* in, SDL_FPoint* out, int count) const {
+        int i = 0;
+#ifdef DRAW_SSE2
+        const __m128 ab = _mm_setr_ps(a, b, a, b);
+        const __m128 cd = _mm_setr_ps(c, d, c, d);
+        const __m128 t = _mm_setr_ps(tx, ty, tx, ty);
+        for (; i + 2 <= count; i += 2) {
+            __m128 p = _mm_loadu_ps(&in[i].x);
+            __m128 xs = _mm_shuffle_ps(p, p, _MM_SHUFFLE(2, 2, 0, 0));
+            __m128 ys = _mm_shuffle_ps(p, p, _MM_SHUFFLE(3, 3, 1, 1));
+            _mm_storeu_ps(&out[i].x, _mm_add_ps(_mm_add_ps(_mm_mul_ps(xs, ab), _mm_mul_ps(ys, cd)), t));
+        }
+#endif
+        for (; i < count; ++i) {
+            out[i] = apply(in[i].x, in[i].y);
+        }
+    }
+};
+
+// ===== TRIANGULATION =====
+// Ear clipping for simple polygons, convex or concave, either winding. A
+// closing point that repeats the first is ignored. O(n^2): cache the result
+// (PolygonMesh) for anything drawn more than once.
+static inline void triangulate_polygon(const SDL_FPoint* pts, int count, std::vector<int>& indices) {
+    indices.clear();
+    if (count > 1 && pts[count - 1].x == pts[0].x && pts[count - 1].y == pts[0].y) count--;
+    if (count < 3) return;
+
+    auto cross = [pts](int o, int a, int b) {
+        return (pts[a].x - pts[o].x) * (pts[b].y - pts[o].y) -
+            (pts[a].y - pts[o].y) * (pts[b].x - pts[o].x);
+    };
+
+    float area2 = 0;
+    for (int i = 0; i < count; ++i) {
+        const SDL_FPoint& p = pts[i];
+        const SDL_FPoint& q = pts[(i + 1) % count];
+        area2 += p.x * q.y - q.x * p.y;
+    }
+    float winding = area2 >= 0 ? 1.0f : -1.0f;
+
+    std::vector<int> remaining(count);
+    for (int i = 0; i < count; ++i) remaining[i] = i;
+    indices.reserve((count - 2) * 3);
+
+    size_t at = 0, misses = 0;
+    while (remaining.size() > 3) {
+        size_t n = remaining.size();
+        at %= n;
+        int prev = remaining[(at + n - 1) % n], cur = remaining[at], next = remaining[(at + 1) % n];
+        float turn = cross(prev, cur, next) * winding;
+
+        // Collinear vertices and zero-width spikes add no area
+        bool ear = turn > 0;
+        if (turn == 0) {
+            remaining.erase(remaining.begin() + at);
+            misses = 0;
+            continue;
+        }
+
+        // No other vertex may lie inside (or on) the candidate ear
+        for (size_t k = 0; ear && k < n; ++k) {
+            int p = remaining[k];
+            if (p == prev || p == cur || p == next) continue;
+            if (cross(prev, cur, p) * winding >= 0 && cross(cur, next, p) * winding >= 0 &&
+                cross(next, prev, p) * winding >= 0) {
+                ear = false;
+            }
+        }
+
+        if (ear) {
+            indices.push_back(prev);
+            indices.push_back(cur);
+            indices.push_back(next);
+            remaining.erase(remaining.begin() + at);
+            misses = 0;
+        }
+        else if (++misses > n) {
+            // Self-intersecting input has no ear left: fan what remains
+            for (size_t k = 1; k + 1 < n; ++k) {
+                indices.push_back(remaining[0]);
+                indices.push_back(remaining[k]);
+                indices.push_back(remaining[k + 1]);
+            }
+            return;
+        }
+        else {
+            at++;
+        }
+    }
+    if (remaining.size() == 3) {
+        indices.insert(indices.end(), remaining.begin(), remaining.end());
+    }
+}
+
+// Outline plus its triangulation, built once. Meant for unit-size shapes
+// that are placed per instance with Draw's transform.
+struct PolygonMesh {
+    std::vector<SDL_FPoint> points; // Without a repeated closing point
+    std::vector<int> indices;
+
+    PolygonMesh() = default;
+
+    explicit PolygonMesh(std::vector<SDL_FPoint> outline) : points(std::move(outline)) {
+        if (points.size() > 1 && points.back().x == points.front().x &&
+            points.back().y == points.front().y) {
+            points.pop_back();
+        }
+        triangulate_polygon(points.data(), static_cast<int>(points.size()), indices);
+    }
+};
+
+// Triangles a recording Draw produced, already in screen space, so a worker
+// thread can build them without touching the renderer. Runs split the chunk
+// where the blend mode changes; indices are relative to the chunk.
+struct DrawChunk {
+    struct Run {
+        SDL_BlendMode blend;
+        int first_index;
+        int index_count;
+    };
+
+    std::vector<SDL_Vertex> vertices;
+    std::vector<int> indices;
+    std::vector<Run> runs;
+
+    // Keeps capacity so a reused chunk stops allocating after a few frames
+    void clear() {
+        vertices.clear();
+        indices.clear();
+        runs.clear();
+    }
+
+    bool empty() const { return indices.empty(); }
+};
 
 struct Draw {
     SDL_Renderer* renderer;
 
+    // Current transform (camera view, shake and zoom, plus any local
+    // translate/rotate/scale) and the ones saved by push_transform().
+    // Identity by default so screen-space callers are unaffected.
+    Transform2D xform;
+    std::vector<Transform2D> xform_stack;
+    // Screen-space clip rects from push_clip(); the back one is active
+    std::vector<SDL_Rect> clip_stack;
+    std::vector<SDL_FPoint> scratch;
+    std::vector<SDL_Vertex> geometry;  // fill_geometry vertices
+    std::vector<int> polygon_indices;  // fill_polygon triangulation
+
+    // stats accumulates the frame in progress; present() moves it to last_frame
+    DrawStats stats;
+    DrawStats last_frame;
+    SDL_Color current_color{ 0, 0, 0, 0 };
+    SDL_BlendMode current_blend = SDL_BLENDMODE_BLEND;
+    // Multiplied into every colour that follows (instance tints); white is off
+    SDL_Color tint_color{ 255, 255, 255, 255 };
+
+    // Active capture: every call is also appended to trace in screen space
+    RenderTrace* trace = nullptr;
+    int trace_frames_left = 0;
+
+    // Record mode (see record_into): primitives become triangles in chunk
+    // and no SDL call is made
+    DrawChunk* chunk = nullptr;
+
     Draw(SDL_Renderer* ren = nullptr) : renderer(ren) {
         if (renderer) {
             SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
@@ -19,70 +283,511 @@ struct Draw {
         if (renderer) {
             SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
         }
+        current_blend = SDL_BLENDMODE_BLEND;
+    }
+
+    // ===== TRANSFORM =====
+    void set_transform(const Transform2D& t) { xform = t; }
+    const Transform2D& transform() const { return xform; }
+
+    void push_transform() { xform_stack.push_back(xform); }
+
+    void pop_transform() {
+        if (xform_stack.empty()) return;
+        xform = xform_stack.back();
+        xform_stack.pop_back();
+    }
+
+    // Local changes apply to coordinates before the current transform
+    void translate(float x, float y) { xform = xform * Transform2D::translation(x, y); }
+    void rotate(float radians) { xform = xform * Transform2D::rotation(radians); }
+    void scale(float x, float y) { xform = xform * Transform2D::scaling(x, y); }
+
+    // Replaces the current transform with a camera view
+    void set_view(float x, float y, float zoom = 1.0f) { xform = Transform2D::view(x, y, zoom); }
+    void reset_view() { xform = Transform2D(); }
+    bool has_view() const { return !xform.is_identity(); }
+
+    SDL_FPoint to_screen(float x, float y) const { return xform.apply(x, y); }
+
+    // Transformed copy of pts, or pts itself when the transform is identity
+    const SDL_FPoint* to_screen(const SDL_FPoint* pts, int count) {
+        if (!has_view()) return pts;
+        scratch.resize(count);
+        xform.apply(pts, scratch.data(), count);
+        return scratch.data();
+    }
+
+    // ===== CLIP =====
+    // Clips to a rect in the current transform's space (its screen bounding
+    // box if rotated), intersected with the enclosing clip
+    void push_clip(float x, float y, float w, float h) {
+        SDL_FPoint corners[4] = { { x, y }, { x + w, y }, { x, y + h }, { x + w, y + h } };
+        xform.apply(corners, corners, 4);
+        float x0 = corners[0].x, y0 = corners[0].y, x1 = x0, y1 = y0;
+        for (const SDL_FPoint& p : corners) {
+            x0 = std::min(x0, p.x); x1 = std::max(x1, p.x);
+            y0 = std::min(y0, p.y); y1 = std::max(y1, p.y);
+        }
+
+        int left = static_cast<int>(std::floor(x0)), top = static_cast<int>(std::floor(y0));
+        int right = static_cast<int>(std::ceil(x1)), bottom = static_cast<int>(std::ceil(y1));
+        if (!clip_stack.empty()) {
+            const SDL_Rect& outer = clip_stack.back();
+            left = std::max(left, outer.x);
+            top = std::max(top, outer.y);
+            right = std::min(right, outer.x + outer.w);
+            bottom = std::min(bottom, outer.y + outer.h);
+        }
+        SDL_Rect r = { left, top, std::max(0, right - left), std::max(0, bottom - top) };
+        clip_stack.push_back(r);
+        screen_clip(&r);
+    }
+
+    void pop_clip() {
+        if (clip_stack.empty()) return;
+        clip_stack.pop_back();
+        screen_clip(clip_stack.empty() ? nullptr : &clip_stack.back());
+    }
+
+    // Sets the renderer clip in screen pixels (null: none), bypassing the stack
+    void screen_clip(const SDL_Rect* r) {
+        if (chunk) return; // Clips are not recorded; set them around the submit
+        stats.sdl_calls++;
+        if (trace) trace->clip(r);
+        SDL_SetRenderClipRect(renderer, r);
+    }
+
+    // ===== STATS =====
+    // Close the current frame's counters (present() does this)
+    void end_frame() {
+        last_frame = stats;
+        stats = DrawStats();
+    }
+
+    const DrawStats& frame_stats() const { return last_frame; }
+
+    // ===== CAPTURE =====
+    // Record the next `frames` presented frames (0 = until stop_capture)
+    void start_capture(RenderTrace& t, int frames) {
+        trace = &t;
+        trace_frames_left = frames;
+    }
+
+    void stop_capture() {
+        trace = nullptr;
+        trace_frames_left = 0;
+    }
+
+    bool capturing() const { return trace != nullptr; }
+
+    // ===== RECORDING =====
+    // Binds this Draw to chunk (null: back to immediate mode). A recording
+    // Draw never calls SDL, so each worker thread can own one; DrawArena
+    // submits the chunks on the main thread. Clips and textures are skipped.
+    void record_into(DrawChunk* c) { chunk = c; }
+    bool recording() const { return chunk != nullptr; }
+
+    // Starts or continues the run for the current blend mode, counts the
+    // indices about to be added and returns the index the next vertex gets
+    int record_reserve(int index_count) {
+        int base = static_cast<int>(chunk->vertices.size());
+        if (chunk->runs.empty() || chunk->runs.back().blend != current_blend) {
+            chunk->runs.push_back({ current_blend, static_cast<int>(chunk->indices.size()), 0 });
+        }
+        chunk->runs.back().index_count += index_count;
+        return base;
+    }
+
+    SDL_FColor record_color() const {
+        const SDL_Color& c = current_color;
+        return { c.r / 255.0f, c.g / 255.0f, c.b / 255.0f, c.a / 255.0f };
+    }
+
+    void record_quad(const SDL_FPoint* q, const SDL_FColor& color) {
+        int base = record_reserve(6);
+        for (int i = 0; i < 4; ++i) chunk->vertices.push_back({ q[i], color, { 0, 0 } });
+        for (int i : { 0, 1, 2, 0, 2, 3 }) chunk->indices.push_back(base + i);
+    }
+
+    void record_points(const SDL_FPoint* pts, int count) {
+        SDL_FColor color = record_color();
+        for (int i = 0; i < count; ++i) {
+            float x = std::floor(pts[i].x), y = std::floor(pts[i].y);
+            SDL_FPoint q[4] = { { x, y }, { x + 1, y }, { x + 1, y + 1 }, { x, y + 1 } };
+            record_quad(q, color);
+        }
+    }
+
+    // A one pixel wide quad covering the same pixels as SDL_RenderLine,
+    // end points included
+    void record_line(const SDL_FPoint& p, const SDL_FPoint& q) {
+        float dx = q.x - p.x, dy = q.y - p.y;
+        float len = std::sqrt(dx * dx + dy * dy);
+        if (len < 0.001f) {
+            record_points(&p, 1);
+            return;
+        }
+        float ux = dx / len * 0.5f, uy = dy / len * 0.5f;
+        float cx = 0.5f, cy = 0.5f; // Pixel centres
+        SDL_FPoint quad[4] = {
+            { p.x + cx - ux - uy, p.y + cy - uy + ux },
+            { q.x + cx + ux - uy, q.y + cy + uy + ux },
+            { q.x + cx + ux + uy, q.y + cy + uy - ux },
+            { p.x + cx - ux + uy, p.y + cy - uy - ux }
+        };
+        record_quad(quad, record_color());
+    }
+
+    // Filled: a fan around the centre. Outline: a one pixel band. Enough
+    // segments to keep the edge within half a pixel of the true circle.
+    void record_circle(const SDL_FPoint& center, float radius, bool filled) {
+        int segments = std::clamp(static_cast<int>(3.14159265f * std::sqrt(2.0f * radius)) + 1, 8, 64);
+        SDL_FColor color = record_color();
+        float cx = std::floor(center.x) + 0.5f, cy = std::floor(center.y) + 0.5f;
+        // Unit direction advanced by a fixed rotation instead of sin/cos per vertex
+        float step = 2.0f * 3.14159265f / segments;
+        float rc = std::cos(step), rs = std::sin(step);
+        float ux = 1, uy = 0;
+
+        int rings = filled ? 1 : 2;
+        int index_count = filled ? segments * 3 : segments * 6;
+        stats.vertices += index_count;
+        int base = record_reserve(index_count);
+        size_t v0 = chunk->vertices.size(), i0 = chunk->indices.size();
+        chunk->vertices.resize(v0 + segments * rings + (filled ? 1 : 0));
+        chunk->indices.resize(i0 + index_count);
+        SDL_Vertex* v = chunk->vertices.data() + v0;
+        int* idx = chunk->indices.data() + i0;
+
+        if (filled) {
+            radius += 0.5f;
+            *v++ = { { cx, cy }, color, { 0, 0 } };
+            for (int i = 0; i < segments; ++i) {
+                *v++ = { { cx + ux * radius, cy + uy * radius }, color, { 0, 0 } };
+                float nx = ux * rc - uy * rs;
+                uy = ux * rs + uy * rc;
+                ux = nx;
+                *idx++ = base;
+                *idx++ = base + 1 + i;
+                *idx++ = base + 1 + (i + 1) % segments;
+            }
+            return;
+        }
+
+        float inner = radius - 0.5f, outer = radius + 0.5f;
+        for (int i = 0; i < segments; ++i) {
+            *v++ = { { cx + ux * inner, cy + uy * inner }, color, { 0, 0 } };
+            *v++ = { { cx + ux * outer, cy + uy * outer }, color, { 0, 0 } };
+            float nx = ux * rc - uy * rs;
+            uy = ux * rs + uy * rc;
+            ux = nx;
+            int a = base + i * 2, b = base + ((i + 1) % segments) * 2;
+            *idx++ = a; *idx++ = a + 1; *idx++ = b + 1;
+            *idx++ = a; *idx++ = b + 1; *idx++ = b;
+        }
+    }
+
+    void record_triangles(const SDL_Vertex* verts, int count, const int* indices, int index_count) {
+        int base = record_reserve(index_count);
+        chunk->vertices.insert(chunk->vertices.end(), verts, verts + count);
+        for (int i = 0; i < index_count; ++i) chunk->indices.push_back(base + indices[i]);
+    }
+
+    // Main thread: one SDL_RenderGeometry for triangles recorded elsewhere,
+    // in the current blend mode. Captures store the batch as one op.
+    void submit_geometry(const SDL_Vertex* verts, int count, const int* indices, int index_count) {
+        if (count < 3 || index_count < 3) return;
+        stats.sdl_calls++;
+        if (trace) trace->geometry(verts, count, indices, index_count);
+        SDL_RenderGeometry(renderer, nullptr, verts, count, indices, index_count);
+    }
+
+    static float line_length(float x1, float y1, float x2, float y2) {
+        return std::max(std::abs(x2 - x1), std::abs(y2 - y1)) + 1.0f;
+    }
+
+    float polyline_length(const SDL_FPoint* pts, int count) const {
+        float len = 0;
+        for (int i = 1; i < count; ++i) {
+            len += line_length(pts[i - 1].x, pts[i - 1].y, pts[i].x, pts[i].y);
+        }
+        return len;
+    }
+
+    // ===== STATE =====
+    void tint(Uint8 r, Uint8 g, Uint8 b, Uint8 a = 255) { tint_color = { r, g, b, a }; }
+    void reset_tint() { tint_color = { 255, 255, 255, 255 }; }
+    bool tinted() const {
+        return (tint_color.r & tint_color.g & tint_color.b & tint_color.a) != 255;
+    }
+
+    void apply_tint(Uint8& r, Uint8& g, Uint8& b, Uint8& a) const {
+        if (!tinted()) return;
+        r = static_cast<Uint8>((r * tint_color.r + 127) / 255);
+        g = static_cast<Uint8>((g * tint_color.g + 127) / 255);
+        b = static_cast<Uint8>((b * tint_color.b + 127) / 255);
+        a = static_cast<Uint8>((a * tint_color.a + 127) / 255);
     }
 
     void color(Uint8 r, Uint8 g, Uint8 b, Uint8 a = 255) {
+        apply_tint(r, g, b, a);
+        if (r != current_color.r || g != current_color.g ||
+            b != current_color.b || a != current_color.a) {
+            current_color = { r, g, b, a };
+            stats.color_changes++;
+        }
+        if (chunk) return;
+        stats.sdl_calls++;
+        if (trace) trace->color(r, g, b, a);
         SDL_SetRenderDrawColor(renderer, r, g, b, a);
     }
 
+    void blend(SDL_BlendMode mode) {
+        if (mode != current_blend) {
+            current_blend = mode;
+            stats.blend_changes++;
+        }
+        if (chunk) return;
+        stats.sdl_calls++;
+        if (trace) trace->blend(mode);
+        SDL_SetRenderDrawBlendMode(renderer, mode);
+    }
+
     void clear() {
+        stats.sdl_calls++;
+        if (trace) trace->clearTarget();
         SDL_RenderClear(renderer);
     }
 
     void present() {
+        stats.sdl_calls++;
         SDL_RenderPresent(renderer);
+        end_frame();
+
+        if (trace) {
+            trace->endFrame();
+            if (trace_frames_left > 0 && --trace_frames_left == 0) {
+                trace = nullptr;
+            }
+        }
     }
 
+    // ===== PRIMITIVES =====
     void point(float x, float y) {
-        SDL_RenderPoint(renderer, x, y);
+        SDL_FPoint p = to_screen(x, y);
+        stats.primitives++;
+        stats.vertices++;
+        stats.pixels += 1;
+        if (chunk) {
+            record_points(&p, 1);
+            return;
+        }
+        stats.sdl_calls++;
+        if (trace) trace->point(p.x, p.y);
+        SDL_RenderPoint(renderer, p.x, p.y);
     }
 
     void points(const SDL_FPoint* pts, int count) {
-        SDL_RenderPoints(renderer, pts, count);
+        stats.primitives++;
+        stats.vertices += count;
+        stats.pixels += count;
+        const SDL_FPoint* screen = to_screen(pts, count);
+        if (chunk) {
+            record_points(screen, count);
+            return;
+        }
+        stats.sdl_calls++;
+        if (trace) trace->points(screen, count);
+        SDL_RenderPoints(renderer, screen, count);
     }
 
     void points(const std::vector<SDL_FPoint>& pts) {
-        SDL_RenderPoints(renderer, pts.data(), static_cast<int>(pts.size()));
+        points(pts.data(), static_cast<int>(pts.size()));
     }
 
     void line(float x1, float y1, float x2, float y2) {
-        SDL_RenderLine(renderer, x1, y1, x2, y2);
+        SDL_FPoint p = to_screen(x1, y1), q = to_screen(x2, y2);
+        stats.primitives++;
+        stats.vertices += 2;
+        stats.pixels += line_length(p.x, p.y, q.x, q.y);
+        if (chunk) {
+            record_line(p, q);
+            return;
+        }
+        stats.sdl_calls++;
+        if (trace) trace->line(p.x, p.y, q.x, q.y);
+        SDL_RenderLine(renderer, p.x, p.y, q.x, q.y);
     }
 
     void lines(const SDL_FPoint* pts, int count) {
-        SDL_RenderLines(renderer, pts, count);
+        stats.primitives++;
+        stats.vertices += count;
+        const SDL_FPoint* screen = to_screen(pts, count);
+        stats.pixels += polyline_length(screen, count);
+        if (chunk) {
+            for (int i = 1; i < count; ++i) record_line(screen[i - 1], screen[i]);
+            return;
+        }
+        stats.sdl_calls++;
+        if (trace) trace->lines(screen, count);
+        SDL_RenderLines(renderer, screen, count);
     }
 
     void lines(const std::vector<SDL_FPoint>& pts) {
-        SDL_RenderLines(renderer, pts.data(), static_cast<int>(pts.size()));
+        lines(pts.data(), static_cast<int>(pts.size()));
     }
 
     void polygon(const std::vector<SDL_FPoint>& pts) {
         if (pts.size() < 2) return;
-        SDL_RenderLines(renderer, pts.data(), static_cast<int>(pts.size()));
-        SDL_RenderLine(renderer, pts.back().x, pts.back().y, pts.front().x, pts.front().y);
+        lines(pts);
+        line(pts.back().x, pts.back().y, pts.front().x, pts.front().y);
+    }
+
+    // Only valid while the transform is axis aligned
+    SDL_FRect screen_rect(const SDL_FRect& r) const {
+        SDL_FPoint p = to_screen(r.x, r.y);
+        return { p.x, p.y, r.w * xform.a, r.h * xform.d };
+    }
+
+    // Rects under rotation or shear become quads (outline or two triangles)
+    void quad_corners(const SDL_FRect& r, SDL_FPoint* out) const {
+        SDL_FPoint corners[4] = { { r.x, r.y }, { r.x + r.w, r.y },
+                                  { r.x + r.w, r.y + r.h }, { r.x, r.y + r.h } };
+        xform.apply(corners, out, 4);
+    }
+
+    void quad_outline(const SDL_FRect& r) {
+        SDL_FPoint q[5];
+        quad_corners(r, q);
+        q[4] = q[0];
+        stats.pixels += polyline_length(q, 5);
+        if (chunk) {
+            for (int i = 0; i < 4; ++i) record_line(q[i], q[i + 1]);
+            return;
+        }
+        stats.sdl_calls++;
+        if (trace) trace->lines(q, 5);
+        SDL_RenderLines(renderer, q, 5);
+    }
+
+    void quad_fill(const SDL_FRect& r) {
+        static const int indices[6] = { 0, 1, 2, 0, 2, 3 };
+        const SDL_Color& c = current_color;
+        SDL_FColor color{ c.r / 255.0f, c.g / 255.0f, c.b / 255.0f, c.a / 255.0f };
+        SDL_FPoint q[4];
+        quad_corners(r, q);
+        SDL_Vertex verts[4];
+        for (int i = 0; i < 4; ++i) verts[i] = { q[i], color, { 0, 0 } };
+
+        float s = xform.scale();
+        stats.pixels += std::abs(r.w * r.h) * s * s;
+        if (chunk) {
+            record_triangles(verts, 4, indices, 6);
+            return;
+        }
+        stats.sdl_calls++;
+        if (trace) trace->fillPolygon(q, 4, c.r, c.g, c.b, c.a);
+        SDL_RenderGeometry(renderer, nullptr, verts, 4, indices, 6);
     }
 
     void rect(float x, float y, float w, float h) {
-        SDL_FRect r{ x, y, w, h };
+        stats.primitives++;
+        stats.vertices += 4;
+        if (chunk || !xform.is_axis_aligned()) {
+            quad_outline({ x, y, w, h });
+            return;
+        }
+
+        SDL_FRect r = screen_rect({ x, y, w, h });
+        stats.sdl_calls++;
+        stats.pixels += 2 * (std::abs(r.w) + std::abs(r.h));
+        if (trace) trace->rect(r, false);
         SDL_RenderRect(renderer, &r);
     }
 
     void rects(const SDL_FRect* rects, int count) {
-        SDL_RenderRects(renderer, rects, count);
+        stats.primitives++;
+        stats.vertices += 4 * count;
+        if (chunk || !xform.is_axis_aligned()) {
+            for (int i = 0; i < count; ++i) quad_outline(rects[i]);
+            return;
+        }
+
+        float s = xform.scale();
+        for (int i = 0; i < count; ++i) {
+            stats.pixels += 2 * (std::abs(rects[i].w) + std::abs(rects[i].h)) * s;
+            if (trace) trace->rect(screen_rect(rects[i]), false);
+        }
+
+        if (!has_view()) {
+            stats.sdl_calls++;
+            SDL_RenderRects(renderer, rects, count);
+            return;
+        }
+        stats.sdl_calls += count;
+        for (int i = 0; i < count; ++i) {
+            SDL_FRect r = screen_rect(rects[i]);
+            SDL_RenderRect(renderer, &r);
+        }
     }
 
     void fill_rect(float x, float y, float w, float h) {
-        SDL_FRect r{ x, y, w, h };
+        stats.primitives++;
+        stats.vertices += 4;
+        if (chunk || !xform.is_axis_aligned()) {
+            quad_fill({ x, y, w, h });
+            return;
+        }
+
+        SDL_FRect r = screen_rect({ x, y, w, h });
+        stats.sdl_calls++;
+        stats.pixels += std::abs(r.w * r.h);
+        if (trace) trace->rect(r, true);
         SDL_RenderFillRect(renderer, &r);
     }
 
     void fill_rects(const SDL_FRect* rects, int count) {
-        SDL_RenderFillRects(renderer, rects, count);
+        stats.primitives++;
+        stats.vertices += 4 * count;
+        if (chunk || !xform.is_axis_aligned()) {
+            for (int i = 0; i < count; ++i) quad_fill(rects[i]);
+            return;
+        }
+
+        float s = xform.scale();
+        for (int i = 0; i < count; ++i) {
+            stats.pixels += std::abs(rects[i].w * rects[i].h) * s * s;
+            if (trace) trace->rect(screen_rect(rects[i]), true);
+        }
+
+        if (!has_view()) {
+            stats.sdl_calls++;
+            SDL_RenderFillRects(renderer, rects, count);
+            return;
+        }
+        stats.sdl_calls += count;
+        for (int i = 0; i < count; ++i) {
+            SDL_FRect r = screen_rect(rects[i]);
+            SDL_RenderFillRect(renderer, &r);
+        }
     }
 
-    void circle(int cx, int cy, int radius) {
+    // Circles keep their shape under rotation; the radius follows the
+    // transform's overall scale
+    void circle(int wx, int wy, int wradius) {
+        SDL_FPoint center = to_screen(static_cast<float>(wx), static_cast<float>(wy));
+        int cx = static_cast<int>(center.x);
+        int cy = static_cast<int>(center.y);
+        int radius = static_cast<int>(wradius * xform.scale());
         if (radius <= 0) return;
+        if (chunk) {
+            stats.primitives++;
+            stats.pixels += 2 * 3.14159265f * radius;
+            record_circle(center, static_cast<float>(radius), false);
+            return;
+        }
+        if (trace) trace->circle(cx, cy, radius, false);
 
         std::vector<SDL_FPoint> pts;
         pts.reserve(radius * 8);
@@ -110,15 +815,35 @@ struct Draw {
             }
         }
 
+        stats.primitives++;
+        stats.sdl_calls++;
+        stats.vertices += pts.size();
+        stats.pixels += pts.size();
         SDL_RenderPoints(renderer, pts.data(), static_cast<int>(pts.size()));
     }
 
-    void fill_circle(int cx, int cy, int radius) {
+    // One SDL_RenderLine per scanline: 2r+1 calls
+    void fill_circle(int wx, int wy, int wradius) {
+        SDL_FPoint center = to_screen(static_cast<float>(wx), static_cast<float>(wy));
+        int cx = static_cast<int>(center.x);
+        int cy = static_cast<int>(center.y);
+        int radius = static_cast<int>(wradius * xform.scale());
         if (radius <= 0) return;
+        if (chunk) {
+            stats.primitives++;
+            stats.pixels += 3.14159265f * radius * radius;
+            record_circle(center, static_cast<float>(radius), true);
+            return;
+        }
+        if (trace) trace->circle(cx, cy, radius, true);
 
+        stats.primitives++;
         int rsquared = radius * radius;
         for (int dy = -radius; dy <= radius; ++dy) {
             int dx = static_cast<int>(std::sqrt(rsquared - dy * dy));
+            stats.sdl_calls++;
+            stats.vertices += 2;
+            stats.pixels += 2 * dx + 1;
             SDL_RenderLine(renderer,
                 static_cast<float>(cx - dx), static_cast<float>(cy + dy),
                 static_cast<float>(cx + dx), static_cast<float>(cy + dy));
@@ -140,31 +865,75 @@ struct Draw {
                 });
         }
 
-        SDL_RenderLines(renderer, pts.data(), static_cast<int>(pts.size()));
+        lines(pts);
     }
 
+    // Concave outlines are fine: ear clipping runs on every call. Shapes drawn
+    // repeatedly should be a PolygonMesh and go through fill_mesh instead.
     void fill_polygon(const std::vector<SDL_FPoint>& pts, Uint8 r, Uint8 g, Uint8 b, Uint8 a = 255) {
         if (pts.size() < 3) return;
+        triangulate_polygon(pts.data(), static_cast<int>(pts.size()), polygon_indices);
+        fill_geometry(pts.data(), static_cast<int>(pts.size()),
+            polygon_indices.data(), static_cast<int>(polygon_indices.size()), r, g, b, a);
+    }
 
-        std::vector<SDL_Vertex> verts;
-        verts.reserve(pts.size());
+    // One geometry call with the mesh's cached triangulation, placed by the
+    // current transform
+    void fill_mesh(const PolygonMesh& mesh, Uint8 r, Uint8 g, Uint8 b, Uint8 a = 255) {
+        fill_geometry(mesh.points.data(), static_cast<int>(mesh.points.size()),
+            mesh.indices.data(), static_cast<int>(mesh.indices.size()), r, g, b, a);
+    }
 
+    void fill_geometry(const SDL_FPoint* pts, int count, const int* indices, int index_count,
+        Uint8 r, Uint8 g, Uint8 b, Uint8 a) {
+        if (count < 3 || index_count < 3) return;
+
+        apply_tint(r, g, b, a);
         SDL_FColor color{ r / 255.0f, g / 255.0f, b / 255.0f, a / 255.0f };
-        for (const auto& p : pts) {
-            verts.push_back({ p, color, {0, 0} });
+        const SDL_FPoint* screen = to_screen(pts, count);
+        geometry.resize(count);
+        float area2 = 0;
+        for (int i = 0; i < count; ++i) {
+            const SDL_FPoint& p = screen[i];
+            const SDL_FPoint& q = screen[(i + 1) % count];
+            area2 += p.x * q.y - q.x * p.y;
+            geometry[i] = { p, color, {0, 0} };
         }
 
-        std::vector<int> indices;
-        indices.reserve((pts.size() - 2) * 3);
+        stats.primitives++;
+        stats.vertices += index_count;
+        stats.pixels += std::abs(area2) * 0.5f;
+        if (chunk) {
+            record_triangles(geometry.data(), count, indices, index_count);
+            return;
+        }
+        stats.sdl_calls++;
+        if (trace) {
+            scratch.resize(count);
+            for (int i = 0; i < count; ++i) scratch[i] = geometry[i].position;
+            trace->fillPolygon(scratch.data(), count, r, g, b, a);
+        }
+        SDL_RenderGeometry(renderer, nullptr, geometry.data(), count, indices, index_count);
+    }
 
-        for (size_t i = 1; i < pts.size() - 1; ++i) {
-            indices.push_back(0);
-            indices.push_back(static_cast<int>(i));
-            indices.push_back(static_cast<int>(i + 1));
+    // ===== TEXTURES =====
+    // Blits dst (in the current transform's space); rotated transforms use an
+    // affine blit. Not recorded in traces, which hold primitives only.
+    void texture(SDL_Texture* tex, const SDL_FRect* src, const SDL_FRect& dst) {
+        if (chunk) return; // Textured draws stay on the main thread
+        float s = xform.scale();
+        stats.primitives++;
+        stats.sdl_calls++;
+        stats.vertices += 4;
+        stats.pixels += std::abs(dst.w * dst.h) * s * s;
+        if (xform.is_axis_aligned()) {
+            SDL_FRect r = screen_rect(dst);
+            SDL_RenderTexture(renderer, tex, src, &r);
+            return;
         }
 
-        SDL_RenderGeometry(renderer, nullptr,
-            verts.data(), static_cast<int>(verts.size()),
-            indices.data(), static_cast<int>(indices.size()));
+        SDL_FPoint q[4];
+        quad_corners(dst, q);
+        SDL_RenderTextureAffine(renderer, tex, src, &q[0], &q[1], &q[3]);
     }
-};
\ No newline at end of file
+};
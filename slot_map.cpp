@@ -0,0 +1,140 @@
+// slot_map.cpp - Dense slot map with generational handles
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <utility>
+
+// A handle names a slot plus the generation it was issued for. Removing an
+// object bumps its slot's generation, so old handles stop resolving instead
+// of pointing at whatever reuses the slot.
+template <typename T>
+struct Handle {
+    static constexpr uint32_t INVALID = 0xFFFFFFFFu;
+
+    uint32_t index = INVALID;
+    uint32_t generation = 0;
+
+    bool isNull() const { return index == INVALID; }
+    bool operator==(const Handle& other) const { return index == other.index && generation == other.generation; }
+    bool operator!=(const Handle& other) const { return !(*this == other); }
+};
+
+// Objects live packed in one vector (iteration is a linear scan) and are
+// removed by swap-and-pop, so they may move. Anything that needs to refer to
+// an object across steps keeps a Handle and resolves it with get(), which
+// returns null once the object is gone. clear() keeps all capacity so a map
+// can be refilled (e.g. every wave) without reallocating.
+template <typename T>
+class SlotMap {
+private:
+    struct Slot {
+        uint32_t dense;      // Index into items, INVALID while free
+        uint32_t generation; // Starts at 1 so a default Handle never resolves
+    };
+
+    std::vector<T> items;
+    std::vector<uint32_t> itemSlots; // items[i] lives in slots[itemSlots[i]]
+    std::vector<Slot> slots;
+    std::vector<uint32_t> freeSlots;
+
+    void release(uint32_t slotIndex) {
+        Slot& slot = slots[slotIndex];
+        slot.dense = Handle<T>::INVALID;
+        slot.generation++;
+        freeSlots.push_back(slotIndex);
+    }
+
+    void eraseDense(uint32_t dense) {
+        uint32_t last = static_cast<uint32_t>(items.size() - 1);
+        release(itemSlots[dense]);
+        if (dense != last) {
+            items[dense] = std::move(items[last]);
+            itemSlots[dense] = itemSlots[last];
+            slots[itemSlots[dense]].dense = dense;
+        }
+        items.pop_back();
+        itemSlots.pop_back();
+    }
+
+public:
+    template <typename... Args>
+    Handle<T> emplace(Args&&... args) {
+        uint32_t slotIndex;
+        if (!freeSlots.empty()) {
+            slotIndex = freeSlots.back();
+            freeSlots.pop_back();
+        }
+        else {
+            slotIndex = static_cast<uint32_t>(slots.size());
+            slots.push_back({ Handle<T>::INVALID, 1 });
+        }
+
+        items.emplace_back(std::forward<Args>(args)...);
+        itemSlots.push_back(slotIndex);
+        slots[slotIndex].dense = static_cast<uint32_t>(items.size() - 1);
+        return { slotIndex, slots[slotIndex].generation };
+    }
+
+    bool contains(Handle<T> h) const {
+        return h.index < slots.size() &&
+            slots[h.index].generation == h.generation &&
+            slots[h.index].dense != Handle<T>::INVALID;
+    }
+
+    // Null for stale or null handles
+    T* get(Handle<T> h) { return contains(h) ? &items[slots[h.index].dense] : nullptr; }
+    const T* get(Handle<T> h) const { return contains(h) ? &items[slots[h.index].dense] : nullptr; }
+
+    bool remove(Handle<T> h) {
+        if (!contains(h)) return false;
+        eraseDense(slots[h.index].dense);
+        return true;
+    }
+
+    // Remove every object matching pred; returns how many were removed
+    template <typename Pred>
+    size_t removeIf(Pred pred) {
+        size_t removed = 0;
+        // Backwards so the element swapped into i has already been checked
+        for (size_t i = items.size(); i-- > 0;) {
+            if (pred(items[i])) {
+                eraseDense(static_cast<uint32_t>(i));
+                removed++;
+            }
+        }
+        return removed;
+    }
+
+    // Invalidate every outstanding handle; storage is kept for reuse
+    void clear() {
+        for (uint32_t slotIndex : itemSlots) {
+            release(slotIndex);
+        }
+        items.clear();
+        itemSlots.clear();
+    }
+
+    void reserve(size_t n) {
+        items.reserve(n);
+        itemSlots.reserve(n);
+        slots.reserve(n);
+        freeSlots.reserve(n);
+    }
+
+    Handle<T> handleAt(size_t dense) const {
+        uint32_t slotIndex = itemSlots[dense];
+        return { slotIndex, slots[slotIndex].generation };
+    }
+
+    size_t size() const { return items.size(); }
+    size_t capacity() const { return items.capacity(); }
+    bool empty() const { return items.empty(); }
+
+    T& operator[](size_t dense) { return items[dense]; }
+    const T& operator[](size_t dense) const { return items[dense]; }
+
+    auto begin() { return items.begin(); }
+    auto end() { return items.end(); }
+    auto begin() const { return items.begin(); }
+    auto end() const { return items.end(); }
+};
@@ -0,0 +1,108 @@
+// spatial_grid.cpp - Uniform grid index over axis-aligned rects (culling and broadphase)
+#pragma once
+#include <SDL3/SDL.h>
+#include <vector>
+#include <cmath>
+#include <algorithm>
+#include <cstdint>
+
+// Rects are bucketed into every cell they overlap. Queries visit only the
+// cells under the query area, so cost scales with what is nearby rather than
+// with the total number of rects. clear() keeps all bucket capacity so the
+// grid can be rebuilt every step without allocating.
+class RectGrid {
+private:
+    float originX, originY;
+    float cellSize;
+    int cols, rows;
+    std::vector<std::vector<int>> cells;
+    std::vector<SDL_FRect> rects;
+
+    // Per-rect query stamp to report rects spanning several cells only once
+    mutable std::vector<uint32_t> stamps;
+    mutable uint32_t queryStamp = 0;
+
+    int cellX(float x) const {
+        return std::clamp(static_cast<int>(std::floor((x - originX) / cellSize)), 0, cols - 1);
+    }
+
+    int cellY(float y) const {
+        return std::clamp(static_cast<int>(std::floor((y - originY) / cellSize)), 0, rows - 1);
+    }
+
+public:
+    RectGrid() : originX(0), originY(0), cellSize(256), cols(1), rows(1), cells(1) {}
+
+    RectGrid(const SDL_FRect& bounds, float cell) {
+        reset(bounds, cell);
+    }
+
+    // Define the indexed area; rects outside it are clamped into edge cells
+    void reset(const SDL_FRect& bounds, float cell) {
+        originX = bounds.x;
+        originY = bounds.y;
+        cellSize = std::max(1.0f, cell);
+        cols = std::max(1, static_cast<int>(std::ceil(bounds.w / cellSize)));
+        rows = std::max(1, static_cast<int>(std::ceil(bounds.h / cellSize)));
+        cells.assign(static_cast<size_t>(cols) * rows, {});
+        rects.clear();
+        stamps.clear();
+    }
+
+    void clear() {
+        for (auto& cell : cells) cell.clear();
+        rects.clear();
+        stamps.clear();
+    }
+
+    int insert(const SDL_FRect& rect) {
+        int id = static_cast<int>(rects.size());
+        rects.push_back(rect);
+        stamps.push_back(0);
+
+        int x0 = cellX(rect.x), x1 = cellX(rect.x + rect.w);
+        int y0 = cellY(rect.y), y1 = cellY(rect.y + rect.h);
+        for (int cy = y0; cy <= y1; ++cy) {
+            for (int cx = x0; cx <= x1; ++cx) {
+                cells[static_cast<size_t>(cy) * cols + cx].push_back(id);
+            }
+        }
+        return id;
+    }
+
+    // Calls fn(id, rect) once for every rect overlapping area
+    template <typename Fn>
+    void query(const SDL_FRect& area, Fn&& fn) const {
+        if (++queryStamp == 0) {
+            std::fill(stamps.begin(), stamps.end(), 0u);
+            queryStamp = 1;
+        }
+
+        int x0 = cellX(area.x), x1 = cellX(area.x + area.w);
+        int y0 = cellY(area.y), y1 = cellY(area.y + area.h);
+        for (int cy = y0; cy <= y1; ++cy) {
+            for (int cx = x0; cx <= x1; ++cx) {
+                for (int id : cells[static_cast<size_t>(cy) * cols + cx]) {
+                    if (stamps[id] == queryStamp) continue;
+                    stamps[id] = queryStamp;
+
+                    const SDL_FRect& r = rects[id];
+                    if (r.x <= area.x + area.w && area.x <= r.x + r.w &&
+                        r.y <= area.y + area.h && area.y <= r.y + r.h) {
+                        fn(id, r);
+                    }
+                }
+            }
+        }
+    }
+
+    void query(const SDL_FRect& area, std::vector<int>& out) const {
+        out.clear();
+        query(area, [&out](int id, const SDL_FRect&) { out.push_back(id); });
+    }
+
+    const SDL_FRect& get(int id) const { return rects[id]; }
+    const std::vector<SDL_FRect>& getRects() const { return rects; }
+    size_t size() const { return rects.size(); }
+    float getCellSize() const { return cellSize; }
+};
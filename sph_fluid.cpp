@@ -0,0 +1,506 @@
+// sph_fluid.cpp - Smoothed-particle hydrodynamics liquid with a metaball surface render
+// Particle-based viscoelastic fluid (Clavet et al. double density relaxation)
+// in pixel units. Each substep:
+//   1. apply gravity, remember positions, predict new ones
+//   2. drop particles that left the bounds, counting-sort the rest into a
+//      uniform grid with cell size = interaction radius (3x3 cell search)
+//   3. density, near density and pressure (parallel over bands of grid rows);
+//      the neighbour search runs once here and is cached for 4 and 6
+//   4. pressure relaxation of positions   (parallel, gather only)
+//   5. velocity from the displacement, collision with solid rects
+//   6. pairwise viscosity impulses        (parallel, gather only)
+// Every pair term is symmetric and each particle only writes its own slot,
+// so the banded passes need no locks and give the same result on any
+// thread count. The surface is a low-resolution density field splatted per
+// band and uploaded as one streaming texture, drawn with linear filtering.
+#pragma once
+#include <SDL3/SDL.h>
+#include <vector>
+#include <random>
+#include <cmath>
+#include <cstdint>
+#include <algorithm>
+#include "utils.cpp"
+#include "renderer2d.cpp"
+#include "thread_pool.cpp"
+
+struct SphParams {
+    float radius = 12.0f;            // Interaction radius h, pixels
+    float spacing = 5.0f;            // Rest distance between particles (sets rest density)
+    float stiffness = 1.0f;          // Pressure towards rest density
+    float nearStiffness = 3.0f;      // Short-range repulsion (surface tension, no clumping)
+    float viscosityLinear = 0.6f;
+    float viscosityQuadratic = 0.02f;
+    float gravity = 400.0f;          // Pixels per second squared
+    float friction = 0.1f;           // Tangential velocity lost on contact with a solid
+    int maxSubsteps = 4;             // Per update; each is at most half a 60 Hz frame
+};
+
+class SphFluid {
+private:
+    struct Source {
+        Vec2 position;
+        Vec2 velocity;   // Pixels per second
+        float rate;      // Particles per second
+        float width;     // Spawn line across the velocity
+        float carry;     // Fractional particles owed from earlier updates
+    };
+
+    // Structure of arrays; t* are scratch for the gather passes
+    std::vector<float> x, y, px, py, vx, vy;
+    std::vector<float> rho, rhoNear;
+    std::vector<float> pressure, pressureNear;
+    std::vector<float> tx, ty;
+
+    // Neighbours found in the density pass, MAX_NEIGHBOURS slots per particle.
+    // Stored as unit direction and q = 1 - dist / radius.
+    static constexpr int MAX_NEIGHBOURS = 64;
+    struct Neighbour {
+        uint32_t j;
+        float nx, ny;
+        float q;
+    };
+    std::vector<Neighbour> neighbours;
+    std::vector<uint8_t> neighbourCount;
+    size_t count;
+    size_t capacity;
+
+    // Grid over bounds, cells sorted row-major; cellStart has one extra entry
+    float cell;
+    int cols, rows;
+    std::vector<uint32_t> cellStart;
+    std::vector<uint32_t> cellOf;
+    std::vector<uint32_t> cursor;
+    std::vector<uint32_t> slot;     // Sorted position of each particle
+    std::vector<float> sortScratch;
+
+    SDL_FRect bounds;
+    std::vector<SDL_FRect> solids;
+    std::vector<Source> sources;
+    SphParams params;
+    float restDensity;
+    ThreadPool* pool;
+    std::minstd_rand rng;
+
+    // Surface render
+    static constexpr int SURFACE_CELL = 4; // Screen pixels per density texel
+    std::vector<float> field;
+    std::vector<Uint32> pixels;
+    std::vector<SDL_FPoint> debugPoints;
+    int fieldW, fieldH;
+    SDL_Texture* surface;
+    SDL_Renderer* surfaceOwner;
+
+    int cellX(float px_) const {
+        return std::clamp(static_cast<int>((px_ - bounds.x) / cell), 0, cols - 1);
+    }
+
+    int cellY(float py_) const {
+        return std::clamp(static_cast<int>((py_ - bounds.y) / cell), 0, rows - 1);
+    }
+
+    float jitter(float range) {
+        std::uniform_real_distribution<float> dis(-range, range);
+        return dis(rng);
+    }
+
+    // Kernel sum at rest on a hexagonal lattice of the given spacing
+    void computeRestDensity() {
+        float h = params.radius, s = params.spacing;
+        float rowH = s * std::sqrt(3.0f) * 0.5f;
+        int n = static_cast<int>(std::ceil(h / std::min(s, rowH))) + 1;
+        restDensity = 0;
+        for (int r = -n; r <= n; ++r) {
+            for (int c = -n; c <= n; ++c) {
+                if (r == 0 && c == 0) continue;
+                float ox = c * s + ((r & 1) ? s * 0.5f : 0.0f);
+                float dist = std::sqrt(ox * ox + (r * rowH) * (r * rowH));
+                if (dist < h) {
+                    float q = 1.0f - dist / h;
+                    restDensity += q * q;
+                }
+            }
+        }
+    }
+
+    void removeAt(size_t i) {
+        size_t last = --count;
+        x[i] = x[last]; y[i] = y[last];
+        px[i] = px[last]; py[i] = py[last];
+        vx[i] = vx[last]; vy[i] = vy[last];
+    }
+
+    void permute(std::vector<float>& values) {
+        for (size_t i = 0; i < count; ++i) sortScratch[slot[i]] = values[i];
+        std::copy(sortScratch.begin(), sortScratch.begin() + count, values.begin());
+    }
+
+    // Counting sort by cell; particles of one cell (and one row) end up contiguous
+    void buildGrid() {
+        std::fill(cellStart.begin(), cellStart.end(), 0u);
+        for (size_t i = 0; i < count; ++i) {
+            uint32_t c = static_cast<uint32_t>(cellY(y[i]) * cols + cellX(x[i]));
+            cellOf[i] = c;
+            cellStart[c + 1]++;
+        }
+        for (size_t c = 1; c < cellStart.size(); ++c) cellStart[c] += cellStart[c - 1];
+
+        cursor.assign(cellStart.begin(), cellStart.end() - 1);
+        for (size_t i = 0; i < count; ++i) slot[i] = cursor[cellOf[i]]++;
+
+        permute(x); permute(y);
+        permute(px); permute(py);
+        permute(vx); permute(vy);
+    }
+
+    // Calls fn(j, dx, dy, dist) for every other particle within the radius
+    template <typename Fn>
+    void forNeighbours(size_t i, Fn&& fn) const {
+        float h2 = params.radius * params.radius;
+        int cx = cellX(x[i]), cy = cellY(y[i]);
+        int x0 = std::max(0, cx - 1), x1 = std::min(cols - 1, cx + 1);
+        for (int ry = std::max(0, cy - 1); ry <= std::min(rows - 1, cy + 1); ++ry) {
+            // The three cells of a row are contiguous after sorting
+            uint32_t begin = cellStart[ry * cols + x0];
+            uint32_t end = cellStart[ry * cols + x1 + 1];
+            for (uint32_t j = begin; j < end; ++j) {
+                if (j == i) continue;
+                float dx = x[j] - x[i], dy = y[j] - y[i];
+                float d2 = dx * dx + dy * dy;
+                if (d2 >= h2 || d2 < 1e-8f) continue;
+                fn(j, dx, dy, std::sqrt(d2));
+            }
+        }
+    }
+
+    // Runs fn(begin, end) over particle ranges made of whole bands of grid
+    // rows. Serial without a pool or for small counts.
+    template <typename Fn>
+    void forBands(Fn&& fn) {
+        int jobs = pool && count >= 2048 ? pool->size() * 4 : 1;
+        if (jobs <= 1) {
+            fn(size_t(0), count);
+            return;
+        }
+
+        int rowsPerJob = std::max(1, (rows + jobs - 1) / jobs);
+        for (int r = 0; r < rows; r += rowsPerJob) {
+            size_t begin = cellStart[r * cols];
+            size_t end = cellStart[std::min(rows, r + rowsPerJob) * cols];
+            if (begin == end) continue;
+            pool->submit([&fn, begin, end]() { fn(begin, end); });
+        }
+        pool->waitIdle();
+    }
+
+    void collide(size_t i) {
+        float margin = params.spacing * 0.5f;
+        for (const SDL_FRect& s : solids) {
+            float left = s.x - margin, right = s.x + s.w + margin;
+            float top = s.y - margin, bottom = s.y + s.h + margin;
+            if (x[i] <= left || x[i] >= right || y[i] <= top || y[i] >= bottom) continue;
+
+            // Out through the nearest face; drop the velocity into it
+            float dl = x[i] - left, dr = right - x[i], dt = y[i] - top, db = bottom - y[i];
+            float m = std::min({ dl, dr, dt, db });
+            float keep = 1.0f - params.friction;
+            if (m == dt) { y[i] = top; vy[i] = std::min(vy[i], 0.0f); vx[i] *= keep; }
+            else if (m == db) { y[i] = bottom; vy[i] = std::max(vy[i], 0.0f); vx[i] *= keep; }
+            else if (m == dl) { x[i] = left; vx[i] = std::min(vx[i], 0.0f); vy[i] *= keep; }
+            else { x[i] = right; vx[i] = std::max(vx[i], 0.0f); vy[i] *= keep; }
+        }
+    }
+
+    // dt in 60 Hz frames; velocities are pixels per frame inside the solver
+    void substep(float dt) {
+        float g = params.gravity / 3600.0f;
+        for (size_t i = 0; i < count; ++i) {
+            vy[i] += g * dt;
+            px[i] = x[i];
+            py[i] = y[i];
+            x[i] += vx[i] * dt;
+            y[i] += vy[i] * dt;
+        }
+
+        size_t i = 0;
+        while (i < count) {
+            if (x[i] < bounds.x || x[i] > bounds.x + bounds.w ||
+                y[i] < bounds.y || y[i] > bounds.y + bounds.h) {
+                removeAt(i);
+                continue;
+            }
+            ++i;
+        }
+        buildGrid();
+
+        float h = params.radius;
+        float k = params.stiffness, kn = params.nearStiffness, rest = restDensity;
+        forBands([this, h, k, kn, rest](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                Neighbour* list = &neighbours[i * MAX_NEIGHBOURS];
+                int n = 0;
+                float d = 0, dn = 0;
+                forNeighbours(i, [&](uint32_t j, float dx, float dy, float dist) {
+                    float q = 1.0f - dist / h;
+                    d += q * q;
+                    dn += q * q * q;
+                    if (n < MAX_NEIGHBOURS) list[n++] = { j, dx / dist, dy / dist, q };
+                    });
+                neighbourCount[i] = static_cast<uint8_t>(n);
+                rho[i] = d;
+                rhoNear[i] = dn;
+                pressure[i] = k * (d - rest);
+                pressureNear[i] = kn * dn;
+            }
+            });
+
+        float dt2 = dt * dt;
+        forBands([this, dt2](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                const Neighbour* list = &neighbours[i * MAX_NEIGHBOURS];
+                float pi = pressure[i], pni = pressureNear[i];
+                float sx = 0, sy = 0;
+                for (int n = 0; n < neighbourCount[i]; ++n) {
+                    const Neighbour& nb = list[n];
+                    float p = pi + pressure[nb.j];
+                    float pn = pni + pressureNear[nb.j];
+                    // Half of the pair's displacement; j takes the other half
+                    float disp = 0.25f * dt2 * (p * nb.q + pn * nb.q * nb.q);
+                    sx -= disp * nb.nx;
+                    sy -= disp * nb.ny;
+                }
+                tx[i] = x[i] + sx;
+                ty[i] = y[i] + sy;
+            }
+            });
+        std::swap(x, tx);
+        std::swap(y, ty);
+
+        float inv = 1.0f / dt;
+        forBands([this, inv](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                vx[i] = (x[i] - px[i]) * inv;
+                vy[i] = (y[i] - py[i]) * inv;
+                collide(i);
+            }
+            });
+
+        float sigma = params.viscosityLinear, beta = params.viscosityQuadratic;
+        // Pair geometry from the density pass; positions have only moved by
+        // the relaxation since
+        forBands([this, dt, sigma, beta](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                const Neighbour* list = &neighbours[i * MAX_NEIGHBOURS];
+                float ix = 0, iy = 0;
+                for (int n = 0; n < neighbourCount[i]; ++n) {
+                    const Neighbour& nb = list[n];
+                    float u = (vx[i] - vx[nb.j]) * nb.nx + (vy[i] - vy[nb.j]) * nb.ny;
+                    if (u <= 0) continue;
+                    float impulse = 0.5f * dt * nb.q * (sigma * u + beta * u * u);
+                    ix -= impulse * nb.nx;
+                    iy -= impulse * nb.ny;
+                }
+                tx[i] = vx[i] + ix;
+                ty[i] = vy[i] + iy;
+            }
+            });
+        std::swap(vx, tx);
+        std::swap(vy, ty);
+    }
+
+    void emit(float dt) {
+        for (Source& s : sources) {
+            s.carry += s.rate * dt;
+            Vec2 across = Vec2(-s.velocity.y, s.velocity.x).normalized();
+            while (s.carry >= 1.0f && count < capacity) {
+                s.carry -= 1.0f;
+                Vec2 p = s.position + across * jitter(s.width * 0.5f);
+                size_t i = count++;
+                x[i] = p.x; y[i] = p.y;
+                px[i] = p.x; py[i] = p.y;
+                vx[i] = (s.velocity.x + jitter(10.0f)) / 60.0f;
+                vy[i] = (s.velocity.y + jitter(10.0f)) / 60.0f;
+            }
+            s.carry = std::min(s.carry, 1.0f); // Pool full: do not bank a burst
+        }
+    }
+
+    void splatBand(int r0, int r1, float iso, const Color& deep, const Color& edge) {
+        float cs = static_cast<float>(SURFACE_CELL);
+        float h = params.radius, h2 = h * h;
+        int reach = static_cast<int>(std::ceil(h / cs));
+        std::fill(field.begin() + static_cast<size_t>(r0) * fieldW,
+            field.begin() + static_cast<size_t>(r1) * fieldW, 0.0f);
+
+        // Particles whose kernel can touch these texel rows (plus one grid row
+        // of slack for motion since the last sort)
+        float yTop = bounds.y + r0 * cs - h, yBottom = bounds.y + r1 * cs + h;
+        int g0 = std::max(0, cellY(yTop) - 1), g1 = std::min(rows - 1, cellY(yBottom) + 1);
+        size_t begin = cellStart[g0 * cols], end = cellStart[(g1 + 1) * cols];
+
+        for (size_t i = begin; i < end; ++i) {
+            float fx = (x[i] - bounds.x) / cs, fy = (y[i] - bounds.y) / cs;
+            int cx = static_cast<int>(fx), cy = static_cast<int>(fy);
+            for (int ty_ = std::max(r0, cy - reach); ty_ <= std::min(r1 - 1, cy + reach); ++ty_) {
+                float dy = (ty_ + 0.5f - fy) * cs;
+                float* row = &field[static_cast<size_t>(ty_) * fieldW];
+                for (int tx_ = std::max(0, cx - reach); tx_ <= std::min(fieldW - 1, cx + reach); ++tx_) {
+                    float dx = (tx_ + 0.5f - fx) * cs;
+                    float w = 1.0f - (dx * dx + dy * dy) / h2;
+                    if (w > 0) row[tx_] += w * w;
+                }
+            }
+        }
+
+        // Soft threshold: transparent below iso, edge colour at the rim
+        for (int r = r0; r < r1; ++r) {
+            for (int c = 0; c < fieldW; ++c) {
+                size_t idx = static_cast<size_t>(r) * fieldW + c;
+                float v = field[idx];
+                Uint32 argb = 0;
+                if (v > iso) {
+                    float t = std::min(1.0f, (v - iso) / iso);
+                    Color col = Color::lerp(edge, deep, t);
+                    SDL_Color sc = col.toSDL();
+                    argb = (Uint32(sc.a) << 24) | (Uint32(sc.r) << 16) | (Uint32(sc.g) << 8) | sc.b;
+                }
+                pixels[idx] = argb;
+            }
+        }
+    }
+
+public:
+    SphFluid(size_t maxParticles = 16384, ThreadPool* workers = nullptr)
+        : count(0), capacity(maxParticles), cell(12.0f), cols(1), rows(1),
+        bounds{ 0, 0, 0, 0 }, restDensity(1.0f), pool(workers), rng(1),
+        fieldW(0), fieldH(0), surface(nullptr), surfaceOwner(nullptr) {
+        for (auto* v : { &x, &y, &px, &py, &vx, &vy, &rho, &rhoNear,
+                         &pressure, &pressureNear, &tx, &ty, &sortScratch }) {
+            v->resize(capacity);
+        }
+        neighbours.resize(capacity * MAX_NEIGHBOURS);
+        neighbourCount.resize(capacity);
+        cellOf.resize(capacity);
+        slot.resize(capacity);
+        setParams(params);
+    }
+
+    ~SphFluid() {
+        if (surface) SDL_DestroyTexture(surface);
+    }
+
+    SphFluid(const SphFluid&) = delete;
+    SphFluid& operator=(const SphFluid&) = delete;
+
+    void setParams(const SphParams& p) {
+        params = p;
+        cell = params.radius;
+        computeRestDensity();
+        setBounds(bounds);
+    }
+
+    // Particles leaving this area are removed (drains)
+    void setBounds(const SDL_FRect& area) {
+        bounds = area;
+        cols = std::max(1, static_cast<int>(std::ceil(area.w / cell)));
+        rows = std::max(1, static_cast<int>(std::ceil(area.h / cell)));
+        cellStart.assign(static_cast<size_t>(cols) * rows + 1, 0u);
+
+        fieldW = std::max(1, static_cast<int>(std::ceil(area.w / SURFACE_CELL)));
+        fieldH = std::max(1, static_cast<int>(std::ceil(area.h / SURFACE_CELL)));
+        field.assign(static_cast<size_t>(fieldW) * fieldH, 0.0f);
+        pixels.assign(field.size(), 0u);
+        if (surface) SDL_DestroyTexture(surface);
+        surface = nullptr;
+        surfaceOwner = nullptr;
+    }
+
+    void setThreadPool(ThreadPool* workers) { pool = workers; }
+
+    void addSolid(const SDL_FRect& rect) { solids.push_back(rect); }
+    void clearSolids() { solids.clear(); }
+
+    void addSource(Vec2 position, Vec2 velocity, float rate, float width = 12.0f) {
+        sources.push_back({ position, velocity, rate, width, 0.0f });
+    }
+
+    void clearSources() { sources.clear(); }
+    void clear() { count = 0; }
+
+    // Velocity in pixels per second
+    bool spawn(Vec2 position, Vec2 velocity) {
+        if (count == capacity) return false;
+        size_t i = count++;
+        x[i] = position.x; y[i] = position.y;
+        px[i] = position.x; py[i] = position.y;
+        vx[i] = velocity.x / 60.0f;
+        vy[i] = velocity.y / 60.0f;
+        return true;
+    }
+
+    // dt in seconds, split into substeps of at most half a 60 Hz frame
+    void update(float dt) {
+        dt = std::min(dt, 0.1f);
+        emit(dt);
+        float frames = dt * 60.0f;
+        int steps = std::clamp(static_cast<int>(std::ceil(frames * 2.0f)), 1, params.maxSubsteps);
+        for (int s = 0; s < steps; ++s) {
+            substep(frames / steps);
+        }
+    }
+
+    // Metaball surface: density field at SURFACE_CELL resolution, thresholded
+    // into one streaming texture and stretched over the bounds
+    void drawSurface(Draw& draw, const Color& deep = Color(30, 90, 200, 220),
+        const Color& edge = Color(150, 210, 255, 235)) {
+        if (!draw.renderer || count == 0) return;
+
+        if (surfaceOwner != draw.renderer) {
+            if (surface) SDL_DestroyTexture(surface);
+            surface = SDL_CreateTexture(draw.renderer, SDL_PIXELFORMAT_ARGB8888,
+                SDL_TEXTUREACCESS_STREAMING, fieldW, fieldH);
+            surfaceOwner = draw.renderer;
+            if (!surface) return;
+            SDL_SetTextureBlendMode(surface, SDL_BLENDMODE_BLEND);
+            SDL_SetTextureScaleMode(surface, SDL_SCALEMODE_LINEAR);
+        }
+        if (!surface) return;
+
+        // Roughly a lone particle's peak, so single drops still show
+        float iso = 0.6f;
+        int jobs = pool && count >= 2048 ? pool->size() * 2 : 1;
+        int band = (fieldH + jobs - 1) / jobs;
+        for (int r = 0; r < fieldH; r += band) {
+            int r1 = std::min(fieldH, r + band);
+            if (jobs > 1) pool->submit([this, r, r1, iso, &deep, &edge]() { splatBand(r, r1, iso, deep, edge); });
+            else splatBand(r, r1, iso, deep, edge);
+        }
+        if (jobs > 1) pool->waitIdle();
+
+        SDL_UpdateTexture(surface, nullptr, pixels.data(), fieldW * static_cast<int>(sizeof(Uint32)));
+        draw.texture(surface, nullptr, { bounds.x, bounds.y,
+                                         static_cast<float>(fieldW * SURFACE_CELL),
+                                         static_cast<float>(fieldH * SURFACE_CELL) });
+        draw.stats.sdl_calls++; // The upload
+    }
+
+    // Debug view: one point per particle
+    void drawParticles(Draw& draw) {
+        debugPoints.resize(count);
+        for (size_t i = 0; i < count; ++i) debugPoints[i] = { x[i], y[i] };
+        draw.color(150, 200, 255);
+        draw.points(debugPoints);
+    }
+
+    void drawSolids(Draw& draw) const {
+        draw.color(90, 90, 100);
+        for (const SDL_FRect& s : solids) draw.fill_rect(s.x, s.y, s.w, s.h);
+    }
+
+    size_t size() const { return count; }
+    size_t getCapacity() const { return capacity; }
+    float getRestDensity() const { return restDensity; }
+    float getDensity(size_t i) const { return rho[i]; }
+    Vec2 getPosition(size_t i) const { return Vec2(x[i], y[i]); }
+    Vec2 getVelocity(size_t i) const { return Vec2(vx[i], vy[i]) * 60.0f; }
+};
@@ -0,0 +1,416 @@
+// synth.cpp - Procedural sound effects synthesised inside the audio callback
+// A sound is a SynthPatch: a few dozen bytes of oscillator, noise, ADSR,
+// filter and sweep settings instead of a decoded WAV. Synth::play() starts a
+// one-shot voice with per-play pitch/gain jitter; the SDL audio callback
+// renders all voices on demand, so there is no sample data in RAM and
+// nothing to load at startup.
+// Voices run in groups of four, one per SIMD lane: envelope, pitch and
+// cutoff are control values updated every BLOCK samples and ramped
+// linearly, while oscillator, xorshift noise and the state-variable filter
+// run per sample on all four lanes at once (SSE2, scalar fallback).
+#pragma once
+#include <SDL3/SDL.h>
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define SYNTH_SSE2 1
+#endif
+
+enum class Waveform : Uint8 { SINE, SQUARE, SAW, TRIANGLE };
+enum class FilterMode : Uint8 { NONE, LOWPASS, HIGHPASS, BANDPASS };
+
+struct SynthPatch {
+    Waveform wave = Waveform::SINE;
+    FilterMode filter = FilterMode::NONE;
+    float pitch = 440.0f;     // Hz at the start of the sweep
+    float pitchEnd = 440.0f;  // Hz once the sweep is done (exponential)
+    float sweepTime = 0.1f;   // Seconds for pitch and cutoff sweeps
+    float noiseMix = 0.0f;    // 0 = oscillator only, 1 = white noise only
+    float duty = 0.5f;        // Square wave high fraction
+    float attack = 0.005f;    // ADSR times in seconds
+    float decay = 0.1f;
+    float sustain = 0.0f;     // Level held for `hold` seconds
+    float hold = 0.0f;
+    float release = 0.05f;
+    float cutoff = 2000.0f;   // Filter cutoff in Hz, swept towards cutoffEnd
+    float cutoffEnd = 2000.0f;
+    float resonance = 0.2f;   // 0..0.9
+    float gain = 0.5f;
+    float pitchJitter = 0.0f; // Random +- fraction of pitch per play
+    float gainJitter = 0.0f;  // Random +- fraction of gain per play
+
+    float length() const { return attack + decay + hold + release; }
+};
+
+// Sound effects shared by the games
+struct SynthPresets {
+    static const SynthPatch& jump() {
+        static const SynthPatch p = [] {
+            SynthPatch s;
+            s.wave = Waveform::SQUARE; s.duty = 0.25f;
+            s.pitch = 220; s.pitchEnd = 660; s.sweepTime = 0.12f;
+            s.attack = 0.002f; s.decay = 0.14f; s.release = 0.03f;
+            s.filter = FilterMode::LOWPASS; s.cutoff = s.cutoffEnd = 3500;
+            s.gain = 0.25f; s.pitchJitter = 0.04f;
+            return s;
+        }();
+        return p;
+    }
+
+    static const SynthPatch& step() {
+        static const SynthPatch p = [] {
+            SynthPatch s;
+            s.noiseMix = 0.85f; s.pitch = 90; s.pitchEnd = 60; s.sweepTime = 0.05f;
+            s.attack = 0.001f; s.decay = 0.05f; s.release = 0.02f;
+            s.filter = FilterMode::LOWPASS; s.cutoff = 900; s.cutoffEnd = 300;
+            s.gain = 0.3f; s.pitchJitter = 0.15f; s.gainJitter = 0.25f;
+            return s;
+        }();
+        return p;
+    }
+
+    static const SynthPatch& fireball() {
+        static const SynthPatch p = [] {
+            SynthPatch s;
+            s.wave = Waveform::SAW; s.noiseMix = 0.6f;
+            s.pitch = 180; s.pitchEnd = 55; s.sweepTime = 0.4f;
+            s.attack = 0.01f; s.decay = 0.3f; s.sustain = 0.3f; s.hold = 0.05f; s.release = 0.15f;
+            s.filter = FilterMode::LOWPASS; s.cutoff = 4000; s.cutoffEnd = 350; s.resonance = 0.4f;
+            s.gain = 0.35f; s.pitchJitter = 0.08f;
+            return s;
+        }();
+        return p;
+    }
+
+    static const SynthPatch& slash() {
+        static const SynthPatch p = [] {
+            SynthPatch s;
+            s.noiseMix = 1.0f;
+            s.attack = 0.01f; s.decay = 0.12f; s.release = 0.04f; s.sweepTime = 0.15f;
+            s.filter = FilterMode::BANDPASS; s.cutoff = 6000; s.cutoffEnd = 1200; s.resonance = 0.6f;
+            s.gain = 0.4f; s.gainJitter = 0.15f;
+            return s;
+        }();
+        return p;
+    }
+
+    static const SynthPatch& hit() {
+        static const SynthPatch p = [] {
+            SynthPatch s;
+            s.noiseMix = 0.35f; s.pitch = 160; s.pitchEnd = 45; s.sweepTime = 0.12f;
+            s.attack = 0.001f; s.decay = 0.16f; s.release = 0.05f;
+            s.filter = FilterMode::LOWPASS; s.cutoff = 2500; s.cutoffEnd = 600;
+            s.gain = 0.6f; s.pitchJitter = 0.1f; s.gainJitter = 0.1f;
+            return s;
+        }();
+        return p;
+    }
+
+    static const SynthPatch& hurt() {
+        static const SynthPatch p = [] {
+            SynthPatch s;
+            s.wave = Waveform::SAW; s.noiseMix = 0.2f;
+            s.pitch = 320; s.pitchEnd = 110; s.sweepTime = 0.2f;
+            s.attack = 0.002f; s.decay = 0.2f; s.release = 0.05f;
+            s.filter = FilterMode::LOWPASS; s.cutoff = 1800; s.cutoffEnd = 500;
+            s.gain = 0.45f; s.pitchJitter = 0.05f;
+            return s;
+        }();
+        return p;
+    }
+
+    static const SynthPatch& deflect() {
+        static const SynthPatch p = [] {
+            SynthPatch s;
+            s.wave = Waveform::TRIANGLE; s.noiseMix = 0.1f;
+            s.pitch = 1900; s.pitchEnd = 1650; s.sweepTime = 0.3f;
+            s.attack = 0.001f; s.decay = 0.3f; s.release = 0.1f;
+            s.filter = FilterMode::BANDPASS; s.cutoff = s.cutoffEnd = 2200; s.resonance = 0.7f;
+            s.gain = 0.4f; s.pitchJitter = 0.03f;
+            return s;
+        }();
+        return p;
+    }
+};
+
+class Synth {
+public:
+    static constexpr int SAMPLE_RATE = 44100;
+    static constexpr int BLOCK = 32;  // Control-rate period in samples
+    static constexpr int GROUPS = 4;  // Four voices per group
+    static constexpr int MAX_VOICES = GROUPS * 4;
+
+private:
+    // Per-sample state and control ramps, one lane per voice
+    struct alignas(16) Group {
+        float phase[4], inc[4], incStep[4];
+        float env[4], envStep[4];
+        float low[4], band[4], f[4], q[4];
+        float wSine[4], wSquare[4], wSaw[4], wTri[4], duty[4], noiseMix[4];
+        float wDry[4], wLow[4], wHigh[4], wBand[4];
+        Uint32 noise[4];
+    };
+
+    struct Voice {
+        bool active = false;
+        SynthPatch patch;
+        float time = 0;   // Seconds since the note started
+        float pitch = 0;  // Jittered start and end of the sweep
+        float pitchEnd = 0;
+        float gain = 0;
+    };
+
+    Group groups[GROUPS];
+    Voice voices[MAX_VOICES];
+    SDL_AudioStream* stream;
+    Uint32 rng;
+    alignas(16) float mix[BLOCK * 4]; // Four lanes per sample, summed across groups
+    float block[BLOCK];   // Callback scratch
+
+    float random() {
+        rng ^= rng << 13; rng ^= rng >> 17; rng ^= rng << 5;
+        return (rng >> 8) * (1.0f / 16777216.0f);
+    }
+
+    static float envelope(const SynthPatch& p, float t) {
+        if (t < p.attack) return t / p.attack;
+        t -= p.attack;
+        if (t < p.decay) return 1.0f - (1.0f - p.sustain) * t / p.decay;
+        t -= p.decay;
+        if (t < p.hold) return p.sustain;
+        t -= p.hold;
+        if (t < p.release) return p.sustain * (1.0f - t / p.release);
+        return 0.0f;
+    }
+
+    static float sweep(float from, float to, float t, float duration) {
+        float progress = duration > 0 ? std::min(t / duration, 1.0f) : 1.0f;
+        return from * std::pow(to / from, progress);
+    }
+
+    // Control rate: ramps for the next n samples of one voice
+    void control(int v, int n) {
+        Group& g = groups[v / 4];
+        int l = v % 4;
+        Voice& voice = voices[v];
+        if (!voice.active) {
+            g.env[l] = 0;
+            g.envStep[l] = 0;
+            return;
+        }
+
+        const SynthPatch& p = voice.patch;
+        float end = voice.time + static_cast<float>(n) / SAMPLE_RATE;
+        float incEnd = sweep(voice.pitch, voice.pitchEnd, end, p.sweepTime) / SAMPLE_RATE;
+        g.incStep[l] = (incEnd - g.inc[l]) / n;
+        g.envStep[l] = (envelope(p, end) * voice.gain - g.env[l]) / n;
+
+        // Chamberlin SVF, stable for cutoff below a sixth of the rate
+        float cutoff = std::min(sweep(p.cutoff, p.cutoffEnd, (voice.time + end) * 0.5f, p.sweepTime),
+            SAMPLE_RATE / 6.0f);
+        g.f[l] = 2.0f * std::sin(3.14159265f * cutoff / SAMPLE_RATE);
+        g.q[l] = std::max(0.3f, 2.0f * (1.0f - p.resonance));
+
+        voice.time = end;
+        if (end >= p.length()) voice.active = false; // The ramp ends at zero
+    }
+
+    void renderGroup(Group& g, int n) {
+#ifdef SYNTH_SSE2
+        __m128 phase = _mm_load_ps(g.phase), inc = _mm_load_ps(g.inc), incStep = _mm_load_ps(g.incStep);
+        __m128 env = _mm_load_ps(g.env), envStep = _mm_load_ps(g.envStep);
+        __m128 low = _mm_load_ps(g.low), band = _mm_load_ps(g.band);
+        const __m128 f = _mm_load_ps(g.f), q = _mm_load_ps(g.q);
+        const __m128 wSine = _mm_load_ps(g.wSine), wSquare = _mm_load_ps(g.wSquare);
+        const __m128 wSaw = _mm_load_ps(g.wSaw), wTri = _mm_load_ps(g.wTri);
+        const __m128 duty = _mm_load_ps(g.duty), noiseMix = _mm_load_ps(g.noiseMix);
+        const __m128 wDry = _mm_load_ps(g.wDry), wLow = _mm_load_ps(g.wLow);
+        const __m128 wHigh = _mm_load_ps(g.wHigh), wBand = _mm_load_ps(g.wBand);
+        __m128i noise = _mm_loadu_si128(reinterpret_cast<const __m128i*>(g.noise));
+
+        const __m128 one = _mm_set1_ps(1.0f), two = _mm_set1_ps(2.0f), four = _mm_set1_ps(4.0f);
+        const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+        const __m128 noiseScale = _mm_set1_ps(1.0f / 2147483648.0f);
+
+        for (int i = 0; i < n; ++i) {
+            phase = _mm_add_ps(phase, inc);
+            phase = _mm_sub_ps(phase, _mm_cvtepi32_ps(_mm_cvttps_epi32(phase))); // Phase >= 0: trunc = floor
+            inc = _mm_add_ps(inc, incStep);
+
+            __m128 x = _mm_sub_ps(_mm_mul_ps(phase, two), one);
+            __m128 ax = _mm_and_ps(x, absMask);
+            // sin(2 pi phase) = -sin(pi x), parabolic approximation plus one refinement
+            __m128 y = _mm_mul_ps(_mm_mul_ps(four, x), _mm_sub_ps(one, ax));
+            y = _mm_add_ps(y, _mm_mul_ps(_mm_set1_ps(0.225f), _mm_sub_ps(_mm_mul_ps(y, _mm_and_ps(y, absMask)), y)));
+            __m128 square = _mm_or_ps(_mm_and_ps(_mm_cmplt_ps(phase, duty), one),
+                _mm_andnot_ps(_mm_cmplt_ps(phase, duty), _mm_set1_ps(-1.0f)));
+            __m128 tri = _mm_sub_ps(_mm_mul_ps(ax, two), one);
+            __m128 osc = _mm_sub_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(wSquare, square), _mm_mul_ps(wSaw, x)),
+                _mm_mul_ps(wTri, tri)), _mm_mul_ps(wSine, y));
+
+            noise = _mm_xor_si128(noise, _mm_slli_epi32(noise, 13));
+            noise = _mm_xor_si128(noise, _mm_srli_epi32(noise, 17));
+            noise = _mm_xor_si128(noise, _mm_slli_epi32(noise, 5));
+            __m128 white = _mm_mul_ps(_mm_cvtepi32_ps(noise), noiseScale);
+            __m128 in = _mm_add_ps(osc, _mm_mul_ps(_mm_sub_ps(white, osc), noiseMix));
+
+            low = _mm_add_ps(low, _mm_mul_ps(f, band));
+            __m128 high = _mm_sub_ps(_mm_sub_ps(in, low), _mm_mul_ps(q, band));
+            band = _mm_add_ps(band, _mm_mul_ps(f, high));
+
+            __m128 out = _mm_add_ps(_mm_add_ps(_mm_mul_ps(wDry, in), _mm_mul_ps(wLow, low)),
+                _mm_add_ps(_mm_mul_ps(wHigh, high), _mm_mul_ps(wBand, band)));
+            _mm_store_ps(&mix[i * 4], _mm_add_ps(_mm_load_ps(&mix[i * 4]), _mm_mul_ps(out, env)));
+            env = _mm_add_ps(env, envStep);
+        }
+
+        _mm_store_ps(g.phase, phase);
+        _mm_store_ps(g.inc, inc);
+        _mm_store_ps(g.env, env);
+        _mm_store_ps(g.low, low);
+        _mm_store_ps(g.band, band);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(g.noise), noise);
+#else
+        for (int i = 0; i < n; ++i) {
+            for (int l = 0; l < 4; ++l) {
+                g.phase[l] += g.inc[l];
+                g.phase[l] -= static_cast<float>(static_cast<int>(g.phase[l]));
+                g.inc[l] += g.incStep[l];
+
+                float x = g.phase[l] * 2.0f - 1.0f;
+                float ax = std::abs(x);
+                float y = 4.0f * x * (1.0f - ax);
+                y += 0.225f * (y * std::abs(y) - y);
+                float square = g.phase[l] < g.duty[l] ? 1.0f : -1.0f;
+                float osc = g.wSquare[l] * square + g.wSaw[l] * x + g.wTri[l] * (2.0f * ax - 1.0f) - g.wSine[l] * y;
+
+                Uint32& s = g.noise[l];
+                s ^= s << 13; s ^= s >> 17; s ^= s << 5;
+                float white = static_cast<Sint32>(s) * (1.0f / 2147483648.0f);
+                float in = osc + (white - osc) * g.noiseMix[l];
+
+                g.low[l] += g.f[l] * g.band[l];
+                float high = in - g.low[l] - g.q[l] * g.band[l];
+                g.band[l] += g.f[l] * high;
+
+                float out = g.wDry[l] * in + g.wLow[l] * g.low[l] + g.wHigh[l] * high + g.wBand[l] * g.band[l];
+                mix[i * 4 + l] += out * g.env[l];
+                g.env[l] += g.envStep[l];
+            }
+        }
+#endif
+    }
+
+    static void feed(void* userdata, SDL_AudioStream* audio, int additional, int) {
+        Synth* synth = static_cast<Synth*>(userdata);
+        int samples = additional / static_cast<int>(sizeof(float));
+        while (samples > 0) {
+            int n = std::min(samples, BLOCK);
+            synth->render(synth->block, n);
+            SDL_PutAudioStreamData(audio, synth->block, n * static_cast<int>(sizeof(float)));
+            samples -= n;
+        }
+    }
+
+public:
+    Synth() : stream(nullptr), rng(0x9E3779B9u) {
+        std::memset(groups, 0, sizeof(groups));
+        for (int v = 0; v < MAX_VOICES; ++v) groups[v / 4].noise[v % 4] = 0x1234567u * (v + 1);
+    }
+
+    ~Synth() { close(); }
+
+    Synth(const Synth&) = delete;
+    Synth& operator=(const Synth&) = delete;
+
+    // Opens a mono float stream on the default device, fed by the callback
+    bool open() {
+        if (stream) return true;
+        SDL_AudioSpec spec;
+        spec.format = SDL_AUDIO_F32;
+        spec.channels = 1;
+        spec.freq = SAMPLE_RATE;
+        stream = SDL_OpenAudioDeviceStream(SDL_AUDIO_DEVICE_DEFAULT_PLAYBACK, &spec, feed, this);
+        if (!stream) return false;
+        SDL_ResumeAudioStreamDevice(stream);
+        return true;
+    }
+
+    void close() {
+        if (stream) SDL_DestroyAudioStream(stream);
+        stream = nullptr;
+    }
+
+    // Starts a one-shot voice; the oldest voice is stolen when all are busy
+    void play(const SynthPatch& patch, float volume = 1.0f, float pitchScale = 1.0f) {
+        if (stream) SDL_LockAudioStream(stream); // The callback runs under this lock
+
+        int v = 0;
+        for (int i = 0; i < MAX_VOICES; ++i) {
+            if (!voices[i].active) { v = i; break; }
+            if (voices[i].time > voices[v].time) v = i;
+        }
+
+        float pitch = pitchScale * (1.0f + patch.pitchJitter * (random() * 2.0f - 1.0f));
+        Voice& voice = voices[v];
+        voice.active = true;
+        voice.patch = patch;
+        voice.time = 0;
+        voice.pitch = patch.pitch * pitch;
+        voice.pitchEnd = patch.pitchEnd * pitch;
+        voice.gain = volume * patch.gain * (1.0f + patch.gainJitter * (random() * 2.0f - 1.0f));
+
+        Group& g = groups[v / 4];
+        int l = v % 4;
+        g.phase[l] = 0;
+        g.inc[l] = voice.pitch / SAMPLE_RATE;
+        g.env[l] = 0;
+        g.low[l] = g.band[l] = 0;
+        g.wSine[l] = patch.wave == Waveform::SINE ? 1.0f : 0.0f;
+        g.wSquare[l] = patch.wave == Waveform::SQUARE ? 1.0f : 0.0f;
+        g.wSaw[l] = patch.wave == Waveform::SAW ? 1.0f : 0.0f;
+        g.wTri[l] = patch.wave == Waveform::TRIANGLE ? 1.0f : 0.0f;
+        g.duty[l] = patch.duty;
+        g.noiseMix[l] = patch.noiseMix;
+        g.wDry[l] = patch.filter == FilterMode::NONE ? 1.0f : 0.0f;
+        g.wLow[l] = patch.filter == FilterMode::LOWPASS ? 1.0f : 0.0f;
+        g.wHigh[l] = patch.filter == FilterMode::HIGHPASS ? 1.0f : 0.0f;
+        g.wBand[l] = patch.filter == FilterMode::BANDPASS ? 1.0f : 0.0f;
+
+        if (stream) SDL_UnlockAudioStream(stream);
+    }
+
+    // Mixes `count` mono samples; the callback calls this, tools may too
+    void render(float* out, int count) {
+        while (count > 0) {
+            int n = std::min(count, BLOCK);
+            std::fill(mix, mix + n * 4, 0.0f);
+
+            for (int gi = 0; gi < GROUPS; ++gi) {
+                bool any = false;
+                for (int l = 0; l < 4; ++l) any |= voices[gi * 4 + l].active;
+                if (!any) continue;
+                for (int l = 0; l < 4; ++l) control(gi * 4 + l, n);
+                renderGroup(groups[gi], n);
+            }
+
+            for (int i = 0; i < n; ++i) {
+                float s = mix[i * 4] + mix[i * 4 + 1] + mix[i * 4 + 2] + mix[i * 4 + 3];
+                out[i] = std::clamp(s, -1.0f, 1.0f);
+            }
+            out += n;
+            count -= n;
+        }
+    }
+
+    bool isOpen() const { return stream != nullptr; }
+
+    int getActiveVoices() const {
+        int count = 0;
+        for (const Voice& v : voices) count += v.active;
+        return count;
+    }
+};
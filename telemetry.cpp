@@ -0,0 +1,289 @@
+// telemetry.cpp - Field telemetry: per-thread lock-free rings flushed to rotating files
+// Telemetry::record() appends one 16-byte event (performance counter, kind,
+// thread, value) to the calling thread's single-producer ring: two relaxed
+// loads, a store and a release - no lock, no allocation, no syscall. A full
+// ring drops the event and counts it rather than blocking the frame.
+// A background thread drains every ring a few times per second into a set
+// of fixed-size segment files (telemetry_0.ktel ... telemetry_N.ktel) that
+// are reused round-robin, so a long session keeps its most recent history
+// in bounded disk space. telemetry_decode turns segments into CSV and
+// per-kind summaries.
+#pragma once
+#include <SDL3/SDL.h>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <vector>
+#include <memory>
+#include <string>
+#include <cstdio>
+#include <cstring>
+#include <chrono>
+#include <algorithm>
+
+enum class TelemetryKind : Uint16 {
+    FRAME_US,       // Whole frame, update to present
+    UPDATE_US,
+    RENDER_US,
+    PARTICLES,      // Live particles across all systems
+    ENEMIES,        // Enemies alive
+    DRAW_CALLS,     // Draw primitives in the frame
+    SDL_CALLS,      // SDL render calls the primitives became
+    AUDIO_UNDERRUN, // Music stream ran dry before it was refilled
+    ASSET_DECODE_US,
+    COUNT
+};
+
+inline const char* telemetryKindName(TelemetryKind kind) {
+    static const char* names[] = {
+        "frame_us", "update_us", "render_us", "particles", "enemies",
+        "draw_calls", "sdl_calls", "audio_underrun", "asset_decode_us"
+    };
+    static_assert(sizeof(names) / sizeof(names[0]) == static_cast<size_t>(TelemetryKind::COUNT));
+    size_t i = static_cast<size_t>(kind);
+    return i < static_cast<size_t>(TelemetryKind::COUNT) ? names[i] : "unknown";
+}
+
+struct TelemetryEvent {
+    Uint64 counter; // SDL_GetPerformanceCounter at record time
+    Uint16 kind;
+    Uint16 thread;  // Ring index, stable for the thread's lifetime (reused after it exits)
+    Uint32 value;
+};
+static_assert(sizeof(TelemetryEvent) == 16, "telemetry events are written raw");
+
+// Segment file layout: header, then `count` events
+struct TelemetrySegmentHeader {
+    char magic[4];    // "KTEL"
+    Uint32 version;
+    Uint64 frequency; // Performance counter ticks per second
+    Uint64 sequence;  // Increases with every segment started, orders reused files
+    Uint64 count;     // Events in this segment
+    Uint64 dropped;   // Events lost to full rings since the previous segment
+};
+
+// Single producer (the owning thread), single consumer (the flush thread)
+class TelemetryRing {
+public:
+    static constexpr Uint32 CAPACITY = 4096; // Power of two
+
+private:
+    TelemetryEvent events[CAPACITY];
+    alignas(64) std::atomic<Uint32> head{ 0 }; // Written by the producer
+    alignas(64) std::atomic<Uint32> tail{ 0 }; // Written by the consumer
+    std::atomic<Uint64> dropped{ 0 };
+    std::atomic<bool> owned{ true }; // A live thread produces into this ring
+
+public:
+    const Uint16 thread;
+
+    explicit TelemetryRing(Uint16 id) : thread(id) {}
+
+    void push(const TelemetryEvent& e) {
+        Uint32 h = head.load(std::memory_order_relaxed);
+        if (h - tail.load(std::memory_order_acquire) >= CAPACITY) {
+            dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        events[h & (CAPACITY - 1)] = e;
+        head.store(h + 1, std::memory_order_release);
+    }
+
+    // Consumer: appends everything published so far to `out`
+    void drain(std::vector<TelemetryEvent>& out) {
+        Uint32 t = tail.load(std::memory_order_relaxed);
+        Uint32 h = head.load(std::memory_order_acquire);
+        for (; t != h; ++t) out.push_back(events[t & (CAPACITY - 1)]);
+        tail.store(t, std::memory_order_release);
+    }
+
+    Uint64 takeDropped() { return dropped.exchange(0, std::memory_order_relaxed); }
+
+    // The producer thread exited; a new thread may take the ring over. Its
+    // unflushed events are still drained normally.
+    void release() { owned.store(false, std::memory_order_release); }
+
+    // Under Telemetry::ringsMutex
+    bool claim() {
+        if (owned.load(std::memory_order_acquire)) return false;
+        owned.store(true, std::memory_order_relaxed);
+        return true;
+    }
+};
+
+class Telemetry {
+public:
+    static constexpr Uint32 VERSION = 1;
+    static constexpr size_t SEGMENT_EVENTS = 64 * 1024; // 1 MB per segment
+    static constexpr int SEGMENTS = 4;
+    static constexpr int FLUSH_MS = 250;
+
+private:
+    std::atomic<bool> enabled{ false };
+    std::mutex ringsMutex; // Guards `rings` growth only, never the hot path
+    std::vector<std::unique_ptr<TelemetryRing>> rings;
+
+    std::thread flusher;
+    std::mutex wakeMutex;
+    std::condition_variable wake;
+    bool stopping = false;
+
+    // Flush thread state
+    std::string prefix;
+    FILE* file = nullptr;
+    TelemetrySegmentHeader header{};
+    Uint64 sequence = 0;
+    std::vector<TelemetryEvent> batch;
+
+    Telemetry() = default;
+
+    // Hands the ring back when its thread exits, so recreated worker pools
+    // reuse rings instead of adding one per thread ever started
+    struct RingLease {
+        TelemetryRing* ring = nullptr;
+        ~RingLease() { if (ring) ring->release(); }
+    };
+
+    TelemetryRing* threadRing() {
+        thread_local RingLease lease;
+        if (lease.ring) return lease.ring;
+        std::lock_guard<std::mutex> lock(ringsMutex);
+        for (auto& ring : rings) {
+            if (ring->claim()) {
+                lease.ring = ring.get();
+                return lease.ring;
+            }
+        }
+        rings.push_back(std::make_unique<TelemetryRing>(static_cast<Uint16>(rings.size())));
+        lease.ring = rings.back().get();
+        return lease.ring;
+    }
+
+    void writeHeader() {
+        std::fseek(file, 0, SEEK_SET);
+        std::fwrite(&header, sizeof(header), 1, file);
+        std::fseek(file, 0, SEEK_END);
+    }
+
+    void openSegment() {
+        if (file) std::fclose(file);
+        std::string path = prefix + "_" + std::to_string(sequence % SEGMENTS) + ".ktel";
+        file = std::fopen(path.c_str(), "wb");
+
+        std::memcpy(header.magic, "KTEL", 4);
+        header.version = VERSION;
+        header.frequency = SDL_GetPerformanceFrequency();
+        header.sequence = sequence++;
+        header.count = 0;
+        header.dropped = 0;
+        if (file) std::fwrite(&header, sizeof(header), 1, file);
+    }
+
+    void closeSegment() {
+        if (!file) return;
+        writeHeader();
+        std::fclose(file);
+        file = nullptr;
+    }
+
+    void flush() {
+        batch.clear();
+        Uint64 dropped = 0;
+        {
+            std::lock_guard<std::mutex> lock(ringsMutex);
+            for (auto& ring : rings) {
+                ring->drain(batch);
+                dropped += ring->takeDropped();
+            }
+        }
+        header.dropped += dropped;
+
+        size_t written = 0;
+        while (file && written < batch.size()) {
+            if (header.count >= SEGMENT_EVENTS) {
+                writeHeader();
+                openSegment();
+                if (!file) return;
+            }
+            size_t room = SEGMENT_EVENTS - static_cast<size_t>(header.count);
+            size_t n = std::min(room, batch.size() - written);
+            std::fwrite(batch.data() + written, sizeof(TelemetryEvent), n, file);
+            header.count += n;
+            written += n;
+        }
+        // Keep the header current so a crash loses at most one flush period
+        if (file) {
+            writeHeader();
+            std::fflush(file);
+        }
+    }
+
+    void flushLoop() {
+        std::unique_lock<std::mutex> lock(wakeMutex);
+        while (!stopping) {
+            wake.wait_for(lock, std::chrono::milliseconds(FLUSH_MS));
+            lock.unlock();
+            flush();
+            lock.lock();
+        }
+    }
+
+public:
+    static Telemetry& instance() {
+        static Telemetry telemetry;
+        return telemetry;
+    }
+
+    ~Telemetry() { stop(); }
+
+    Telemetry(const Telemetry&) = delete;
+    Telemetry& operator=(const Telemetry&) = delete;
+
+    // Starts writing <pathPrefix>_0.ktel ... and the flush thread. Segments
+    // left by an earlier session are deleted first so a decode of
+    // <pathPrefix>_*.ktel never mixes two sessions.
+    bool start(const std::string& pathPrefix) {
+        if (flusher.joinable()) return true;
+        prefix = pathPrefix;
+        sequence = 0;
+        for (int i = 0; i < SEGMENTS; ++i) {
+            std::remove((prefix + "_" + std::to_string(i) + ".ktel").c_str());
+        }
+        openSegment();
+        if (!file) return false;
+
+        stopping = false;
+        flusher = std::thread([this]() { flushLoop(); });
+        enabled.store(true, std::memory_order_relaxed);
+        return true;
+    }
+
+    // Drains what is left and closes the current segment
+    void stop() {
+        if (!flusher.joinable()) return;
+        enabled.store(false, std::memory_order_relaxed);
+        {
+            std::lock_guard<std::mutex> lock(wakeMutex);
+            stopping = true;
+        }
+        wake.notify_one();
+        flusher.join();
+        flush();
+        closeSegment();
+    }
+
+    bool isEnabled() const { return enabled.load(std::memory_order_relaxed); }
+
+    // Hot path: safe from any thread, a no-op until start()
+    static void record(TelemetryKind kind, Uint32 value) {
+        Telemetry& t = instance();
+        if (!t.enabled.load(std::memory_order_relaxed)) return;
+        TelemetryRing* ring = t.threadRing();
+        ring->push({ SDL_GetPerformanceCounter(), static_cast<Uint16>(kind), ring->thread, value });
+    }
+
+    static Uint32 microseconds(Uint64 counterDelta) {
+        return static_cast<Uint32>(counterDelta * 1000000 / SDL_GetPerformanceFrequency());
+    }
+};
@@ -0,0 +1,135 @@
+// telemetry_decode.cpp - Turns telemetry segments (.ktel) into CSV and per-kind summaries
+// Segments are written by Telemetry (katanastick and the particle testbed
+// when started with --telemetry). Reused segment files are put back in order
+// by their sequence number and events are merged across threads by time.
+//
+// Usage: telemetry_decode <telemetry_N.ktel>... [--csv out.csv]
+#include <SDL3/SDL.h>
+#include <SDL3/SDL_main.h>
+#include <vector>
+#include <string>
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
+#include "telemetry.cpp"
+
+struct Segment {
+    TelemetrySegmentHeader header;
+    std::vector<TelemetryEvent> events;
+};
+
+static bool readSegment(const std::string& path, Segment& segment) {
+    FILE* f = std::fopen(path.c_str(), "rb");
+    if (!f) return false;
+
+    bool ok = std::fread(&segment.header, sizeof(segment.header), 1, f) == 1 &&
+        std::memcmp(segment.header.magic, "KTEL", 4) == 0 &&
+        segment.header.version >= 1 && segment.header.version <= Telemetry::VERSION &&
+        segment.header.count <= Telemetry::SEGMENT_EVENTS;
+    if (ok) {
+        segment.events.resize(static_cast<size_t>(segment.header.count));
+        // A crash may leave fewer events than the header claims
+        size_t n = std::fread(segment.events.data(), sizeof(TelemetryEvent), segment.events.size(), f);
+        segment.events.resize(n);
+    }
+    std::fclose(f);
+    return ok;
+}
+
+static double percentile(const std::vector<Uint32>& sorted, double p) {
+    if (sorted.empty()) return 0;
+    size_t i = static_cast<size_t>(p * (sorted.size() - 1) + 0.5);
+    return sorted[std::min(i, sorted.size() - 1)];
+}
+
+int main(int argc, char* argv[]) {
+    std::vector<std::string> paths;
+    std::string csvPath;
+
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--csv") == 0 && i + 1 < argc) {
+            csvPath = argv[++i];
+        }
+        else {
+            paths.push_back(argv[i]);
+        }
+    }
+
+    if (paths.empty()) {
+        std::fprintf(stderr, "Usage: telemetry_decode <telemetry_N.ktel>... [--csv out.csv]\n");
+        return 1;
+    }
+
+    std::vector<Segment> segments;
+    for (const auto& path : paths) {
+        Segment segment;
+        if (!readSegment(path, segment)) {
+            std::fprintf(stderr, "Could not read telemetry segment %s\n", path.c_str());
+            continue;
+        }
+        segments.push_back(std::move(segment));
+    }
+    if (segments.empty()) return 1;
+
+    std::sort(segments.begin(), segments.end(), [](const Segment& a, const Segment& b) {
+        return a.header.sequence < b.header.sequence;
+    });
+
+    std::vector<TelemetryEvent> events;
+    Uint64 dropped = 0;
+    for (const Segment& s : segments) {
+        events.insert(events.end(), s.events.begin(), s.events.end());
+        dropped += s.header.dropped;
+    }
+    // Rings drain in thread order within a flush; restore time order
+    std::stable_sort(events.begin(), events.end(), [](const TelemetryEvent& a, const TelemetryEvent& b) {
+        return a.counter < b.counter;
+    });
+
+    double frequency = static_cast<double>(segments.front().header.frequency);
+    Uint64 origin = events.empty() ? 0 : events.front().counter;
+
+    if (!csvPath.empty()) {
+        FILE* csv = std::fopen(csvPath.c_str(), "w");
+        if (!csv) {
+            std::fprintf(stderr, "Could not write %s\n", csvPath.c_str());
+            return 1;
+        }
+        std::fprintf(csv, "time_s,thread,kind,value\n");
+        for (const TelemetryEvent& e : events) {
+            std::fprintf(csv, "%.6f,%u,%s,%u\n", (e.counter - origin) / frequency,
+                static_cast<unsigned>(e.thread), telemetryKindName(static_cast<TelemetryKind>(e.kind)),
+                static_cast<unsigned>(e.value));
+        }
+        std::fclose(csv);
+    }
+
+    double span = events.empty() ? 0 : (events.back().counter - origin) / frequency;
+    std::printf("%zu segments, %zu events over %.1f s, %llu dropped\n", segments.size(), events.size(),
+        span, static_cast<unsigned long long>(dropped));
+    std::printf("%-16s %8s %10s %10s %10s %10s %10s %10s\n",
+        "kind", "count", "min", "mean", "p50", "p95", "p99", "max");
+
+    for (size_t k = 0; k < static_cast<size_t>(TelemetryKind::COUNT); ++k) {
+        std::vector<Uint32> values;
+        double sum = 0;
+        for (const TelemetryEvent& e : events) {
+            if (e.kind != k) continue;
+            values.push_back(e.value);
+            sum += e.value;
+        }
+        if (values.empty()) continue;
+        std::sort(values.begin(), values.end());
+
+        std::printf("%-16s %8zu %10u %10.1f %10.0f %10.0f %10.0f %10u\n",
+            telemetryKindName(static_cast<TelemetryKind>(k)), values.size(), values.front(),
+            sum / values.size(), percentile(values, 0.5), percentile(values, 0.95),
+            percentile(values, 0.99), values.back());
+
+        if (k == static_cast<size_t>(TelemetryKind::FRAME_US)) {
+            size_t slow = values.end() - std::upper_bound(values.begin(), values.end(), 16667u);
+            std::printf("%-16s %8zu frames over 16.7 ms (%.1f%%)\n", "", slow, 100.0 * slow / values.size());
+        }
+    }
+    return 0;
+}
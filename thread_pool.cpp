@@ -0,0 +1,88 @@
+// thread_pool.cpp - Fixed-size worker pool for background jobs
+#pragma once
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <algorithm>
+
+class ThreadPool {
+public:
+    using Job = std::function<void()>;
+
+private:
+    std::vector<std::thread> workers;
+    std::deque<Job> jobs;
+    std::mutex mutex;
+    std::condition_variable jobReady;
+    std::condition_variable idle;
+    int busy = 0;
+    bool stopping = false;
+
+    void workerLoop() {
+        for (;;) {
+            Job job;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                jobReady.wait(lock, [this] { return stopping || !jobs.empty(); });
+                if (jobs.empty()) return; // Stopping and drained
+                job = std::move(jobs.front());
+                jobs.pop_front();
+                busy++;
+            }
+
+            job();
+
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                busy--;
+                if (busy == 0 && jobs.empty()) idle.notify_all();
+            }
+        }
+    }
+
+public:
+    // threads <= 0: one per hardware thread, leaving one for the main thread
+    explicit ThreadPool(int threads = 0) {
+        if (threads <= 0) {
+            threads = std::max(1, static_cast<int>(std::thread::hardware_concurrency()) - 1);
+        }
+        workers.reserve(threads);
+        for (int i = 0; i < threads; ++i) {
+            workers.emplace_back([this] { workerLoop(); });
+        }
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // Finishes queued jobs, then joins
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        jobReady.notify_all();
+        for (auto& worker : workers) {
+            worker.join();
+        }
+    }
+
+    void submit(Job job) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            jobs.push_back(std::move(job));
+        }
+        jobReady.notify_one();
+    }
+
+    // Block until the queue is empty and no job is running
+    void waitIdle() {
+        std::unique_lock<std::mutex> lock(mutex);
+        idle.wait(lock, [this] { return busy == 0 && jobs.empty(); });
+    }
+
+    int size() const { return static_cast<int>(workers.size()); }
+};
@@ -122,12 +122,13 @@ struct Color {
 struct Utils {
     // Random number generator - inline statics
     static std::random_device& getRD() {
-        static std::random_device rd;
+        static thread_local std::random_device rd;
         return rd;
     }
 
+    // One generator per thread so independent simulations can run in parallel
     static std::mt19937& getGen() {
-        static std::mt19937 gen(getRD()());
+        static thread_local std::mt19937 gen(getRD()());
         return gen;
     }
 
@@ -136,6 +137,11 @@ struct Utils {
         getGen().seed(getRD()());
     }
 
+    // Deterministic seed for the calling thread (replays, batch simulation)
+    static inline void seedRandom(uint32_t seed) {
+        getGen().seed(seed);
+    }
+
     // Random functions
     static inline float randomFloat(float min, float max) {
         std::uniform_real_distribution<float> dis(min, max);